@@ -0,0 +1,112 @@
+#include "AdaptiveRecorder.h"
+
+#define NO_STAGED_DEADBAND 0xFFFFFFFF
+
+AdaptiveRecorder::AdaptiveRecorder(FramStorage *fram, float temperatureDeadband, float humidityDeadband,
+                                   uint32_t minIntervalSeconds, uint32_t maxIntervalSeconds)
+    : _fram(fram),
+      _temperatureDeadband(temperatureDeadband),
+      _humidityDeadband(humidityDeadband),
+      _stagedDeadband(NO_STAGED_DEADBAND),
+      _minIntervalSeconds(minIntervalSeconds),
+      _maxIntervalSeconds(maxIntervalSeconds),
+      _lastRecord(),
+      _recordCount(0),
+      _earlyRecordCount(0) {
+}
+
+void AdaptiveRecorder::begin(const SensorReading &lastRecord) {
+    _lastRecord = lastRecord;
+
+    uint8_t config[RecorderConfigSchema::size];
+    if (_fram == nullptr
+        || _fram->readBytes(RECORDER_CONFIG_ADDRESS, config, sizeof(config)) != sizeof(config)
+        || RecorderConfigSchema::get<CONFIG_MAGIC>(config) != RECORDER_CONFIG_MAGIC) {
+        return; // Never configured, keep the constructor defaults
+    }
+    const float temperature = RecorderConfigSchema::get<CONFIG_TEMPERATURE_DEADBAND>(config);
+    const float humidity = RecorderConfigSchema::get<CONFIG_HUMIDITY_DEADBAND>(config);
+    if (isValidDeadband(temperature) && isValidDeadband(humidity)) {
+        _temperatureDeadband.store(temperature, std::memory_order_relaxed);
+        _humidityDeadband.store(humidity, std::memory_order_relaxed);
+    }
+}
+
+bool AdaptiveRecorder::setDeadband(float temperature, float humidity) {
+    if (!isValidDeadband(temperature) || !isValidDeadband(humidity)) {
+        return false;
+    }
+    // One word for both values: the sampling task never applies a temperature from one request and a humidity
+    // from another
+    const uint32_t staged = (uint32_t) lroundf(temperature * 100) << 16 | (uint32_t) lroundf(humidity * 100);
+    _stagedDeadband.store(staged, std::memory_order_release);
+    return true;
+}
+
+void AdaptiveRecorder::getDeadband(float &temperature, float &humidity) const {
+    temperature = _temperatureDeadband.load(std::memory_order_relaxed);
+    humidity = _humidityDeadband.load(std::memory_order_relaxed);
+}
+
+bool AdaptiveRecorder::shouldRecord(const SensorReading &reading) {
+    applyStagedDeadband();
+
+    const uint32_t elapsed = reading.timestamp - _lastRecord.timestamp;
+    if (elapsed > _maxIntervalSeconds) {
+        return true;
+    }
+    if (elapsed < _minIntervalSeconds) {
+        return false;
+    }
+    return isOutsideDeadband(reading);
+}
+
+void AdaptiveRecorder::markRecorded(const SensorReading &reading) {
+    if (reading.timestamp - _lastRecord.timestamp <= _maxIntervalSeconds) {
+        _earlyRecordCount++;
+    }
+    _recordCount++;
+    _lastRecord = reading;
+}
+
+uint32_t AdaptiveRecorder::getRecordCount() const {
+    return _recordCount;
+}
+
+uint32_t AdaptiveRecorder::getEarlyRecordCount() const {
+    return _earlyRecordCount;
+}
+
+void AdaptiveRecorder::applyStagedDeadband() {
+    const uint32_t staged = _stagedDeadband.exchange(NO_STAGED_DEADBAND, std::memory_order_acquire);
+    if (staged == NO_STAGED_DEADBAND) {
+        return;
+    }
+    const float temperature = (staged >> 16) / 100.0f;
+    const float humidity = (staged & 0xFFFF) / 100.0f;
+    _temperatureDeadband.store(temperature, std::memory_order_relaxed);
+    _humidityDeadband.store(humidity, std::memory_order_relaxed);
+
+    if (_fram != nullptr) {
+        uint8_t config[RecorderConfigSchema::size];
+        RecorderConfigSchema::encode(config, RECORDER_CONFIG_MAGIC, temperature, humidity);
+        _fram->writeBytes(RECORDER_CONFIG_ADDRESS, config, sizeof(config));
+    }
+}
+
+bool AdaptiveRecorder::isOutsideDeadband(const SensorReading &reading) const {
+    const float temperatureDeadband = _temperatureDeadband.load(std::memory_order_relaxed);
+    const float humidityDeadband = _humidityDeadband.load(std::memory_order_relaxed);
+    // Comparisons against NAN are false: an invalid value never triggers an early record by itself
+    if (temperatureDeadband > 0 && fabsf(reading.temperature - _lastRecord.temperature) >= temperatureDeadband) {
+        return true;
+    }
+    if (humidityDeadband > 0 && fabsf(reading.humidity - _lastRecord.humidity) >= humidityDeadband) {
+        return true;
+    }
+    return false;
+}
+
+bool AdaptiveRecorder::isValidDeadband(float value) {
+    return value >= 0 && value <= MAX_DEADBAND; // False for NAN
+}
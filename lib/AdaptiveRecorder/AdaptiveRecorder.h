@@ -0,0 +1,111 @@
+#ifndef ADAPTIVERECORDER_H
+#define ADAPTIVERECORDER_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <FramStorage.h>
+#include <SensorReading.h>
+#include <WireSchema.h>
+
+// A record is written early as soon as a value moved this far away from the last stored record
+#define DEFAULT_TEMPERATURE_DEADBAND    0.5f // °C
+#define DEFAULT_HUMIDITY_DEADBAND       3.0f // %RH
+
+// Lower bound between two records, keeps FRAM usage in check when a value oscillates around the deadband
+#define MIN_RECORD_INTERVAL_SECONDS     60
+// Upper bound: a flat period still stores one record per interval, readers see the sensor was alive
+#define MAX_RECORD_INTERVAL_SECONDS     (2 * 3600)
+
+// Deadbands configured over BLE, persisted in the spare bytes between the record ring and the alert rules
+#define RECORDER_CONFIG_ADDRESS         0x7CF4
+#define RECORDER_CONFIG_MAGIC           0xDB01
+using RecorderConfigSchema = wire::Schema<uint16_t, float, float>;
+enum RecorderConfigField : size_t { CONFIG_MAGIC, CONFIG_TEMPERATURE_DEADBAND, CONFIG_HUMIDITY_DEADBAND };
+static_assert(RECORDER_CONFIG_ADDRESS >= RECORD_START_ADDRESS + RECORD_SLOT_COUNT * RECORD_SIZE_BYTES,
+              "Recorder configuration overlaps the record ring");
+static_assert(RECORDER_CONFIG_ADDRESS + RecorderConfigSchema::size <= 0x7D00,
+              "Recorder configuration overlaps the alert rules");
+
+// Largest deadband that can be staged, in either unit (stored in hundredths on 16 bits)
+#define MAX_DEADBAND                    655.0f
+
+/**
+ * Change-driven recording policy.
+ *
+ * A record is always written after MAX_RECORD_INTERVAL_SECONDS, and earlier when temperature or humidity leaves the
+ * deadband around the last stored record. Flat periods therefore cost one record per interval while fast events
+ * (door opening, irrigation) are captured at up to one record per minute.
+ *
+ * The deadbands can be changed from any task: setDeadband() stages them in a single atomic word, the sampling task
+ * picks them up at its next shouldRecord() and persists them.
+ */
+class AdaptiveRecorder {
+public:
+    /**
+     * @param fram Where the deadbands are persisted, nullptr to keep them in RAM only.
+     */
+    explicit AdaptiveRecorder(FramStorage* fram,
+                              float temperatureDeadband = DEFAULT_TEMPERATURE_DEADBAND,
+                              float humidityDeadband = DEFAULT_HUMIDITY_DEADBAND,
+                              uint32_t minIntervalSeconds = MIN_RECORD_INTERVAL_SECONDS,
+                              uint32_t maxIntervalSeconds = MAX_RECORD_INTERVAL_SECONDS);
+
+    /**
+     * @brief Seeds the recorder with the newest record already stored, so the policy survives a reboot, and loads
+     *        the persisted deadbands.
+     * @param lastRecord The newest record in the ring.
+     */
+    void begin(const SensorReading& lastRecord);
+
+    /**
+     * @brief Stages new deadbands, applied by the next shouldRecord(). Safe to call from the BLE task.
+     *        A value of 0 disables early recording for that quantity.
+     * @param temperature Temperature deadband in °C, resolution 0.01.
+     * @param humidity Humidity deadband in %RH, resolution 0.01.
+     * @return False if a value is negative, NAN or above MAX_DEADBAND.
+     */
+    bool setDeadband(float temperature, float humidity);
+
+    /**
+     * @brief Gets the deadbands in use, a staged change shows up once applied.
+     */
+    void getDeadband(float& temperature, float& humidity) const;
+
+    /**
+     * @brief Decides whether a sample has to be stored. Must be called from the sampling task only.
+     * @param reading The latest sample.
+     * @return True if the sample must be written to the ring.
+     */
+    [[nodiscard]] bool shouldRecord(const SensorReading& reading);
+
+    /**
+     * @brief Must be called once the sample accepted by shouldRecord() has been written.
+     * @param reading The stored sample.
+     */
+    void markRecorded(const SensorReading& reading);
+
+    /**
+     * @return Number of records written since boot, and how many of them were triggered by the deadband.
+     */
+    [[nodiscard]] uint32_t getRecordCount() const;
+    [[nodiscard]] uint32_t getEarlyRecordCount() const;
+
+private:
+    FramStorage* _fram;
+    // Written by the sampling task only, read by BLE getDeadband(): each one is a single word
+    std::atomic<float> _temperatureDeadband;
+    std::atomic<float> _humidityDeadband;
+    // Both deadbands in hundredths (temperature in the high half), NO_STAGED_DEADBAND when nothing is pending
+    std::atomic<uint32_t> _stagedDeadband;
+    uint32_t _minIntervalSeconds;
+    uint32_t _maxIntervalSeconds;
+    SensorReading _lastRecord;
+    uint32_t _recordCount;
+    uint32_t _earlyRecordCount;
+
+    void applyStagedDeadband();
+    [[nodiscard]] bool isOutsideDeadband(const SensorReading& reading) const;
+    static bool isValidDeadband(float value);
+};
+
+#endif //ADAPTIVERECORDER_H
@@ -0,0 +1,256 @@
+#include "AlertEngine.h"
+
+AlertEngine::AlertEngine(FramStorage *fram)
+    : _fram(fram),
+      _rules(),
+      _states(),
+      _staged(),
+      _applied(),
+      _stagedMask(0),
+      _eventVersion(0),
+      _eventRing(0) {
+}
+
+void AlertEngine::begin() {
+    uint8_t encoded[MAX_ALERT_RULES * AlertRuleSchema::size];
+    if (_fram->readBytes(ALERT_RULES_ADDRESS, encoded, sizeof(encoded)) == sizeof(encoded)) {
+        for (uint8_t i = 0; i < MAX_ALERT_RULES; ++i) {
+            const AlertRule rule = decodeRule(encoded + i * AlertRuleSchema::size);
+            // Unwritten FRAM is not a rule
+            _rules[i] = isValid(rule) ? rule : AlertRule();
+            _applied[i].store(_rules[i]);
+        }
+    }
+
+    uint8_t ring[AlertEventRingSchema::size];
+    if (_fram->readBytes(ALERT_EVENTS_ADDRESS, ring, sizeof(ring)) == sizeof(ring)) {
+        const uint8_t next = AlertEventRingSchema::get<EVENTS_NEXT>(ring);
+        const uint8_t count = AlertEventRingSchema::get<EVENTS_COUNT>(ring);
+        if (next < ALERT_EVENT_SLOTS && count <= ALERT_EVENT_SLOTS) {
+            _eventRing.store(next << 8 | count, std::memory_order_release);
+        }
+    }
+}
+
+bool AlertEngine::setRule(uint8_t index, const AlertRule &rule) {
+    if (index >= MAX_ALERT_RULES || !isValid(rule)) {
+        return false;
+    }
+    // A rule staged again while evaluate() copies it sets its bit again, the final value wins at the next sample
+    _staged[index].store(rule);
+    _stagedMask.fetch_or(1u << index, std::memory_order_release);
+    return true;
+}
+
+bool AlertEngine::getRule(uint8_t index, AlertRule &rule) const {
+    if (index >= MAX_ALERT_RULES) {
+        return false;
+    }
+    return _applied[index].load(rule);
+}
+
+uint8_t AlertEngine::evaluate(const SensorReading &reading, AlertEvent *events, uint8_t maxEvents) {
+    applyStagedRules();
+
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < MAX_ALERT_RULES; ++i) {
+        float value;
+        if (_rules[i].type == ALERT_DISABLED || !evaluateRule(_rules[i], _states[i], reading, value)) {
+            continue;
+        }
+        AlertEvent event;
+        event.rule = i;
+        event.raised = _states[i].active;
+        event.value = value;
+        event.timestamp = reading.timestamp;
+        logEvent(event);
+        if (count < maxEvents) {
+            events[count++] = event;
+        }
+    }
+    return count;
+}
+
+uint8_t AlertEngine::readEvents(uint8_t offset, uint8_t *buffer, uint8_t maxEvents) {
+    // The slots live in FRAM: a read that overlapped logEvent() may hold a torn or a newer event, it is dropped
+    const uint32_t before = _eventVersion.load(std::memory_order_acquire);
+    if (before & 1) {
+        return 0;
+    }
+    const uint16_t ring = _eventRing.load(std::memory_order_relaxed);
+    const uint8_t next = ring >> 8;
+    const uint8_t count = ring & 0xFF;
+
+    uint8_t read = 0;
+    while (read < maxEvents && offset + read < count) {
+        const uint8_t slot = (next + ALERT_EVENT_SLOTS - 1 - offset - read) % ALERT_EVENT_SLOTS;
+        const uint16_t address = ALERT_EVENTS_ADDRESS + AlertEventRingSchema::size + slot * AlertEventSchema::size;
+        if (_fram->readBytes(address, buffer + read * AlertEventSchema::size, AlertEventSchema::size)
+            != AlertEventSchema::size) {
+            break;
+        }
+        read++;
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (_eventVersion.load(std::memory_order_relaxed) != before) {
+        return 0;
+    }
+    return read;
+}
+
+uint8_t AlertEngine::getEventCount() const {
+    return _eventRing.load(std::memory_order_acquire) & 0xFF;
+}
+
+void AlertEngine::applyStagedRules() {
+    const uint32_t mask = _stagedMask.exchange(0, std::memory_order_acquire);
+    if (mask == 0) {
+        return;
+    }
+    for (uint8_t i = 0; i < MAX_ALERT_RULES; ++i) {
+        if ((mask & (1u << i)) == 0) {
+            continue;
+        }
+        AlertRule rule;
+        if (!_staged[i].load(rule)) {
+            continue; // Being staged again right now: its bit is set again once written, applied at the next sample
+        }
+        _rules[i] = rule;
+        _applied[i].store(rule);
+        _states[i] = RuleState();
+
+        uint8_t record[AlertRuleSchema::size];
+        encodeRule(record, _rules[i]);
+        _fram->writeBytes(ALERT_RULES_ADDRESS + i * AlertRuleSchema::size, record, sizeof(record));
+    }
+}
+
+bool AlertEngine::evaluateRule(const AlertRule &rule, RuleState &state, const SensorReading &reading, float &value) {
+    value = rule.quantity == ALERT_HUMIDITY ? reading.humidity : reading.temperature;
+    if (isnan(value)) {
+        return false;
+    }
+
+    bool active = state.active;
+    switch (rule.type) {
+        case ALERT_ABOVE:
+            active = state.active ? value >= rule.threshold - rule.hysteresis : value > rule.threshold;
+            break;
+        case ALERT_BELOW:
+            active = state.active ? value <= rule.threshold + rule.hysteresis : value < rule.threshold;
+            break;
+        case ALERT_RATE: {
+            // Change over consecutive windows: one reference sample instead of a history buffer
+            if (!state.hasReference) {
+                state.hasReference = true;
+                state.referenceValue = value;
+                state.referenceTimestamp = reading.timestamp;
+                return false;
+            }
+            const uint32_t elapsed = reading.timestamp - state.referenceTimestamp;
+            if (elapsed < rule.windowSeconds || elapsed == 0) {
+                return false;
+            }
+            const float rate = (value - state.referenceValue) * 3600.0f / elapsed;
+            state.referenceValue = value;
+            state.referenceTimestamp = reading.timestamp;
+            value = rate;
+            active = state.active ? fabsf(rate) >= rule.threshold - rule.hysteresis : fabsf(rate) > rule.threshold;
+            break;
+        }
+        default:
+            return false;
+    }
+
+    if (active == state.active) {
+        return false;
+    }
+    state.active = active;
+    return true;
+}
+
+void AlertEngine::logEvent(const AlertEvent &event) {
+    const uint16_t ring = _eventRing.load(std::memory_order_relaxed);
+    uint8_t next = ring >> 8;
+    uint8_t count = ring & 0xFF;
+
+    uint8_t record[AlertEventSchema::size];
+    AlertEventSchema::encode(record, event.rule, event.raised ? 1 : 0, event.value, event.timestamp);
+    const uint32_t before = _eventVersion.load(std::memory_order_relaxed);
+    _eventVersion.store(before + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    _fram->writeBytes(ALERT_EVENTS_ADDRESS + AlertEventRingSchema::size + next * AlertEventSchema::size,
+                      record, sizeof(record));
+    next = (next + 1) % ALERT_EVENT_SLOTS;
+    if (count < ALERT_EVENT_SLOTS) {
+        count++;
+    }
+    _eventRing.store(next << 8 | count, std::memory_order_relaxed);
+    _eventVersion.store(before + 2, std::memory_order_release);
+
+    uint8_t header[AlertEventRingSchema::size];
+    AlertEventRingSchema::encode(header, next, count);
+    _fram->writeBytes(ALERT_EVENTS_ADDRESS, header, sizeof(header));
+}
+
+AlertEngine::RuleSlot::RuleSlot() : version(0), words() {
+    store(AlertRule());
+}
+
+void AlertEngine::RuleSlot::store(const AlertRule &rule) {
+    uint32_t encoded[ALERT_RULE_WORDS] = {};
+    encodeRule(reinterpret_cast<uint8_t *>(encoded), rule);
+
+    const uint32_t before = version.load(std::memory_order_relaxed);
+    version.store(before + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (uint8_t i = 0; i < ALERT_RULE_WORDS; ++i) {
+        words[i].store(encoded[i], std::memory_order_relaxed);
+    }
+    version.store(before + 2, std::memory_order_release);
+}
+
+bool AlertEngine::RuleSlot::load(AlertRule &rule) const {
+    const uint32_t before = version.load(std::memory_order_acquire);
+    if (before & 1) {
+        return false;
+    }
+    uint32_t encoded[ALERT_RULE_WORDS];
+    for (uint8_t i = 0; i < ALERT_RULE_WORDS; ++i) {
+        encoded[i] = words[i].load(std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (version.load(std::memory_order_relaxed) != before) {
+        return false;
+    }
+    rule = decodeRule(reinterpret_cast<const uint8_t *>(encoded));
+    return true;
+}
+
+AlertRule AlertEngine::decodeRule(const uint8_t *record) {
+    AlertRule rule;
+    const uint8_t type = AlertRuleSchema::get<RULE_TYPE>(record);
+    rule.type = type & ~ALERT_TRIGGER_BURST;
+    rule.triggersBurst = (type & ALERT_TRIGGER_BURST) != 0;
+    rule.quantity = AlertRuleSchema::get<RULE_QUANTITY>(record);
+    rule.windowSeconds = AlertRuleSchema::get<RULE_WINDOW>(record);
+    rule.threshold = AlertRuleSchema::get<RULE_THRESHOLD>(record);
+    rule.hysteresis = AlertRuleSchema::get<RULE_HYSTERESIS>(record);
+    return rule;
+}
+
+void AlertEngine::encodeRule(uint8_t *record, const AlertRule &rule) {
+    AlertRuleSchema::encode(record, rule.type | (rule.triggersBurst ? ALERT_TRIGGER_BURST : 0), rule.quantity,
+                            rule.windowSeconds, rule.threshold, rule.hysteresis);
+}
+
+bool AlertEngine::isValid(const AlertRule &rule) {
+    if (rule.type > ALERT_RATE || rule.quantity > ALERT_HUMIDITY) {
+        return false;
+    }
+    if (rule.type == ALERT_DISABLED) {
+        return true;
+    }
+    return !isnan(rule.threshold) && !isnan(rule.hysteresis) && rule.hysteresis >= 0
+           && (rule.type != ALERT_RATE || rule.windowSeconds > 0);
+}
@@ -0,0 +1,166 @@
+#ifndef ALERTENGINE_H
+#define ALERTENGINE_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <FramStorage.h>
+#include <SensorReading.h>
+#include <WireSchema.h>
+
+#define MAX_ALERT_RULES         8
+#define ALERT_EVENT_SLOTS       12
+
+// FRAM layout, right after the record ring
+#define ALERT_RULES_ADDRESS     0x7D00 // MAX_ALERT_RULES encoded rules
+#define ALERT_EVENTS_ADDRESS    0x7D80 // Event ring header (next slot, count) followed by ALERT_EVENT_SLOTS events
+#define ALERT_EVENTS_END        0x7E00
+
+enum AlertRuleType : uint8_t {
+    ALERT_DISABLED = 0,
+    ALERT_ABOVE = 1, // Raised when value > threshold, cleared when value < threshold - hysteresis
+    ALERT_BELOW = 2, // Raised when value < threshold, cleared when value > threshold + hysteresis
+    ALERT_RATE = 3,  // Raised when |change per hour| over windowSeconds > threshold, cleared below threshold - hysteresis
+};
+
+// Set on the encoded rule type: raising the alert also starts a burst capture
+#define ALERT_TRIGGER_BURST     0x80
+
+enum AlertQuantity : uint8_t {
+    ALERT_TEMPERATURE = 0,
+    ALERT_HUMIDITY = 1,
+};
+
+struct AlertRule {
+    uint8_t type;
+    uint8_t quantity;
+    uint16_t windowSeconds; // ALERT_RATE only
+    float threshold;
+    float hysteresis;
+    bool triggersBurst;
+
+    AlertRule() : type(ALERT_DISABLED), quantity(ALERT_TEMPERATURE), windowSeconds(0), threshold(0), hysteresis(0),
+                  triggersBurst(false) {}
+};
+
+// Rule as stored in FRAM and exchanged over BLE: type (| ALERT_TRIGGER_BURST), quantity, window, threshold, hysteresis
+using AlertRuleSchema = wire::Schema<uint8_t, uint8_t, uint16_t, float, float>;
+enum AlertRuleField : size_t { RULE_TYPE, RULE_QUANTITY, RULE_WINDOW, RULE_THRESHOLD, RULE_HYSTERESIS };
+#define ALERT_RULE_WORDS ((AlertRuleSchema::size + 3) / 4)
+
+struct AlertEvent {
+    uint8_t rule;
+    bool raised;   // False when the alert clears
+    float value;   // Measured value, or rate per hour for ALERT_RATE
+    uint32_t timestamp;
+
+    AlertEvent() : rule(0), raised(false), value(0), timestamp(0) {}
+};
+
+// Event as logged in FRAM and pushed over BLE: rule, raised, value, timestamp
+using AlertEventSchema = wire::Schema<uint8_t, uint8_t, float, uint32_t>;
+enum AlertEventField : size_t { EVENT_RULE, EVENT_RAISED, EVENT_VALUE, EVENT_TIMESTAMP };
+using AlertEventRingSchema = wire::Schema<uint8_t, uint8_t>;
+enum AlertEventRingField : size_t { EVENTS_NEXT, EVENTS_COUNT };
+
+static_assert(ALERT_RULES_ADDRESS >= RECORD_START_ADDRESS + RECORD_SLOT_COUNT * RECORD_SIZE_BYTES,
+              "Alert rules overlap the record ring");
+static_assert(ALERT_RULES_ADDRESS + MAX_ALERT_RULES * AlertRuleSchema::size <= ALERT_EVENTS_ADDRESS,
+              "Alert rules overlap the event ring");
+static_assert(ALERT_EVENTS_ADDRESS + AlertEventRingSchema::size + ALERT_EVENT_SLOTS * AlertEventSchema::size
+              <= ALERT_EVENTS_END, "Alert event ring does not fit its FRAM region");
+
+/**
+ * Threshold, hysteresis and rate-of-change alerts on the sampled readings.
+ *
+ * Every rule keeps a fixed amount of state (active flag and one reference sample for rates), so evaluating a sample
+ * costs O(MAX_ALERT_RULES) whatever the history. Rules are persisted in FRAM and can be replaced from the BLE task:
+ * setRule() only stages the rule, the sampling task picks it up at its next evaluate() and is the only one touching
+ * the FRAM. Rules cross tasks through per-rule seqlocks (staged ones from the BLE task, applied ones back from the
+ * sampling task), like the ReadingBus slots. State changes are logged in a small FRAM event ring, read back by the
+ * BLE task under a seqlock of the same kind.
+ */
+class AlertEngine {
+public:
+    explicit AlertEngine(FramStorage* fram);
+
+    /**
+     * @brief Loads the rules and the event ring state from FRAM.
+     */
+    void begin();
+
+    /**
+     * @brief Stages a new rule, applied and persisted by the next evaluate(). Safe to call from the BLE task, from
+     *        one task only (GATT callbacks are serialized).
+     * @return False if the index or the rule is invalid.
+     */
+    bool setRule(uint8_t index, const AlertRule& rule);
+
+    /**
+     * @brief Gets the rule applied at index: a staged rule only shows up after the next evaluate(). Safe to call
+     *        from the BLE task.
+     * @return False if the index is invalid, or if the rule was being applied at that moment (never waits for the
+     *         sampling task, try again later).
+     */
+    bool getRule(uint8_t index, AlertRule& rule) const;
+
+    /**
+     * @brief Evaluates all rules against a new sample. Must be called from the sampling task only.
+     * @param reading The latest sample.
+     * @param events Receives the alerts raised or cleared by this sample, they are already logged in FRAM.
+     * @param maxEvents Capacity of events, MAX_ALERT_RULES is always enough.
+     * @return Number of events.
+     */
+    uint8_t evaluate(const SensorReading& reading, AlertEvent* events, uint8_t maxEvents);
+
+    /**
+     * @brief Reads logged events, newest first, in the AlertEventSchema layout. Safe to call from the BLE task.
+     * @return Number of events read, 0 if an event was being logged at that moment (never waits for the sampling
+     *         task, try again later).
+     */
+    uint8_t readEvents(uint8_t offset, uint8_t* buffer, uint8_t maxEvents);
+
+    [[nodiscard]] uint8_t getEventCount() const;
+
+    /**
+     * @brief Converts a rule from and to its AlertRuleSchema layout.
+     */
+    static AlertRule decodeRule(const uint8_t* record);
+    static void encodeRule(uint8_t* record, const AlertRule& rule);
+
+private:
+    struct RuleState {
+        bool active;
+        bool hasReference;
+        float referenceValue;
+        uint32_t referenceTimestamp;
+
+        RuleState() : active(false), hasReference(false), referenceValue(0), referenceTimestamp(0) {}
+    };
+
+    // One rule in its AlertRuleSchema layout, for one writer task and readers on other tasks
+    struct RuleSlot {
+        std::atomic<uint32_t> version; // Odd while being written
+        std::atomic<uint32_t> words[ALERT_RULE_WORDS];
+
+        RuleSlot();
+        void store(const AlertRule& rule);
+        // Never spins on the writer: false if it is in the middle of a store()
+        bool load(AlertRule& rule) const;
+    };
+
+    FramStorage* _fram;
+    AlertRule _rules[MAX_ALERT_RULES]; // Sampling task only
+    RuleState _states[MAX_ALERT_RULES];
+    RuleSlot _staged[MAX_ALERT_RULES];  // Written by setRule()
+    RuleSlot _applied[MAX_ALERT_RULES]; // Copy of _rules for getRule()
+    std::atomic<uint32_t> _stagedMask;
+    std::atomic<uint32_t> _eventVersion; // Odd while logEvent() writes, like RuleSlot::version
+    std::atomic<uint16_t> _eventRing;    // Next slot << 8 | count, published together
+
+    void applyStagedRules();
+    bool evaluateRule(const AlertRule& rule, RuleState& state, const SensorReading& reading, float& value);
+    void logEvent(const AlertEvent& event);
+    static bool isValid(const AlertRule& rule);
+};
+
+#endif //ALERTENGINE_H
@@ -1,68 +1,191 @@
 #include "BleSensorServer.h"
+#include <Trace.h>
 
 // --- ServerCallbacks Implementation ---
-void BleSensorServer::ServerCallbacks::onConnect(BLEServer *pServer) {
+void BleSensorServer::ServerCallbacks::onConnect(BLEServer *pServer, esp_ble_gatts_cb_param_t *param) {
+    TRACE_SCOPE("ble.connect");
     _owner->_connectedClients++;
+    if (_owner->openSession(param->connect.conn_id) == nullptr) {
+        Serial.println("No free client session, requests from this client will be ignored.");
+    }
     Serial.print("BLE Client Connected. Total clients: ");
     Serial.println(_owner->_connectedClients);
-    // Optionally stop advertising if you only want one connection,
-    // or manage advertising based on the number of connections.
-    // For simplicity, ESP32 default behavior allows multiple connections
-    // and advertising might continue or stop based on stack configuration.
+    // The controller stops advertising on every connection: keep the device discoverable while sessions are left
+    if (_owner->_connectedClients < MAX_CLIENT_SESSIONS) {
+        std::lock_guard<std::mutex> guard(_owner->_advertisingLock);
+        pServer->startAdvertising();
+        Serial.println("Advertising restarted.");
+    } else {
+        Serial.println("All client sessions in use, advertising stopped.");
+    }
     rgbLedWrite(BUILTIN_LED, 0, 0, 16);
 }
 
-void BleSensorServer::ServerCallbacks::onDisconnect(BLEServer *pServer) {
+void BleSensorServer::ServerCallbacks::onDisconnect(BLEServer *pServer, esp_ble_gatts_cb_param_t *param) {
+    TRACE_SCOPE("ble.disconnect");
     if (_owner->_connectedClients > 0) {
         _owner->_connectedClients--;
     }
+    _owner->closeSession(param->disconnect.conn_id);
     Serial.print("BLE Client Disconnected. Total clients: ");
     Serial.println(_owner->_connectedClients);
-    // It's common to restart advertising to allow new connections.
-    // The ESP32 BLE stack might handle this automatically if configured,
-    // but explicitly starting it ensures it's discoverable again.
-    pServer->startAdvertising(); // Restart advertising
+    // A session is free again: discoverable even if the last connection had stopped advertising
+    {
+        std::lock_guard<std::mutex> guard(_owner->_advertisingLock);
+        pServer->startAdvertising(); // Restart advertising, with the latest advertisement data
+    }
     Serial.println("Advertising restarted.");
     rgbLedWrite(BUILTIN_LED, 16, 0, 0);
 }
 
 // --- RecordRequestCallbacks Implementation ---
-void BleSensorServer::RecordRequestCallbacks::onWrite(BLECharacteristic *pCharacteristic) {
-    Serial.println("Client write");
-    uint16_t offset = 0;
-    memcpy(&offset, pCharacteristic->getData(), sizeof(uint16_t));
-
-    if (offset == 0xFFFF) {
-        Serial.println("Sending a new measure");
-        _owner->updateCurrentRecord();
-    } else {
-        Serial.print("Sending record at offset ");
-        Serial.println(offset);
-        _owner->sendRecords(offset);
+void BleSensorServer::RecordRequestCallbacks::onWrite(BLECharacteristic *pCharacteristic,
+                                                     esp_ble_gatts_cb_param_t *param) {
+    TRACE_SCOPE("ble.request");
+    Serial.print("Client write from connection ");
+    Serial.println(param->write.conn_id);
+    if (param->write.len < RecordRequestSchema::size) {
+        return;
+    }
+
+    ClientSession *session = _owner->openSession(param->write.conn_id);
+    if (session == nullptr) {
+        return;
+    }
+    if (session->stats.requests++ == 0) {
+        session->firstRequestAt = millis();
+    }
+    // Any new request ends a downsampled series
+    session->streaming = false;
+    session->downsampler.cancel();
+
+    const uint8_t *request = param->write.value;
+    const size_t length = param->write.len;
+
+    // Two byte writes are the original single record requests, every opcode request is longer
+    if (length == RecordRequestSchema::size) {
+        const uint16_t offset = RecordRequestSchema::get<0>(request);
+        if (offset == CURRENT_RECORD_OFFSET) {
+            Serial.println("Sending a new measure");
+            _owner->updateCurrentRecord(*session);
+        } else {
+            Serial.print("Sending record at offset ");
+            Serial.println(offset);
+            _owner->sendRecords(*session, offset, 1);
+        }
+        return;
+    }
+
+    switch (request[0]) {
+        case REQUEST_BATCH_OPCODE:
+            if (length >= BatchRequestSchema::size) {
+                const uint16_t offset = BatchRequestSchema::get<BATCH_OFFSET>(request);
+                const uint8_t count = BatchRequestSchema::get<BATCH_COUNT>(request);
+                Serial.print("Sending records from offset ");
+                Serial.print(offset);
+                Serial.print(", count ");
+                Serial.println(count);
+                _owner->sendRecords(*session, offset, count);
+            }
+            break;
+        case REQUEST_DOWNSAMPLE_OPCODE:
+            if (length >= DownsampleRequestSchema::size) {
+                _owner->startDownsample(*session, request);
+            }
+            break;
+        case REQUEST_ALERT_RULE_OPCODE:
+            _owner->handleAlertRule(*session, request, length);
+            break;
+        case REQUEST_ALERT_EVENTS_OPCODE:
+            if (length >= AlertEventsRequestSchema::size) {
+                _owner->sendAlertEvents(
+                    *session,
+                    AlertEventsRequestSchema::get<EVENTS_REQUEST_OFFSET>(request),
+                    AlertEventsRequestSchema::get<EVENTS_REQUEST_COUNT>(request)
+                );
+            }
+            break;
+        case REQUEST_BURST_START_OPCODE: {
+            const uint16_t samples = BurstStartRequestSchema::get<BURST_START_SAMPLES>(request);
+            Serial.print("Burst capture requested, samples: ");
+            Serial.println(samples);
+            _owner->_burst->request(samples);
+            session->responseLength = 0;
+            break;
+        }
+        case REQUEST_BURST_READ_OPCODE:
+            if (length >= BurstReadRequestSchema::size) {
+                _owner->sendBurst(
+                    *session,
+                    BurstReadRequestSchema::get<BURST_READ_OFFSET>(request),
+                    BurstReadRequestSchema::get<BURST_READ_COUNT>(request)
+                );
+            }
+            break;
+        case REQUEST_DEADBAND_OPCODE:
+            if (length >= DeadbandRequestSchema::size) {
+                _owner->handleDeadband(*session, request);
+            }
+            break;
+        default:
+            Serial.println("Unknown request");
+            break;
+    }
+}
+
+// --- RecordDataCallbacks Implementation ---
+void BleSensorServer::RecordDataCallbacks::onRead(BLECharacteristic *pCharacteristic,
+                                                  esp_ble_gatts_cb_param_t *param) {
+    TRACE_SCOPE("ble.read");
+    ClientSession *session = _owner->findSession(param->read.conn_id);
+    if (session == nullptr) {
+        pCharacteristic->setValue(nullptr, 0);
+        return;
+    }
+    if (session->streaming) {
+        _owner->sendDownsampled(*session);
     }
+    pCharacteristic->setValue(session->response, session->responseLength);
+    session->stats.reads++;
+    session->stats.bytes += session->responseLength;
+    session->lastReadAt = millis();
 }
 
 // --- BleSensorServer Implementation ---
-BleSensorServer::BleSensorServer(String deviceName, FramStorage *framStorage, SHTSensor *sensor, DS3231Clock *rtc)
-    : _deviceName(std::move(deviceName)),
+BleSensorServer::BleSensorServer(const char *deviceName, RecordStore *records, ReadingBus *readings,
+                                 AlertEngine *alerts, BurstCapture *burst, AdaptiveRecorder *recorder)
+    : _deviceName(deviceName),
       _pServer(nullptr),
       _pService(nullptr),
       _requestCharacteristic(nullptr),
       _dataCharacteristic(nullptr),
+      _alertCharacteristic(nullptr),
       _connectedClients(0),
-      _fram(framStorage),
-      _sht(sensor),
-      _rtc(rtc) {
+      _records(records),
+      _readings(readings),
+      _alerts(alerts),
+      _burst(burst),
+      _recorder(recorder),
+      _alertValue(),
+      _advertisingData(),
+      _advertisingLength(0),
+      _advertisedSequence(0),
+      _syncTotals(),
+      _syncCount(0),
+      _sessions(),
+      _serverCallbacks(this),
+      _requestCallbacks(this),
+      _dataCallbacks(this) {
 }
 
 void BleSensorServer::begin() {
     Serial.println("Initializing BLE Sensor Server...");
     Serial.print("Device Name: ");
-    Serial.println(_deviceName.c_str());
+    Serial.println(_deviceName);
 
     BLEDevice::init(_deviceName);
     _pServer = BLEDevice::createServer();
-    _pServer->setCallbacks(new ServerCallbacks(this)); // Attach callbacks
+    _pServer->setCallbacks(&_serverCallbacks); // Attach callbacks
 
     _pService = _pServer->createService(RECORD_SERVICE_UUID);
 
@@ -71,19 +194,28 @@ void BleSensorServer::begin() {
         RECORD_REQUEST_CHARACTERISTIC_UUID,
         BLECharacteristic::PROPERTY_WRITE
     );
-    _requestCharacteristic->setCallbacks(new RecordRequestCallbacks(this));
+    _requestCharacteristic->setCallbacks(&_requestCallbacks);
 
     // DATA LISTING
     _dataCharacteristic = _pService->createCharacteristic(
         RECORD_DATA_CHARACTERISTIC_UUID,
         BLECharacteristic::PROPERTY_READ
     );
+    _dataCharacteristic->setCallbacks(&_dataCallbacks);
+
+    // ALERTS, pushed to the clients that enabled notifications
+    _alertCharacteristic = _pService->createCharacteristic(
+        ALERT_CHARACTERISTIC_UUID,
+        BLECharacteristic::PROPERTY_READ | BLECharacteristic::PROPERTY_NOTIFY
+    );
+    _alertCharacteristic->addDescriptor(new BLE2902());
+    // Sized once here: notifyAlert() then rewrites the value in place instead of growing it from the sampling task
+    _alertCharacteristic->setValue(_alertValue, sizeof(_alertValue));
 
     _pService->start();
 
     // Configure and start advertising
     BLEAdvertising *pAdvertising = BLEDevice::getAdvertising();
-    pAdvertising->addServiceUUID(RECORD_SERVICE_UUID);
     pAdvertising->setScanResponse(true); // Necessary for some scanning apps to see service UUIDs
 
     // These calls were in your example; they relate to connection parameters.
@@ -96,83 +228,311 @@ void BleSensorServer::begin() {
     // or setMinPreferred and setMaxPreferred if available.
     // For now, matching the example's structure.
 
+    // Custom payloads replace the ones the BLE library builds: flags, service UUID and reading in the advertisement,
+    // the name (which does not fit next to the UUID) in the scan response
+    BLEAdvertisementData scanResponse;
+    if (strlen(_deviceName) > ESP_BLE_ADV_DATA_LEN_MAX - 2) {
+        scanResponse.setShortName(String(_deviceName, ESP_BLE_ADV_DATA_LEN_MAX - 2));
+    } else {
+        scanResponse.setName(_deviceName);
+    }
+    pAdvertising->setScanResponseData(scanResponse);
+
+    // Built once, updateAdvertisedReading() only patches the reading in place
+    uint8_t values[AdvertisedReadingSchema::size];
+    AdvertisedReadingSchema::encode(values, ADVERTISING_COMPANY_ID, INT16_MIN, UINT16_MAX, _advertisedSequence);
+    BLEAdvertisementData advertisement;
+    advertisement.setFlags(ESP_BLE_ADV_FLAG_GEN_DISC | ESP_BLE_ADV_FLAG_BREDR_NOT_SPT);
+    advertisement.setCompleteServices(BLEUUID(RECORD_SERVICE_UUID));
+    advertisement.setManufacturerData(String(values, sizeof(values)));
+    pAdvertising->setAdvertisementData(advertisement);
+    const String payload = advertisement.getPayload();
+    memcpy(_advertisingData, payload.c_str(), payload.length());
+    _advertisingLength = payload.length();
+
     BLEDevice::startAdvertising();
     Serial.println("BLE Sensor Server started. Advertising...");
     Serial.print("Service UUID: ");
     Serial.println(RECORD_SERVICE_UUID);
 }
 
-void BleSensorServer::sendRecords(const uint16_t offset) const {
-    const uint16_t first = _fram->readUInt16(FIRST_RECORD_ADDRESS);
-    const uint16_t last  = _fram->readUInt16(LAST_RECORD_ADDRESS);
+ClientSession *BleSensorServer::openSession(const uint16_t connId) {
+    ClientSession *session = findSession(connId);
+    if (session != nullptr) {
+        return session;
+    }
+    for (auto &candidate: _sessions) {
+        if (!candidate.active) {
+            candidate = ClientSession();
+            candidate.active = true;
+            candidate.connId = connId;
+            return &candidate;
+        }
+    }
+    return nullptr;
+}
 
-    // Calculate how many full records are available
-    uint16_t available;
-    if (last >= first)
-        available = (last - first) / RECORD_SIZE_BYTES;
-    else
-        available = (RECORD_END_ADDRESS - first + last - RECORD_START_ADDRESS) / RECORD_SIZE_BYTES;
+ClientSession *BleSensorServer::findSession(const uint16_t connId) {
+    for (auto &session: _sessions) {
+        if (session.active && session.connId == connId) {
+            return &session;
+        }
+    }
+    return nullptr;
+}
 
-    if (offset >= available) {
-        _dataCharacteristic->setValue(nullptr, 0);
+void BleSensorServer::closeSession(const uint16_t connId) {
+    ClientSession *session = findSession(connId);
+    if (session == nullptr) {
         return;
     }
+    session->active = false;
+    if (session->stats.requests == 0) {
+        return; // Connected without syncing
+    }
 
-    // Compute record address, handling wrap
-    int32_t address = last - offset * RECORD_SIZE_BYTES;
-    if (address < RECORD_START_ADDRESS)
-        address += (RECORD_END_ADDRESS - RECORD_START_ADDRESS);
+    SyncStats &stats = session->stats;
+    stats.activeMillis = stats.reads > 0 ? session->lastReadAt - session->firstRequestAt : 0;
+    Serial.print("Sync: ");
+    printSyncStats(Serial, stats);
 
-    // Read and send
-    const auto reading = _fram->readSensorReading(address);
-    BluetoothRecord record = {
-        offset,
-        reading.temperature,
-        reading.humidity,
-        reading.timestamp
-    };
+    _syncTotals.requests += stats.requests;
+    _syncTotals.reads += stats.reads;
+    _syncTotals.records += stats.records;
+    _syncTotals.bytes += stats.bytes;
+    _syncTotals.activeMillis += stats.activeMillis;
+    _syncCount++;
+}
 
-    uint8_t buffer[BLUETOOTH_RECORD_SIZE];
-    serializeBluetoothRecord(&record, buffer);
-    _dataCharacteristic->setValue(buffer, BLUETOOTH_RECORD_SIZE);
+void BleSensorServer::reportSync(Print &out) {
+    out.print("BLE syncs: ");
+    out.print(_syncCount);
+    out.print(", ");
+    printSyncStats(out, _syncTotals);
+
+    _syncTotals = SyncStats();
+    _syncCount = 0;
+}
+
+void BleSensorServer::printSyncStats(Print &out, const SyncStats &stats) {
+    out.print(stats.records);
+    out.print(" records / ");
+    out.print(stats.bytes);
+    out.print(" B in ");
+    out.print(stats.activeMillis);
+    out.print(" ms (");
+    out.print(stats.activeMillis > 0 ? stats.records * 1000 / stats.activeMillis : 0);
+    out.print(" records/s), ");
+    out.print(stats.requests);
+    out.print(" requests, ");
+    out.print(stats.reads);
+    out.println(" reads");
 }
 
+void BleSensorServer::sendRecords(ClientSession &session, const uint16_t offset, const uint16_t count) const {
+    session.cursor = offset;
+    session.responseLength = 0;
 
-void BleSensorServer::updateCurrentRecord() const {
-    BluetoothRecord reading = {
-        0xFFFF,
-        _sht->getTemperature(),
-        _sht->getHumidity(),
-        _rtc->getCurrentDateTime().Unix32Time(),
-    };
-    uint8_t buffer[BLUETOOTH_RECORD_SIZE];
-    serializeBluetoothRecord(&reading, buffer);
-    _dataCharacteristic->setValue(buffer, BLUETOOTH_RECORD_SIZE);
+    const uint16_t maxRecords = maxResponseRecords(session);
+    const uint16_t wanted = count < maxRecords ? count : maxRecords;
+
+    // Records come newest first in their stored layout, transcode them into the response
+    uint8_t stored[BATCH_MAX_RECORDS * RECORD_SIZE_BYTES];
+    const uint16_t read = _records->readRecords(offset, stored, wanted);
+    session.stats.records += read;
+    uint8_t *out = session.response;
+    for (uint16_t i = 0; i < read; ++i) {
+        const uint8_t *record = stored + i * RECORD_SIZE_BYTES;
+        BluetoothRecordSchema::put<BT_OFFSET>(out, offset + i);
+        wire::copyField<StoredRecordSchema, STORED_TEMPERATURE, BluetoothRecordSchema, BT_TEMPERATURE>(record, out);
+        wire::copyField<StoredRecordSchema, STORED_HUMIDITY, BluetoothRecordSchema, BT_HUMIDITY>(record, out);
+        wire::copyField<StoredRecordSchema, STORED_TIMESTAMP, BluetoothRecordSchema, BT_TIMESTAMP>(record, out);
+        out += BLUETOOTH_RECORD_SIZE;
+    }
+    session.responseLength = out - session.response;
 }
 
 
-bool BleSensorServer::isClientConnected() {
-    return _connectedClients > 0;
+void BleSensorServer::handleAlertRule(ClientSession &session, const uint8_t *request, size_t length) const {
+    session.responseLength = 0;
+    if (length < AlertRuleRequestSchema::size) {
+        return;
+    }
+    const uint8_t index = AlertRuleRequestSchema::get<ALERT_REQUEST_INDEX>(request);
+
+    AlertRule rule;
+    if (AlertRuleRequestSchema::get<ALERT_REQUEST_WRITE>(request) != 0) {
+        if (length < AlertRuleRequestSchema::size + AlertRuleSchema::size) {
+            return;
+        }
+        rule = AlertEngine::decodeRule(request + AlertRuleRequestSchema::size);
+        if (!_alerts->setRule(index, rule)) {
+            Serial.println("Rejected alert rule");
+            return;
+        }
+        Serial.print("Alert rule ");
+        Serial.print(index);
+        Serial.println(" staged");
+    } else if (!_alerts->getRule(index, rule)) {
+        return;
+    }
+    session.response[0] = index;
+    AlertEngine::encodeRule(session.response + 1, rule);
+    session.responseLength = 1 + AlertRuleSchema::size;
 }
 
-void BleSensorServer::serializeBluetoothRecord(BluetoothRecord *record, uint8_t *buffer) const {
-    size_t i = 0;
+void BleSensorServer::sendAlertEvents(ClientSession &session, uint8_t offset, uint8_t count) const {
+    const uint16_t mtuEvents = (_pServer->getPeerMTU(session.connId) - 1) / AlertEventSchema::size;
+    if (count > ALERT_EVENT_SLOTS) count = ALERT_EVENT_SLOTS;
+    if (count > mtuEvents) count = mtuEvents > 0 ? mtuEvents : 1;
+    session.responseLength = _alerts->readEvents(offset, session.response, count) * AlertEventSchema::size;
+}
 
-    // Serialize offset (uint16_t)
-    buffer[i++] = record->offset & 0xFF;
-    buffer[i++] = (record->offset >> 8) & 0xFF;
+void BleSensorServer::sendBurst(ClientSession &session, uint16_t offset, uint8_t count) const {
+    // Header first: it tells the client the capture start, how many samples are written so far and their interval
+    const uint16_t mtuSamples = (_pServer->getPeerMTU(session.connId) - 1 - BurstHeaderSchema::size)
+                                / BurstSampleSchema::size;
+    const uint16_t maxSamples = (BLUETOOTH_RESPONSE_MAX_SIZE - BurstHeaderSchema::size) / BurstSampleSchema::size;
+    uint16_t wanted = count;
+    if (wanted > maxSamples) wanted = maxSamples;
+    if (wanted > mtuSamples) wanted = mtuSamples;
 
-    // Serialize temperature (float)
-    memcpy(&buffer[i], &record->temperature, sizeof(float));
-    i += sizeof(float);
+    const uint16_t available = _burst->getSampleCount();
+    BurstHeaderSchema::encode(session.response, _burst->getStartTimestamp(), available,
+                              _burst->getSampleInterval());
+    const uint16_t read = _burst->readSamples(offset, session.response + BurstHeaderSchema::size, wanted);
+    session.cursor = offset;
+    session.responseLength = BurstHeaderSchema::size + read * BurstSampleSchema::size;
+}
 
-    // Serialize humidity (float)
-    memcpy(&buffer[i], &record->humidity, sizeof(float));
-    i += sizeof(float);
+void BleSensorServer::handleDeadband(ClientSession &session, const uint8_t *request) const {
+    session.responseLength = 0;
+    float temperature;
+    float humidity;
+    if (DeadbandRequestSchema::get<DEADBAND_WRITE>(request) != 0) {
+        temperature = DeadbandRequestSchema::get<DEADBAND_TEMPERATURE>(request);
+        humidity = DeadbandRequestSchema::get<DEADBAND_HUMIDITY>(request);
+        if (!_recorder->setDeadband(temperature, humidity)) {
+            Serial.println("Rejected deadbands");
+            return;
+        }
+        Serial.print("Deadbands staged: ");
+        Serial.print(temperature);
+        Serial.print(" C, ");
+        Serial.print(humidity);
+        Serial.println(" %RH");
+    } else {
+        _recorder->getDeadband(temperature, humidity);
+    }
+    DeadbandSchema::encode(session.response, temperature, humidity);
+    session.responseLength = DeadbandSchema::size;
+}
+
+void BleSensorServer::notifyAlert(const AlertEvent &event) {
+    if (_alertCharacteristic == nullptr) {
+        return;
+    }
+    // Kept in the server: the stack serves later reads of the characteristic from this buffer
+    AlertEventSchema::encode(_alertValue, event.rule, event.raised ? 1 : 0, event.value, event.timestamp);
+    _alertCharacteristic->setValue(_alertValue, sizeof(_alertValue));
+    if (_connectedClients > 0) {
+        _alertCharacteristic->notify();
+    }
+}
 
-    // Serialize timestamp (uint32_t)
-    buffer[i++] = record->timestamp & 0xFF;
-    buffer[i++] = (record->timestamp >> 8) & 0xFF;
-    buffer[i++] = (record->timestamp >> 16) & 0xFF;
-    buffer[i++] = (record->timestamp >> 24) & 0xFF;
+uint16_t BleSensorServer::maxResponseRecords(const ClientSession &session) const {
+    // Never answer more than what fits in one ATT read, long reads are not routed through the session
+    const uint16_t mtuRecords = (_pServer->getPeerMTU(session.connId) - 1) / BLUETOOTH_RECORD_SIZE;
+    if (mtuRecords == 0) {
+        return 1;
+    }
+    return mtuRecords < BATCH_MAX_RECORDS ? mtuRecords : BATCH_MAX_RECORDS;
+}
+
+void BleSensorServer::startDownsample(ClientSession &session, const uint8_t *request) const {
+    session.cursor = 0;
+    session.responseLength = 0;
+    const uint32_t from = DownsampleRequestSchema::get<DOWNSAMPLE_FROM>(request);
+    const uint32_t to = DownsampleRequestSchema::get<DOWNSAMPLE_TO>(request);
+    const uint16_t points = DownsampleRequestSchema::get<DOWNSAMPLE_POINTS>(request);
+    const LttbSeries series = DownsampleRequestSchema::get<DOWNSAMPLE_SERIES>(request) == LTTB_SERIES_HUMIDITY
+                                  ? LTTB_SERIES_HUMIDITY
+                                  : LTTB_SERIES_TEMPERATURE;
+    Serial.print("Downsampling ");
+    Serial.print(from);
+    Serial.print(" - ");
+    Serial.print(to);
+    Serial.print(" to ");
+    Serial.print(points);
+    Serial.println(" points");
+    // An empty range leaves the downsampler inactive: the first read is empty
+    session.downsampler.begin(_records, from, to, points, series);
+    session.streaming = true;
+}
+
+void BleSensorServer::sendDownsampled(ClientSession &session) const {
+    // Points are computed on demand, one response worth at a time
+    const uint16_t maxRecords = maxResponseRecords(session);
+    uint8_t *out = session.response;
+    uint16_t produced = 0;
+    SensorReading reading;
+    uint32_t offset;
+    while (produced < maxRecords && session.downsampler.next(reading, offset)) {
+        BluetoothRecordSchema::encode(
+            out,
+            offset < CURRENT_RECORD_OFFSET ? offset : CURRENT_RECORD_OFFSET - 1,
+            reading.temperature,
+            reading.humidity,
+            reading.timestamp
+        );
+        out += BLUETOOTH_RECORD_SIZE;
+        produced++;
+    }
+    session.cursor += produced;
+    session.responseLength = out - session.response;
+    session.streaming = produced > 0;
+    session.stats.records += produced;
+}
+
+void BleSensorServer::updateAdvertisedReading(const SensorReading &reading) {
+    if (_advertisingLength < AdvertisedReadingSchema::size) {
+        return; // Not started
+    }
+    uint8_t values[AdvertisedReadingSchema::size];
+    AdvertisedReadingSchema::encode(
+        values,
+        ADVERTISING_COMPANY_ID,
+        isnan(reading.temperature) ? INT16_MIN : (int16_t) lroundf(reading.temperature * 100),
+        isnan(reading.humidity) ? UINT16_MAX : (uint16_t) lroundf(reading.humidity * 100),
+        ++_advertisedSequence
+    );
+    // Manufacturer data closes the advertisement. The GAP copies the payload, no allocation here; the lock keeps the
+    // update from racing a restart of advertising by the BLE task
+    std::lock_guard<std::mutex> guard(_advertisingLock);
+    memcpy(_advertisingData + _advertisingLength - sizeof(values), values, sizeof(values));
+    esp_ble_gap_config_adv_data_raw(_advertisingData, _advertisingLength);
+}
+
+void BleSensorServer::updateCurrentRecord(ClientSession &session) const {
+    session.cursor = CURRENT_RECORD_OFFSET;
+    session.responseLength = 0;
+
+    // Consistent snapshot of the last sample, no sensor or RTC access from the BLE task
+    SensorReading reading;
+    if (!_readings->latest(reading)) {
+        return;
+    }
+    BluetoothRecordSchema::encode(
+        session.response,
+        CURRENT_RECORD_OFFSET,
+        reading.temperature,
+        reading.humidity,
+        reading.timestamp
+    );
+    session.responseLength = BLUETOOTH_RECORD_SIZE;
+}
+
+
+bool BleSensorServer::isClientConnected() {
+    return _connectedClients > 0;
 }
@@ -6,48 +6,142 @@
 #define BLESERVER_H
 
 #include <Arduino.h> // For Serial prints
+#include <mutex>
 #include <BLEDevice.h>
 #include <BLEServer.h>
 #include <BLEUtils.h>
 #include <BLE2902.h> // For CCCD descriptor for notifications
-#include <FramStorage.h> // For CCCD descriptor for notifications
-#include <SHTSensor.h>
-#include <DS3132Clock.h>
-#include <utility>
+#include <esp_gap_ble_api.h>
+#include <RecordStore.h>
+#include <AlertEngine.h>
+#include <LttbDownsampler.h>
+#include <BurstCapture.h>
+#include <ReadingBus.h>
+#include <AdaptiveRecorder.h>
 
 
 #include "SensorReading.h"
+#include <WireSchema.h>
 
 
 // Default UUIDs from your example
 #define RECORD_SERVICE_UUID                "4fafc201-1fb5-459e-8fcc-c5c9c331914b"
 #define RECORD_REQUEST_CHARACTERISTIC_UUID      "00000001-1fb5-459e-8fcc-c5c9c331914b"
 #define RECORD_DATA_CHARACTERISTIC_UUID         "00000002-1fb5-459e-8fcc-c5c9c331914b"
+#define ALERT_CHARACTERISTIC_UUID               "00000003-1fb5-459e-8fcc-c5c9c331914b"
 #define BLUETOOTH_RECORD_SIZE 14
-
-struct BluetoothRecord {
-    uint16_t offset;
-    float temperature;
-    float humidity;
-    uint32_t timestamp; // 'long' is typically 32-bit on Arduino
-
-    // Default constructor (optional, but good practice)
-    BluetoothRecord() : offset(0), temperature(0.0f), humidity(0.0f),  timestamp(0L) {}
-    BluetoothRecord(const uint16_t offset, const float temp, const float hum, const uint32_t ts) : offset(offset), temperature(temp), humidity(hum),  timestamp(ts) {}
+#define CURRENT_RECORD_OFFSET 0xFFFF
+
+// Batch requests: [REQUEST_BATCH_OPCODE][first offset][count], answered with up to count consecutive records
+#define REQUEST_BATCH_OPCODE 0x01
+#define BATCH_MAX_RECORDS 32
+#define BLUETOOTH_RESPONSE_MAX_SIZE (BATCH_MAX_RECORDS * BLUETOOTH_RECORD_SIZE)
+
+// Downsampled history: [REQUEST_DOWNSAMPLE_OPCODE][from][to][points][series], every following read of the data
+// characteristic returns the next records of the LTTB series (oldest first), an empty read ends it. The offset field
+// of these records is their store offset when read. Records appended meanwhile do not disturb the series, it ends
+// early if its oldest record is dropped from the store (full ring) before the last point.
+#define REQUEST_DOWNSAMPLE_OPCODE 0x02
+
+// Alert rules: [REQUEST_ALERT_RULE_OPCODE][index][0] reads a rule, [REQUEST_ALERT_RULE_OPCODE][index][1][AlertRule]
+// replaces it. Both are answered with [index][AlertRule]: the rule in use for a read, the accepted rule for a write
+// (in use from the next sample). An empty answer means the rule was invalid, or being applied: read it again.
+#define REQUEST_ALERT_RULE_OPCODE 0x03
+// Alert log: [REQUEST_ALERT_EVENTS_OPCODE][first offset][count], answered with events newest first
+#define REQUEST_ALERT_EVENTS_OPCODE 0x04
+
+// Burst capture: [REQUEST_BURST_START_OPCODE][samples] starts one, [REQUEST_BURST_READ_OPCODE][first sample][count]
+// is answered with the capture header followed by up to count samples. A capture holds at most BURST_MAX_SAMPLES
+// (126 samples, about 12.6 s at 10 Hz: the FRAM left after the alert region), longer requests are clamped. The header
+// interval is the one measured on the sensor, within a few percent of 100 ms: sample i was taken i intervals after the
+// first one, which comes at most one interval after the start timestamp.
+#define REQUEST_BURST_START_OPCODE 0x05
+#define REQUEST_BURST_READ_OPCODE 0x06
+
+// Recording deadbands: [REQUEST_DEADBAND_OPCODE][write][temperature][humidity], always the full length, the values
+// are ignored unless write is 1. Answered with [temperature][humidity]: the accepted values after a write (applied
+// from the next sample on), the ones in use otherwise.
+#define REQUEST_DEADBAND_OPCODE 0x07
+
+// Connectionless current reading, in the manufacturer specific data of every advertisement:
+// company id, temperature (centi °C), humidity (centi %RH), sequence incremented on each sample
+#define ADVERTISING_COMPANY_ID 0xFFFF // Bluetooth SIG id reserved for tests and internal use
+using AdvertisedReadingSchema = wire::Schema<uint16_t, int16_t, uint16_t, uint8_t>;
+enum AdvertisedReadingField : size_t { ADV_COMPANY, ADV_TEMPERATURE, ADV_HUMIDITY, ADV_SEQUENCE };
+
+// One session per simultaneous connection, matches the default ESP32 BLE connection limit (CONFIG_BT_ACL_CONNECTIONS).
+// Advertising is restarted after each connection until they are all in use.
+#define MAX_CLIENT_SESSIONS 4
+
+// Over the air record: offset, temperature, humidity, timestamp
+using BluetoothRecordSchema = wire::Schema<uint16_t, float, float, uint32_t>;
+enum BluetoothRecordField : size_t { BT_OFFSET, BT_TEMPERATURE, BT_HUMIDITY, BT_TIMESTAMP };
+static_assert(BluetoothRecordSchema::size == BLUETOOTH_RECORD_SIZE, "Bluetooth record schema does not match BLUETOOTH_RECORD_SIZE");
+
+// Requests written by clients on the request characteristic. Opcode requests are always longer than the two byte
+// single record request so that both can be told apart by their length.
+using RecordRequestSchema = wire::Schema<uint16_t>; // Single record offset, or CURRENT_RECORD_OFFSET
+using BatchRequestSchema = wire::Schema<uint8_t, uint16_t, uint8_t>;
+enum BatchRequestField : size_t { BATCH_OPCODE, BATCH_OFFSET, BATCH_COUNT };
+using DownsampleRequestSchema = wire::Schema<uint8_t, uint32_t, uint32_t, uint16_t, uint8_t>;
+enum DownsampleRequestField : size_t { DOWNSAMPLE_OPCODE, DOWNSAMPLE_FROM, DOWNSAMPLE_TO, DOWNSAMPLE_POINTS, DOWNSAMPLE_SERIES };
+using AlertRuleRequestSchema = wire::Schema<uint8_t, uint8_t, uint8_t>;
+enum AlertRuleRequestField : size_t { ALERT_REQUEST_OPCODE, ALERT_REQUEST_INDEX, ALERT_REQUEST_WRITE };
+using AlertEventsRequestSchema = wire::Schema<uint8_t, uint8_t, uint8_t>;
+enum AlertEventsRequestField : size_t { EVENTS_REQUEST_OPCODE, EVENTS_REQUEST_OFFSET, EVENTS_REQUEST_COUNT };
+using BurstStartRequestSchema = wire::Schema<uint8_t, uint16_t>;
+enum BurstStartRequestField : size_t { BURST_START_OPCODE, BURST_START_SAMPLES };
+using BurstReadRequestSchema = wire::Schema<uint8_t, uint16_t, uint8_t>;
+enum BurstReadRequestField : size_t { BURST_READ_OPCODE, BURST_READ_OFFSET, BURST_READ_COUNT };
+using DeadbandRequestSchema = wire::Schema<uint8_t, uint8_t, float, float>;
+enum DeadbandRequestField : size_t { DEADBAND_OPCODE, DEADBAND_WRITE, DEADBAND_TEMPERATURE, DEADBAND_HUMIDITY };
+using DeadbandSchema = wire::Schema<float, float>;
+static_assert(ALERT_EVENT_SLOTS * AlertEventSchema::size <= BLUETOOTH_RESPONSE_MAX_SIZE, "Alert log does not fit a response");
+
+// Device side view of client syncs: what was asked, what was served and how long it took
+struct SyncStats {
+    uint32_t requests;       // Writes on the request characteristic
+    uint32_t reads;          // Reads of the data characteristic, each one closes a request/read round trip
+    uint32_t records;        // Records served
+    uint32_t bytes;          // Response bytes served, ATT headers excluded
+    uint32_t activeMillis;   // From the first request to the last read
+
+    SyncStats() : requests(0), reads(0), records(0), bytes(0), activeMillis(0) {}
 };
 
-class DS3231Clock;
+/**
+ * State kept for one connected client. Every client gets its own pending response so that concurrent
+ * request/read sequences (e.g. phone and watch syncing at the same time) never see each other's records.
+ */
+struct ClientSession {
+    bool active;
+    uint16_t connId;
+    uint16_t cursor; // Offset of the first record held in response
+    uint8_t response[BLUETOOTH_RESPONSE_MAX_SIZE];
+    uint16_t responseLength;
+    uint32_t firstRequestAt; // millis()
+    uint32_t lastReadAt;
+    SyncStats stats;
+    bool streaming; // Reads are answered with the next downsampled points until one comes back empty
+    LttbDownsampler downsampler;
+
+    ClientSession() : active(false), connId(0), cursor(0), response(), responseLength(0), firstRequestAt(0),
+                      lastReadAt(0), stats(), streaming(false), downsampler() {}
+};
 
 class BleSensorServer {
 public:
     /**
      * @brief Constructor for the BLE Sensor Server.
-     * @param deviceName The name of the BLE device to be advertised.
-     * @param fram
-     * @param sensor
-     * @param rtc
+     * @param deviceName The name of the BLE device to be advertised. Must outlive the server (string literal).
+     * @param records Store the history is served from.
+     * @param readings Bus the sampling task publishes to, current records are served from its latest reading.
+     * @param alerts Engine whose rules and log are exposed to clients.
+     * @param burst Capture started and read by clients.
+     * @param recorder Recording policy whose deadbands are configured by clients.
      */
-    explicit BleSensorServer(String  deviceName, FramStorage* fram, SHTSensor* sensor, DS3231Clock* rtc);
+    explicit BleSensorServer(const char* deviceName, RecordStore* records, ReadingBus* readings, AlertEngine* alerts,
+                             BurstCapture* burst, AdaptiveRecorder* recorder);
 
     /**
      * @brief Initializes the BLE server, service, characteristic, and starts advertising.
@@ -60,35 +154,96 @@ public:
      */
     bool isClientConnected();
 
-private:
-    String _deviceName;
-    BLEServer* _pServer;
-    BLEService* _pService;
-    BLECharacteristic* _requestCharacteristic;
-    BLECharacteristic* _dataCharacteristic;
-    uint32_t _connectedClients;
-    FramStorage* _fram;
-    SHTSensor* _sht;
-    DS3231Clock* _rtc;
+    /**
+     * @brief Pushes an alert event to every client subscribed to the alert characteristic.
+     */
+    void notifyAlert(const AlertEvent& event);
+
+    /**
+     * @brief Places a reading in the advertising payload, clients can then follow it just by scanning.
+     *        Must be called from a single task (the sampling one).
+     */
+    void updateAdvertisedReading(const SensorReading& reading);
 
-    void sendRecords(uint16_t offset) const;
-    void updateCurrentRecord() const;
-    void serializeBluetoothRecord( BluetoothRecord *record, uint8_t *buffer) const ;
+    /**
+     * @brief Prints the totals of the syncs completed since the last report (or boot) and starts a new window.
+     */
+    void reportSync(Print& out);
+
+private:
     // Callback class for server events (connect/disconnect)
     class ServerCallbacks : public BLEServerCallbacks {
         BleSensorServer* _owner;
     public:
         explicit ServerCallbacks(BleSensorServer* owner) : _owner(owner) {}
-        void onConnect(BLEServer* pServer) override;
-        void onDisconnect(BLEServer* pServer) override;
+        void onConnect(BLEServer* pServer, esp_ble_gatts_cb_param_t* param) override;
+        void onDisconnect(BLEServer* pServer, esp_ble_gatts_cb_param_t* param) override;
     };
 
     class RecordRequestCallbacks final : public BLECharacteristicCallbacks {
         BleSensorServer* _owner;
     public:
         explicit RecordRequestCallbacks(BleSensorServer* owner) : _owner(owner) {}
-        void onWrite(BLECharacteristic *pCharacteristic) override;
+        void onWrite(BLECharacteristic *pCharacteristic, esp_ble_gatts_cb_param_t* param) override;
+    };
+
+    // Serves the pending response of the reading client, called by the stack right before it answers the read
+    class RecordDataCallbacks final : public BLECharacteristicCallbacks {
+        BleSensorServer* _owner;
+    public:
+        explicit RecordDataCallbacks(BleSensorServer* owner) : _owner(owner) {}
+        void onRead(BLECharacteristic *pCharacteristic, esp_ble_gatts_cb_param_t* param) override;
     };
+
+    const char* _deviceName;
+    BLEServer* _pServer;
+    BLEService* _pService;
+    BLECharacteristic* _requestCharacteristic;
+    BLECharacteristic* _dataCharacteristic;
+    BLECharacteristic* _alertCharacteristic;
+    uint32_t _connectedClients;
+    RecordStore* _records;
+    ReadingBus* _readings;
+    AlertEngine* _alerts;
+    BurstCapture* _burst;
+    AdaptiveRecorder* _recorder;
+    uint8_t _alertValue[AlertEventSchema::size];
+    // Advertisement built in begin(): flags, service UUID, then the reading, patched in place on every sample
+    uint8_t _advertisingData[ESP_BLE_ADV_DATA_LEN_MAX];
+    uint8_t _advertisingLength;
+    uint8_t _advertisedSequence;
+    // Held by the sampling task while it updates the advertisement, and by the BLE task while it restarts advertising
+    std::mutex _advertisingLock;
+    // Sessions closed in the current report window. Written by the BLE task, a report racing a disconnect may
+    // print a partially added session.
+    SyncStats _syncTotals;
+    uint32_t _syncCount;
+    // Only touched from the BLE stack task (GATT callbacks are serialized), no locking needed. The record store they
+    // read is shared with the sampling loop and locks itself (RecordStore::_lock).
+    ClientSession _sessions[MAX_CLIENT_SESSIONS];
+    // Callbacks live inside the server instead of on the heap
+    ServerCallbacks _serverCallbacks;
+    RecordRequestCallbacks _requestCallbacks;
+    RecordDataCallbacks _dataCallbacks;
+
+    ClientSession* openSession(uint16_t connId);
+    ClientSession* findSession(uint16_t connId);
+    void closeSession(uint16_t connId);
+    static void printSyncStats(Print& out, const SyncStats& stats);
+
+    /**
+     * @brief Fills the session response with up to count records starting at offset (0 is the newest).
+     *        The batch is bounded by the client MTU so that it is always served by a single ATT read.
+     */
+    void sendRecords(ClientSession& session, uint16_t offset, uint16_t count) const;
+    void updateCurrentRecord(ClientSession& session) const;
+    void startDownsample(ClientSession& session, const uint8_t* request) const;
+    void sendDownsampled(ClientSession& session) const;
+    [[nodiscard]] uint16_t maxResponseRecords(const ClientSession& session) const;
+    void handleAlertRule(ClientSession& session, const uint8_t* request, size_t length) const;
+    void sendAlertEvents(ClientSession& session, uint8_t offset, uint8_t count) const;
+    void sendBurst(ClientSession& session, uint16_t offset, uint8_t count) const;
+    void handleDeadband(ClientSession& session, const uint8_t* request) const;
 };
 
 
@@ -0,0 +1,142 @@
+#include "BurstCapture.h"
+
+static_assert(BurstHeaderSchema::offset<BURST_INTERVAL>() == BurstHeaderSchema::offset<BURST_COUNT>() + sizeof(uint16_t),
+              "spill() updates the count and the interval in one write");
+
+BurstCapture::BurstCapture(FramStorage *fram)
+    : _fram(fram),
+      _requested(0),
+      _startTimestamp(0),
+      _spilled(0),
+      _interval(BURST_SAMPLE_INTERVAL_MS),
+      _target(0),
+      _buffered(0),
+      _firstSampleAt(0),
+      _lastSampleAt(0),
+      _buffer() {
+}
+
+void BurstCapture::begin() {
+    uint8_t header[BurstHeaderSchema::size];
+    if (_fram->readBytes(BURST_CAPTURE_ADDRESS, header, sizeof(header)) != sizeof(header)) {
+        return;
+    }
+    const uint16_t count = BurstHeaderSchema::get<BURST_COUNT>(header);
+    const uint16_t interval = BurstHeaderSchema::get<BURST_INTERVAL>(header);
+    if (count > BURST_MAX_SAMPLES || interval < BURST_SAMPLE_INTERVAL_MS - BURST_INTERVAL_TOLERANCE_MS
+        || interval > BURST_SAMPLE_INTERVAL_MS + BURST_INTERVAL_TOLERANCE_MS) {
+        return; // Never captured
+    }
+    _startTimestamp.store(BurstHeaderSchema::get<BURST_START>(header));
+    _interval.store(interval);
+    _spilled.store(count);
+}
+
+void BurstCapture::request(uint16_t samples) {
+    if (samples == 0) {
+        return;
+    }
+    _requested.store(samples < BURST_MAX_SAMPLES ? samples : BURST_MAX_SAMPLES, std::memory_order_release);
+}
+
+bool BurstCapture::takeRequest(uint16_t &samples) {
+    samples = _requested.exchange(0, std::memory_order_acquire);
+    return samples > 0;
+}
+
+void BurstCapture::start(uint32_t timestamp, uint16_t samples, uint32_t nowMillis) {
+    // Readers see an empty capture until the first spill
+    _spilled.store(0, std::memory_order_release);
+    _startTimestamp.store(timestamp, std::memory_order_release);
+    _interval.store(BURST_SAMPLE_INTERVAL_MS, std::memory_order_release);
+    _target = samples < BURST_MAX_SAMPLES ? samples : BURST_MAX_SAMPLES;
+    _buffered = 0;
+    _firstSampleAt = nowMillis;
+    _lastSampleAt = nowMillis;
+
+    uint8_t header[BurstHeaderSchema::size];
+    BurstHeaderSchema::encode(header, timestamp, 0, BURST_SAMPLE_INTERVAL_MS);
+    _fram->writeBytes(BURST_CAPTURE_ADDRESS, header, sizeof(header));
+}
+
+void BurstCapture::add(float temperature, float humidity, uint32_t atMillis) {
+    if (isCapturing()) {
+        append(temperature, humidity, atMillis);
+    }
+}
+
+void BurstCapture::skipMissed(uint32_t nowMillis) {
+    // Missing samples go where the sensor should have measured them, at the nominal interval
+    while (isCapturing() && (int32_t) (nowMillis - _lastSampleAt) >= BURST_MISSED_SAMPLE_MS) {
+        append(NAN, NAN, _lastSampleAt + BURST_SAMPLE_INTERVAL_MS);
+    }
+}
+
+void BurstCapture::append(float temperature, float humidity, uint32_t atMillis) {
+    if (_spilled.load(std::memory_order_relaxed) + _buffered == 0) {
+        _firstSampleAt = atMillis;
+    }
+    _lastSampleAt = atMillis;
+
+    // NAN (missing sample) is stored as the out of range INT16_MIN / UINT16_MAX
+    BurstSampleSchema::encode(
+        _buffer + _buffered * BurstSampleSchema::size,
+        isnan(temperature) ? INT16_MIN : (int16_t) lroundf(temperature * 100),
+        isnan(humidity) ? UINT16_MAX : (uint16_t) lroundf(humidity * 100)
+    );
+    _buffered++;
+
+    if (_buffered == BURST_SPILL_SAMPLES || _spilled.load(std::memory_order_relaxed) + _buffered == _target) {
+        spill();
+    }
+}
+
+bool BurstCapture::isCapturing() const {
+    return _spilled.load(std::memory_order_relaxed) + _buffered < _target;
+}
+
+uint16_t BurstCapture::getSampleCount() const {
+    return _spilled.load(std::memory_order_acquire);
+}
+
+uint32_t BurstCapture::getStartTimestamp() const {
+    return _startTimestamp.load(std::memory_order_acquire);
+}
+
+uint16_t BurstCapture::getSampleInterval() const {
+    return _interval.load(std::memory_order_acquire);
+}
+
+uint16_t BurstCapture::readSamples(uint16_t offset, uint8_t *buffer, uint16_t maxSamples) {
+    const uint16_t available = getSampleCount();
+    if (offset >= available) {
+        return 0;
+    }
+    const uint16_t count = available - offset < maxSamples ? available - offset : maxSamples;
+    const uint16_t address = BURST_CAPTURE_ADDRESS + BurstHeaderSchema::size + offset * BurstSampleSchema::size;
+    return _fram->readBytes(address, buffer, count * BurstSampleSchema::size) / BurstSampleSchema::size;
+}
+
+void BurstCapture::spill() {
+    const uint16_t spilled = _spilled.load(std::memory_order_relaxed);
+    const uint16_t total = spilled + _buffered;
+    _fram->writeBytes(BURST_CAPTURE_ADDRESS + BurstHeaderSchema::size + spilled * BurstSampleSchema::size,
+                      _buffer, _buffered * BurstSampleSchema::size);
+
+    // Mean interval on the sensor's oscillator, rounded to the ms: under one sample of error over a full capture
+    uint16_t interval = _interval.load(std::memory_order_relaxed);
+    if (total >= 2) {
+        interval = (uint16_t) ((_lastSampleAt - _firstSampleAt + (total - 1) / 2) / (total - 1));
+    }
+
+    // Samples first, then the count and interval (adjacent in the header): a reader never gets a sample that is not
+    // written
+    uint8_t countAndInterval[2 * sizeof(uint16_t)];
+    wire::storeLittleEndian<uint16_t>(countAndInterval, total);
+    wire::storeLittleEndian<uint16_t>(countAndInterval + sizeof(uint16_t), interval);
+    _fram->writeBytes(BURST_CAPTURE_ADDRESS + BurstHeaderSchema::offset<BURST_COUNT>(), countAndInterval,
+                      sizeof(countAndInterval));
+    _interval.store(interval, std::memory_order_release);
+    _spilled.store(total, std::memory_order_release);
+    _buffered = 0;
+}
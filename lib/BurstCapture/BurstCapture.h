@@ -0,0 +1,121 @@
+#ifndef BURSTCAPTURE_H
+#define BURSTCAPTURE_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <FramStorage.h>
+#include <WireSchema.h>
+
+// Fastest SHT3x periodic mode (10 measurements per second, low repeatability), nominal: the sensor's own oscillator
+// sets the actual interval
+#define BURST_SAMPLE_INTERVAL_MS    100
+// The sensor is polled this often during a capture, each new measurement is one sample
+#define BURST_POLL_INTERVAL_MS      20
+// No new measurement for this long: a missing sample is recorded in its place
+#define BURST_MISSED_SAMPLE_MS      (2 * BURST_SAMPLE_INTERVAL_MS)
+// Measured intervals further than this from the nominal one are not a capture header (blank FRAM)
+#define BURST_INTERVAL_TOLERANCE_MS 20
+// Samples collected in RAM before being written to FRAM in one transfer
+#define BURST_SPILL_SAMPLES         8
+
+// FRAM capture region, the last 512 bytes of the chip after the alert region
+#define BURST_CAPTURE_ADDRESS       0x7E00
+#define BURST_CAPTURE_END           0x8000
+
+// Capture header: start timestamp, samples written, sample interval in ms (measured, nominal until two samples)
+using BurstHeaderSchema = wire::Schema<uint32_t, uint16_t, uint16_t>;
+enum BurstHeaderField : size_t { BURST_START, BURST_COUNT, BURST_INTERVAL };
+// One sample: temperature in centi °C, humidity in centi %RH
+using BurstSampleSchema = wire::Schema<int16_t, uint16_t>;
+enum BurstSampleField : size_t { BURST_TEMPERATURE, BURST_HUMIDITY };
+
+// 126 samples, about 12.6 s at 10 Hz
+#define BURST_MAX_SAMPLES ((BURST_CAPTURE_END - BURST_CAPTURE_ADDRESS - BurstHeaderSchema::size) / BurstSampleSchema::size)
+
+/**
+ * High-rate capture of a short window (misting cycle, vent opening) next to the normal history.
+ *
+ * The sampling task polls the sensor every BURST_POLL_INTERVAL_MS while a capture runs and adds each new measurement.
+ * Fetching at the nominal 10 Hz would drift against the sensor's oscillator (up to a few percent off), skipping or
+ * missing conversions; this way every conversion is one sample and the header carries the interval measured between
+ * them. Samples are buffered in RAM and spilled to the FRAM capture region every BURST_SPILL_SAMPLES, the header is
+ * updated with each spill so that readers only ever see written samples. A new capture replaces the previous one.
+ *
+ * Captures are requested from any task (BLE, alerts) with request(), the sampling task starts them.
+ */
+class BurstCapture {
+public:
+    explicit BurstCapture(FramStorage* fram);
+
+    /**
+     * @brief Restores the header of the last capture, it stays readable after a reboot.
+     */
+    void begin();
+
+    /**
+     * @brief Asks for a capture. Safe to call from any task.
+     * @param samples Window length in samples, clamped to BURST_MAX_SAMPLES.
+     */
+    void request(uint16_t samples);
+
+    /**
+     * @brief Takes the pending request, if any. Sampling task only.
+     */
+    bool takeRequest(uint16_t& samples);
+
+    /**
+     * @brief Starts a capture, replacing the previous one. Sampling task only.
+     * @param timestamp Start time, the first sample is measured up to one interval later.
+     * @param nowMillis millis() when the sensor was switched to the burst mode.
+     */
+    void start(uint32_t timestamp, uint16_t samples, uint32_t nowMillis);
+
+    /**
+     * @brief Adds a new measurement to the running capture. Sampling task only.
+     * @param atMillis millis() when it was fetched.
+     */
+    void add(float temperature, float humidity, uint32_t atMillis);
+
+    /**
+     * @brief Records a missing sample (NAN values) for every interval without measurement past
+     *        BURST_MISSED_SAMPLE_MS, so that a failing sensor neither stalls the capture nor shifts later samples.
+     *        Sampling task only, after each poll.
+     */
+    void skipMissed(uint32_t nowMillis);
+
+    [[nodiscard]] bool isCapturing() const;
+
+    /**
+     * @return Samples of the last capture available to readers, and its start timestamp.
+     */
+    [[nodiscard]] uint16_t getSampleCount() const;
+    [[nodiscard]] uint32_t getStartTimestamp() const;
+
+    /**
+     * @return Interval between the samples of the last capture in ms, as measured by the sampling task.
+     */
+    [[nodiscard]] uint16_t getSampleInterval() const;
+
+    /**
+     * @brief Reads samples of the last capture, oldest first, in the BurstSampleSchema layout.
+     * @return Number of samples read.
+     */
+    uint16_t readSamples(uint16_t offset, uint8_t* buffer, uint16_t maxSamples);
+
+private:
+    FramStorage* _fram;
+    std::atomic<uint32_t> _requested; // Pending request in samples, 0 if none
+    std::atomic<uint32_t> _startTimestamp;
+    std::atomic<uint32_t> _spilled;  // Samples written to FRAM
+    std::atomic<uint32_t> _interval; // ms, of the spilled samples
+    uint16_t _target;
+    uint16_t _buffered;
+    uint32_t _firstSampleAt; // millis()
+    uint32_t _lastSampleAt;  // millis() of the last sample, or of the start before the first one
+    uint8_t _buffer[BURST_SPILL_SAMPLES * BurstSampleSchema::size];
+
+    void append(float temperature, float humidity, uint32_t atMillis);
+    void spill();
+};
+
+#endif //BURSTCAPTURE_H
@@ -1,4 +1,14 @@
 #include "DS3132Clock.h"
+#include <Trace.h>
+
+// Raw register access for the fast-boot check, names do not clash with the ones of RtcDS3231.h
+#define DS3231CLOCK_I2C_ADDRESS     0x68
+#define DS3231CLOCK_REG_CONTROL     0x0E // Followed by the status register (0x0F)
+#define DS3231CLOCK_CONTROL_EOSC    0x80 // Oscillator disabled on battery
+#define DS3231CLOCK_CONTROL_INTCN   0x04 // INT/SQW pin used for alarms, square wave off
+#define DS3231CLOCK_CONTROL_AIE     0x03 // Alarm 1 and 2 interrupts
+#define DS3231CLOCK_STATUS_OSF      0x80 // Oscillator stopped, time not valid
+#define DS3231CLOCK_STATUS_EN32KHZ  0x08 // 32kHz output enabled
 
 // Constructor: Initializes the RTC object and last error code
 DS3231Clock::DS3231Clock() : _rtc(Wire), _lastErrorCode(Rtc_Wire_Error_None) {
@@ -97,7 +107,38 @@ void DS3231Clock::begin() {
     Serial.println("DS3231Clock: begin() complete.");
 }
 
+bool DS3231Clock::beginFast() {
+    if (isConfigured()) {
+        Serial.println("DS3231Clock: already configured, fast path.");
+        return true;
+    }
+    Serial.println("DS3231Clock: not in the expected state, running full begin().");
+    begin();
+    return false;
+}
+
+bool DS3231Clock::isConfigured() {
+    Wire.beginTransmission(DS3231CLOCK_I2C_ADDRESS);
+    Wire.write(DS3231CLOCK_REG_CONTROL);
+    if (Wire.endTransmission(false) != 0) {
+        return false;
+    }
+    if (Wire.requestFrom(DS3231CLOCK_I2C_ADDRESS, 2) != 2) {
+        return false;
+    }
+    const uint8_t control = Wire.read();
+    const uint8_t status = Wire.read();
+
+    // Same state as the one begin() leaves: running, time valid, 32kHz and square wave outputs off
+    return (control & DS3231CLOCK_CONTROL_EOSC) == 0
+           && (control & DS3231CLOCK_CONTROL_INTCN) != 0
+           && (control & DS3231CLOCK_CONTROL_AIE) == 0
+           && (status & DS3231CLOCK_STATUS_OSF) == 0
+           && (status & DS3231CLOCK_STATUS_EN32KHZ) == 0;
+}
+
 RtcDateTime DS3231Clock::getCurrentDateTime() {
+    TRACE_SCOPE("rtc.now");
     // First, check if the time is marked as valid by the RTC chip itself
     if (!_rtc.IsDateTimeValid()) {
         // This specific check for IsDateTimeValid doesn't involve an I2C read that LastError() would catch
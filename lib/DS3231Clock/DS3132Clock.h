@@ -14,6 +14,11 @@ public:
     // Initializes the RTC module and sets initial time if needed
     void begin();
 
+    // Fast-boot variant of begin(): checks the control and status registers in a single I2C read and
+    // skips the whole configuration if the RTC is already running, valid and configured as begin() leaves it.
+    // Falls back to begin() otherwise. Returns true if the fast path was taken.
+    bool beginFast();
+
     // Gets the current date and time from the RTC
     RtcDateTime getCurrentDateTime();
 
@@ -36,6 +41,9 @@ private:
 
     // Helper function to print RtcDateTime objects to Serial
     void printDateTime(const RtcDateTime &dt);
+
+    // Reads the control and status registers, returns true if they match the state configured by begin()
+    bool isConfigured();
 };
 
 #endif // DS3231CLOCK_H
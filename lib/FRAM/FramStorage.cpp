@@ -3,8 +3,10 @@
 //
 
 #include "FramStorage.h"
+#include <Trace.h>
 
-FramStorage::FramStorage() : _initialized(false), _framSizeBytes(0) {
+FramStorage::FramStorage()
+    : _initialized(false), _framSizeBytes(0), _readTransfers(0), _writeTransfers(0), _bytesRead(0), _bytesWritten(0) {
     // _fram object is default constructed
 }
 
@@ -26,6 +28,22 @@ uint32_t FramStorage::getFramSize() const {
     return _framSizeBytes;
 }
 
+FramTrafficStats FramStorage::getTrafficStats() const {
+    FramTrafficStats stats;
+    stats.readTransfers = _readTransfers.load(std::memory_order_relaxed);
+    stats.writeTransfers = _writeTransfers.load(std::memory_order_relaxed);
+    stats.bytesRead = _bytesRead.load(std::memory_order_relaxed);
+    stats.bytesWritten = _bytesWritten.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void FramStorage::resetTrafficStats() {
+    _readTransfers.store(0, std::memory_order_relaxed);
+    _writeTransfers.store(0, std::memory_order_relaxed);
+    _bytesRead.store(0, std::memory_order_relaxed);
+    _bytesWritten.store(0, std::memory_order_relaxed);
+}
+
 
 bool FramStorage::_checkBounds(uint16_t address, size_t count) const {
     if (!_initialized) {
@@ -52,6 +70,8 @@ uint8_t FramStorage::readByte(uint16_t framAddress) {
     if (!_checkBounds(framAddress, sizeof(uint8_t))) {
         return 0; // Default error value
     }
+    TRACE_SCOPE("fram.read");
+    countRead(1);
     return _fram.read(framAddress);
 }
 
@@ -99,43 +119,26 @@ uint16_t FramStorage::readBytes(uint16_t framAddress, uint8_t* buffer, uint16_t
     
     if (bytesToRead == 0 && length > 0) return 0; // Calculated no bytes to read within bounds
 
-    for (uint16_t i = 0; i < bytesToRead; ++i) {
-        buffer[i] = _fram.read(framAddress + i);
+    // One sequential I2C read instead of one addressed transaction per byte
+    TRACE_SCOPE("fram.read");
+    countRead(bytesToRead);
+    if (!_fram.read(framAddress, buffer, bytesToRead)) {
+        return 0;
     }
     return bytesToRead;
 }
 
-String FramStorage::readString(uint16_t framAddress, uint16_t maxLength) {
-    if (maxLength == 0 || !_initialized) {
-        return String();
-    }
-
-    String result = "";
-    uint16_t currentMaxLength = maxLength;
-
-    if (_framSizeBytes > 0) { // Adjust maxLength based on FRAM size
-        if (framAddress >= _framSizeBytes) {
-            return String(); // Start address out of bounds
-        }
-        if ((uint32_t)framAddress + maxLength > _framSizeBytes) {
-            currentMaxLength = _framSizeBytes - framAddress;
-        }
+uint16_t FramStorage::readString(uint16_t framAddress, char* buffer, uint16_t bufferSize) {
+    if (buffer == nullptr || bufferSize == 0) {
+        return 0;
     }
-    
-    if (currentMaxLength == 0 && maxLength > 0) return String();
-
-
-    // Pre-allocate a reasonable amount of memory for the String
-    result.reserve(currentMaxLength > 32 ? 32 : currentMaxLength);
 
-    for (uint16_t i = 0; i < currentMaxLength; ++i) {
-        uint8_t c = _fram.read(framAddress + i);
-        if (c == '\0') { // Null terminator found
-            break;
-        }
-        result += (char)c;
-    }
-    return result;
+    // The whole window is read in one transfer, readBytes() already clamps it to the FRAM size
+    const uint16_t bytesRead = readBytes(framAddress, reinterpret_cast<uint8_t*>(buffer), bufferSize - 1);
+    buffer[bytesRead] = '\0';
+    const uint16_t length = strnlen(buffer, bytesRead);
+    buffer[length] = '\0';
+    return length;
 }
 
 SensorReading FramStorage::readSensorReading(uint16_t framAddress) {
@@ -145,11 +148,25 @@ SensorReading FramStorage::readSensorReading(uint16_t framAddress) {
     return readGeneric<SensorReading>(framAddress);
 }
 
+RecordRingHeader FramStorage::readRingHeader() {
+    RecordRingHeader header;
+    uint8_t buffer[RecordRingHeaderSchema::size];
+    if (readBytes(LAST_RECORD_TIMESTAMP_ADDRESS, buffer, sizeof(buffer)) != sizeof(buffer)) {
+        return header;
+    }
+    header.lastRecordTimestamp = RecordRingHeaderSchema::get<HEADER_LAST_TIMESTAMP>(buffer);
+    header.firstRecordAddress = RecordRingHeaderSchema::get<HEADER_FIRST_ADDRESS>(buffer);
+    header.lastRecordAddress = RecordRingHeaderSchema::get<HEADER_LAST_ADDRESS>(buffer);
+    return header;
+}
+
 // --- Write Methods ---
 bool FramStorage::writeByte(uint16_t framAddress, uint8_t value) {
     if (!_checkBounds(framAddress, sizeof(uint8_t))) {
         return false;
     }
+    TRACE_SCOPE("fram.write");
+    countWrite(1);
     _fram.write(framAddress, value);
     return true; // Adafruit_FRAM_I2C::write returns void, assume success if bounds check passed
 }
@@ -185,10 +202,10 @@ bool FramStorage::writeBytes(uint16_t framAddress, const uint8_t* buffer, uint16
         return false;
     }
 
-    for (uint16_t i = 0; i < length; ++i) {
-        _fram.write(framAddress + i, buffer[i]);
-    }
-    return true;
+    // The HAL takes a non-const buffer but only reads from it
+    TRACE_SCOPE("fram.write");
+    countWrite(length);
+    return _fram.write(framAddress, const_cast<uint8_t *>(buffer), length);
 }
 
 bool FramStorage::writeString(uint16_t framAddress, const char* str) {
@@ -201,11 +218,10 @@ bool FramStorage::writeString(uint16_t framAddress, const char* str) {
         return false;
     }
 
-    for (uint16_t i = 0; i < len; ++i) {
-        _fram.write(framAddress + i, (uint8_t)str[i]);
-    }
-    _fram.write(framAddress + len, '\0'); // Write null terminator
-    return true;
+    // String and its null terminator in one transfer
+    TRACE_SCOPE("fram.write");
+    countWrite(len + 1);
+    return _fram.write(framAddress, reinterpret_cast<uint8_t *>(const_cast<char *>(str)), len + 1);
 }
 
 bool FramStorage::writeString(uint16_t framAddress, const String& str) {
@@ -216,11 +232,10 @@ bool FramStorage::writeString(uint16_t framAddress, const String& str) {
         return false;
     }
 
-    for (uint16_t i = 0; i < len; ++i) {
-         _fram.write(framAddress + i, (uint8_t)str.charAt(i));
-    }
-    _fram.write(framAddress + len, '\0'); // Write null terminator
-    return true;
+    // c_str() is null terminated: string and terminator in one transfer
+    TRACE_SCOPE("fram.write");
+    countWrite(len + 1);
+    return _fram.write(framAddress, reinterpret_cast<uint8_t *>(const_cast<char *>(str.c_str())), len + 1);
 }
 
 bool FramStorage::writeSensorReading(uint16_t framAddress, const SensorReading& data) {
@@ -234,11 +249,11 @@ bool FramStorage::writeGeneric(uint16_t framAddress, const T& value) {
     if (!_checkBounds(framAddress, sizeof(T))) {
         return false;
     }
-    const uint8_t* p = reinterpret_cast<const uint8_t*>(&value);
-    for (size_t i = 0; i < sizeof(T); ++i) {
-        _fram.write(framAddress + i, p[i]);
-    }
-    return true;
+    // The HAL takes a non-const buffer but only reads from it
+    uint8_t* p = const_cast<uint8_t*>(reinterpret_cast<const uint8_t*>(&value));
+    TRACE_SCOPE("fram.write");
+    countWrite(sizeof(T));
+    return _fram.write(framAddress, p, sizeof(T));
 }
 
 template <typename T>
@@ -248,8 +263,10 @@ T FramStorage::readGeneric(uint16_t framAddress, T defaultValue) {
     }
     T value;
     uint8_t* p = reinterpret_cast<uint8_t*>(&value);
-    for (size_t i = 0; i < sizeof(T); ++i) {
-        p[i] = _fram.read(framAddress + i);
+    TRACE_SCOPE("fram.read");
+    countRead(sizeof(T));
+    if (!_fram.read(framAddress, p, sizeof(T))) {
+        return defaultValue;
     }
     return value;
 }
\ No newline at end of file
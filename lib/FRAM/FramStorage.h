@@ -9,12 +9,12 @@
 #include <Adafruit_FRAM_I2C.h> // The HAL for FRAM interaction
 #include <Arduino.h>           // For String, NAN, etc.
 #include <SensorReading.h>
+#include <WireSchema.h>
+#include <atomic>
 
 // Default I2C address for many FRAM chips (e.g., MB85RC series)
 #define DEFAULT_FRAM_I2C_ADDRESS 0x50
 
-#define RECORD_INTERVAL_SECONDS  (20*60) // 20 minutes
-
 #define LAST_RECORD_TIMESTAMP_ADDRESS   0x00
 #define FIRST_RECORD_ADDRESS            0x04
 #define LAST_RECORD_ADDRESS             0x06
@@ -22,7 +22,36 @@
 #define RECORD_END_ADDRESS              0x7CEC
 
 
+// The three header fields above, read and written as one block
+struct RecordRingHeader {
+    uint32_t lastRecordTimestamp;
+    uint16_t firstRecordAddress;
+    uint16_t lastRecordAddress;
+
+    RecordRingHeader() : lastRecordTimestamp(0), firstRecordAddress(0), lastRecordAddress(0) {}
+};
+using RecordRingHeaderSchema = wire::Schema<uint32_t, uint16_t, uint16_t>;
+enum RecordRingHeaderField : size_t { HEADER_LAST_TIMESTAMP, HEADER_FIRST_ADDRESS, HEADER_LAST_ADDRESS };
+static_assert(RecordRingHeaderSchema::size == RECORD_START_ADDRESS - LAST_RECORD_TIMESTAMP_ADDRESS,
+              "Ring header schema does not match the FRAM header layout");
+
+// Number of record slots NEXT_ADDRESS cycles through before wrapping back to RECORD_START_ADDRESS
+#define RECORD_SLOT_COUNT               ((RECORD_END_ADDRESS - RECORD_START_ADDRESS + RECORD_SIZE_BYTES - 1) / RECORD_SIZE_BYTES)
+
 #define NEXT_ADDRESS(address) (((uint16_t)(address) + RECORD_SIZE_BYTES >= RECORD_END_ADDRESS) ? (RECORD_START_ADDRESS) : ((address) + RECORD_SIZE_BYTES))
+#define PREVIOUS_ADDRESS(address) (((uint16_t)(address) <= RECORD_START_ADDRESS) ? (RECORD_START_ADDRESS + (RECORD_SLOT_COUNT - 1) * RECORD_SIZE_BYTES) : ((address) - RECORD_SIZE_BYTES))
+
+// I2C traffic issued by FramStorage, one transfer is one addressed read or write on the bus. Snapshot of the live
+// counters, which are atomic: the sampling and the BLE tasks both access the FRAM.
+struct FramTrafficStats {
+    uint32_t readTransfers;
+    uint32_t writeTransfers;
+    uint32_t bytesRead;
+    uint32_t bytesWritten;
+
+    FramTrafficStats() : readTransfers(0), writeTransfers(0), bytesRead(0), bytesWritten(0) {}
+};
+
 class FramStorage {
 public:
     FramStorage();
@@ -50,6 +79,12 @@ public:
      */
     [[nodiscard]] uint32_t getFramSize() const;
 
+    /**
+     * @brief Gets the I2C traffic issued since boot or since the last resetTrafficStats().
+     */
+    [[nodiscard]] FramTrafficStats getTrafficStats() const;
+    void resetTrafficStats();
+
     // --- Read Methods ---
     // If not initialized or address is out of bounds (and size is set),
     // these methods typically return 0, NAN, or an empty String.
@@ -73,13 +108,14 @@ public:
     uint16_t readBytes(uint16_t framAddress, uint8_t* buffer, uint16_t length);
 
     /**
-     * @brief Reads a null-terminated string from FRAM.
+     * @brief Reads a null-terminated string from FRAM into a caller provided buffer (no heap allocation).
      * @param framAddress Starting address in FRAM.
-     * @param maxLength Maximum number of characters to read (excluding null terminator).
-     *                  Reading stops at null terminator or after maxLength characters.
-     * @return The String read from FRAM. Empty if error or not found.
+     * @param buffer Destination, always null terminated when bufferSize > 0.
+     * @param bufferSize Size of buffer, at most bufferSize - 1 characters are read.
+     *                   Reading stops at null terminator or when the buffer is full.
+     * @return Length of the string read. 0 if error or not found.
      */
-    String readString(uint16_t framAddress, uint16_t maxLength);
+    uint16_t readString(uint16_t framAddress, char* buffer, uint16_t bufferSize);
 
     /**
      * @brief Reads a SensorReading structure from FRAM.
@@ -88,6 +124,12 @@ public:
      */
     SensorReading readSensorReading(uint16_t framAddress);
 
+    /**
+     * @brief Reads the whole record ring header (last timestamp, first and last record addresses) in one transfer.
+     * @return The header. All fields are 0 on error or if not initialized.
+     */
+    RecordRingHeader readRingHeader();
+
 
     // --- Write Methods ---
     // All write methods return true on success, false on failure (e.g., not initialized, address out of bounds).
@@ -138,6 +180,20 @@ private:
     Adafruit_FRAM_I2C _fram;    // Instance of the Adafruit FRAM HAL
     bool _initialized;
     uint32_t _framSizeBytes; // For optional bounds checking
+    std::atomic<uint32_t> _readTransfers;
+    std::atomic<uint32_t> _writeTransfers;
+    std::atomic<uint32_t> _bytesRead;
+    std::atomic<uint32_t> _bytesWritten;
+
+    // Statistics only: relaxed, a snapshot may pair the transfer count of one access with the bytes of the previous
+    void countRead(uint16_t bytes) {
+        _readTransfers.fetch_add(1, std::memory_order_relaxed);
+        _bytesRead.fetch_add(bytes, std::memory_order_relaxed);
+    }
+    void countWrite(uint16_t bytes) {
+        _writeTransfers.fetch_add(1, std::memory_order_relaxed);
+        _bytesWritten.fetch_add(bytes, std::memory_order_relaxed);
+    }
 
     /**
      * @brief Internal helper to check if an access is within configured bounds.
@@ -0,0 +1,128 @@
+#include "Instrumentation.h"
+
+Instrumentation instrumentation;
+
+Instrumentation::Instrumentation()
+    : _bootPhases(),
+      _bootPhaseCount(0),
+      _sampleCount(0),
+      _sampleBusyTotal(0),
+      _sampleBusyMax(0),
+      _steadyStateFreeHeap(0),
+      _steadyState(false),
+      _lateAllocations(0),
+      _lateAllocationBytes(0),
+      _lateAllocationCaller(0) {
+}
+
+void Instrumentation::markBootPhase(const char *name) {
+    if (_bootPhaseCount >= MAX_BOOT_PHASES) {
+        return;
+    }
+    _bootPhases[_bootPhaseCount++] = {name, (uint32_t) micros()};
+}
+
+void Instrumentation::reportBoot(Print &out) const {
+    uint32_t previous = 0;
+    for (uint8_t i = 0; i < _bootPhaseCount; ++i) {
+        out.print("Boot phase ");
+        out.print(_bootPhases[i].name);
+        out.print(": done at ");
+        out.print(_bootPhases[i].endMicros);
+        out.print(" us, took ");
+        out.print(_bootPhases[i].endMicros - previous);
+        out.println(" us");
+        previous = _bootPhases[i].endMicros;
+    }
+}
+
+void Instrumentation::addSampleBusyTime(uint32_t busyMicros) {
+    _sampleCount++;
+    _sampleBusyTotal += busyMicros;
+    if (busyMicros > _sampleBusyMax) {
+        _sampleBusyMax = busyMicros;
+    }
+}
+
+void Instrumentation::reportSampling(Print &out) {
+    out.print("Sampling: ");
+    out.print(_sampleCount);
+    out.print(" samples, busy mean ");
+    out.print(_sampleCount > 0 ? _sampleBusyTotal / _sampleCount : 0);
+    out.print(" us, max ");
+    out.print(_sampleBusyMax);
+    out.println(" us");
+
+    _sampleCount = 0;
+    _sampleBusyTotal = 0;
+    _sampleBusyMax = 0;
+}
+
+void Instrumentation::markSteadyState() {
+    _steadyStateFreeHeap = ESP.getFreeHeap();
+    _steadyState.store(true, std::memory_order_release);
+}
+
+void Instrumentation::recordAllocation(size_t bytes, const void *caller) {
+    if (!_steadyState.load(std::memory_order_relaxed)) {
+        return;
+    }
+    _lateAllocations.fetch_add(1, std::memory_order_relaxed);
+    _lateAllocationBytes.fetch_add(bytes, std::memory_order_relaxed);
+    _lateAllocationCaller.store((uintptr_t) caller, std::memory_order_relaxed);
+}
+
+uint32_t Instrumentation::getSteadyStateAllocations() const {
+    return _lateAllocations.load(std::memory_order_relaxed);
+}
+
+void Instrumentation::reportHeap(Print &out) const {
+    const uint32_t freeHeap = ESP.getFreeHeap();
+    out.print("Heap: ");
+    out.print(freeHeap);
+    out.print(" B free, ");
+    out.print(ESP.getMinFreeHeap());
+    out.print(" B low-water, ");
+    out.print(ESP.getMaxAllocHeap());
+    out.println(" B largest block");
+
+    if (_steadyStateFreeHeap > 0 && freeHeap < _steadyStateFreeHeap) {
+        out.print("WARNING: heap shrank by ");
+        out.print(_steadyStateFreeHeap - freeHeap);
+        out.println(" B since the end of setup");
+    }
+    const uint32_t lateAllocations = getSteadyStateAllocations();
+    if (lateAllocations > 0) {
+        out.print("WARNING: ");
+        out.print(lateAllocations);
+        out.print(" heap allocations (");
+        out.print(_lateAllocationBytes.load(std::memory_order_relaxed));
+        out.print(" B) since the end of setup, last from 0x");
+        out.println((unsigned long) _lateAllocationCaller.load(std::memory_order_relaxed), HEX);
+    }
+}
+
+#ifdef INSTRUMENTATION_HEAP_HOOK
+// Linker wrappers (-Wl,--wrap=malloc...): every reference to malloc in the firmware, the core and the prebuilt
+// libraries (operator new included) lands here first
+extern "C" {
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *pointer, size_t size);
+
+void *__wrap_malloc(size_t size) {
+    instrumentation.recordAllocation(size, __builtin_return_address(0));
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t count, size_t size) {
+    instrumentation.recordAllocation(count * size, __builtin_return_address(0));
+    return __real_calloc(count, size);
+}
+
+void *__wrap_realloc(void *pointer, size_t size) {
+    instrumentation.recordAllocation(size, __builtin_return_address(0));
+    return __real_realloc(pointer, size);
+}
+}
+#endif
@@ -0,0 +1,97 @@
+#ifndef INSTRUMENTATION_H
+#define INSTRUMENTATION_H
+
+#include <Arduino.h>
+#include <atomic>
+
+#define MAX_BOOT_PHASES 12
+
+/**
+ * Lightweight timing counters reported over Serial.
+ *
+ * Boot phases are timestamped with micros() when they complete, so the report shows both the time since reset
+ * and the duration of every phase. Phase names must be string literals (only the pointer is kept).
+ *
+ * Built with INSTRUMENTATION_HEAP_HOOK and the linker wrapping malloc, calloc and realloc (-Wl,--wrap=...), every
+ * allocation made after markSteadyState() is counted along with its caller. Allocations made with heap_caps_*()
+ * directly (some ESP-IDF drivers) are not seen.
+ */
+class Instrumentation {
+public:
+    Instrumentation();
+
+    /**
+     * @brief Records the completion of a boot phase. Ignored once MAX_BOOT_PHASES phases are recorded.
+     * @param name Name of the phase, must outlive the instrumentation (string literal).
+     */
+    void markBootPhase(const char* name);
+
+    /**
+     * @brief Prints every recorded boot phase.
+     * @param out Where to print, usually Serial.
+     */
+    void reportBoot(Print& out) const;
+
+    /**
+     * @brief Accounts the CPU time spent acquiring one sample (sensor I/O only, not the sampling period).
+     * @param busyMicros Time spent in the sensor driver for this sample.
+     */
+    void addSampleBusyTime(uint32_t busyMicros);
+
+    /**
+     * @brief Prints count, mean and max sample busy time since the last report, then starts a new window.
+     * @param out Where to print, usually Serial.
+     */
+    void reportSampling(Print& out);
+
+    /**
+     * @brief Snapshots the free heap once initialization is over. Nothing is expected to allocate afterwards.
+     */
+    void markSteadyState();
+
+    /**
+     * @brief Counts one heap allocation if it happens after markSteadyState(). Called by the malloc wrappers from
+     *        any task or interrupt before static constructors ran: must neither allocate nor lock.
+     * @param bytes Requested size.
+     * @param caller Return address of the allocating call.
+     */
+    void recordAllocation(size_t bytes, const void* caller);
+
+    /**
+     * @return Number of heap allocations seen after markSteadyState().
+     */
+    [[nodiscard]] uint32_t getSteadyStateAllocations() const;
+
+    /**
+     * @brief Prints the free heap, its low-water mark and the largest free block, and warns if the heap shrank
+     *        since markSteadyState() (an allocation that was never released after setup) or if anything
+     *        allocated since then.
+     * @param out Where to print, usually Serial.
+     */
+    void reportHeap(Print& out) const;
+
+private:
+    struct BootPhase {
+        const char* name;
+        uint32_t endMicros;
+    };
+
+    BootPhase _bootPhases[MAX_BOOT_PHASES];
+    uint8_t _bootPhaseCount;
+
+    uint32_t _sampleCount;
+    uint32_t _sampleBusyTotal;
+    uint32_t _sampleBusyMax;
+
+    uint32_t _steadyStateFreeHeap;
+
+    // Zero initialized before any constructor runs, the allocation hook may be called that early
+    std::atomic<bool> _steadyState;
+    std::atomic<uint32_t> _lateAllocations;
+    std::atomic<uint32_t> _lateAllocationBytes;
+    std::atomic<uintptr_t> _lateAllocationCaller;
+};
+
+extern Instrumentation instrumentation;
+
+#endif //INSTRUMENTATION_H
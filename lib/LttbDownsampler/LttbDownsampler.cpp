@@ -0,0 +1,199 @@
+#include "LttbDownsampler.h"
+
+LttbDownsampler::LttbDownsampler()
+    : _store(nullptr),
+      _from(0),
+      _oldestOffset(0),
+      _count(0),
+      _points(0),
+      _produced(0),
+      _series(LTTB_SERIES_TEMPERATURE),
+      _origin(0),
+      _previousTimestamp(0),
+      _previousY(0) {
+}
+
+bool LttbDownsampler::begin(RecordStore *store, uint32_t from, uint32_t to, uint16_t points, LttbSeries series) {
+    cancel();
+    if (from > to || points == 0) {
+        return false;
+    }
+
+    // Newest record of the range, then the oldest one
+    const uint32_t newest = store->findOffset(to);
+    if (newest == RECORD_NOT_FOUND) {
+        return false;
+    }
+    _store = store;
+    _from = from;
+    uint32_t oldest;
+    SensorReading anchor;
+    if (!resolveOldest(oldest) || oldest < newest || !store->readRecord(oldest, anchor)) {
+        _store = nullptr;
+        return false;
+    }
+
+    _oldestOffset = oldest;
+    _origin = anchor.timestamp;
+    _count = oldest - newest + 1;
+    _points = _count <= points ? _count : points;
+    _series = series;
+    return true;
+}
+
+bool LttbDownsampler::next(SensorReading &reading, uint32_t &offset) {
+    if (!isActive()) {
+        return false;
+    }
+
+    for (uint8_t attempt = 0; attempt < LTTB_ANCHOR_ATTEMPTS; ++attempt) {
+        if (!anchor()) {
+            break;
+        }
+        const uint32_t anchored = _oldestOffset;
+        uint32_t index;
+        const bool read = selectNext(index) && readAt(index, reading, offset);
+
+        // The sampling task may have appended between two store reads: every append moves the anchor, and a moved
+        // anchor means the point was computed on a mix of two views of the store
+        if (!anchor()) {
+            break;
+        }
+        if (_oldestOffset != anchored) {
+            continue;
+        }
+        if (!read) {
+            break;
+        }
+        _previousTimestamp = reading.timestamp;
+        _previousY = _series == LTTB_SERIES_HUMIDITY ? reading.humidity : reading.temperature;
+        _produced++;
+        return true;
+    }
+    cancel();
+    return false;
+}
+
+bool LttbDownsampler::isActive() const {
+    return _store != nullptr && _produced < _points;
+}
+
+void LttbDownsampler::cancel() {
+    _store = nullptr;
+    _count = 0;
+    _points = 0;
+    _produced = 0;
+}
+
+bool LttbDownsampler::anchor() {
+    SensorReading oldest;
+    if (_store->readRecord(_oldestOffset, oldest) && oldest.timestamp == _origin) {
+        return true;
+    }
+    // Shifted by appends, or dropped from the store
+    uint32_t offset;
+    if (!resolveOldest(offset) || !_store->readRecord(offset, oldest) || oldest.timestamp != _origin) {
+        return false;
+    }
+    _oldestOffset = offset;
+    return true;
+}
+
+bool LttbDownsampler::resolveOldest(uint32_t &oldest) const {
+    // The record right after the newest record older than _from, or the oldest record of the store
+    const uint32_t available = _store->count();
+    const uint32_t beforeRange = _from > 0 ? _store->findOffset(_from - 1) : RECORD_NOT_FOUND;
+    if (available == 0 || beforeRange == 0) {
+        return false;
+    }
+    oldest = beforeRange == RECORD_NOT_FOUND ? available - 1 : beforeRange - 1;
+    return true;
+}
+
+bool LttbDownsampler::selectNext(uint32_t &index) {
+    if (_produced == 0 || _count <= _points) {
+        index = _produced; // First record, or a range small enough to be returned as is
+        return true;
+    }
+    if (_produced == _points - 1) {
+        index = _count - 1;
+        return true;
+    }
+    // Bucket of this point, against the average of the next bucket (the last record for the last bucket)
+    const uint32_t bucket = _produced - 1;
+    const uint32_t nextEnd = bucketStart(bucket + 2) < _count ? bucketStart(bucket + 2) : _count;
+    float nextX, nextY;
+    return average(bucketStart(bucket + 1), nextEnd, nextX, nextY)
+           && select(bucketStart(bucket), bucketStart(bucket + 1), nextX, nextY, index);
+}
+
+bool LttbDownsampler::readAt(uint32_t index, SensorReading &reading, uint32_t &offset) {
+    offset = _oldestOffset - index;
+    return _store->readRecord(offset, reading);
+}
+
+bool LttbDownsampler::average(uint32_t first, uint32_t end, float &x, float &y) {
+    // Sums of thousands of records on a flash log: a float would drop whole seconds
+    double sumX = 0;
+    double sumY = 0;
+    uint32_t valid = 0;
+    const bool read = forEachRecord(first, end, [&](uint32_t, const uint8_t *record) {
+        const float value = valueOf(record);
+        if (!isnan(value)) {
+            sumX += xOf(record);
+            sumY += value;
+            valid++;
+        }
+    });
+    // Without a valid value every area is NAN and select() keeps the first record of the bucket
+    x = valid > 0 ? (float) (sumX / valid) : NAN;
+    y = valid > 0 ? (float) (sumY / valid) : NAN;
+    return read;
+}
+
+bool LttbDownsampler::select(uint32_t first, uint32_t end, float nextX, float nextY, uint32_t &selected) {
+    float largestArea = -1;
+    selected = first;
+    return forEachRecord(first, end, [&](uint32_t index, const uint8_t *record) {
+        // Twice the area of the triangle (previous point, candidate, next bucket average), the previous point is x = 0
+        const float area = fabsf(nextX * (valueOf(record) - _previousY) - xOf(record) * (nextY - _previousY));
+        if (area > largestArea) {
+            largestArea = area;
+            selected = index;
+        }
+    });
+}
+
+uint32_t LttbDownsampler::bucketStart(uint32_t bucket) const {
+    // Records between the first and the last one are split into _points - 2 buckets, exactly
+    return 1 + (uint32_t) ((uint64_t) bucket * (_count - 2) / (_points - 2));
+}
+
+float LttbDownsampler::valueOf(const uint8_t *record) const {
+    return _series == LTTB_SERIES_HUMIDITY
+               ? StoredRecordSchema::get<STORED_HUMIDITY>(record)
+               : StoredRecordSchema::get<STORED_TEMPERATURE>(record);
+}
+
+float LttbDownsampler::xOf(const uint8_t *record) const {
+    return (float) (int32_t) (StoredRecordSchema::get<STORED_TIMESTAMP>(record) - _previousTimestamp);
+}
+
+template<typename Visitor>
+bool LttbDownsampler::forEachRecord(uint32_t first, uint32_t end, Visitor visitor) {
+    uint8_t chunk[LTTB_CHUNK_RECORDS * RECORD_SIZE_BYTES];
+    uint32_t index = first;
+    while (index < end) {
+        // The store reads newest first: read the chunk ending at the newest wanted record and walk it backwards
+        const uint16_t wanted = end - index < LTTB_CHUNK_RECORDS ? end - index : LTTB_CHUNK_RECORDS;
+        const uint32_t newestIndex = index + wanted - 1;
+        if (_store->readRecords(_oldestOffset - newestIndex, chunk, wanted) != wanted) {
+            return false;
+        }
+        for (uint16_t i = 0; i < wanted; ++i) {
+            visitor(index + i, chunk + (wanted - 1 - i) * RECORD_SIZE_BYTES);
+        }
+        index += wanted;
+    }
+    return true;
+}
@@ -0,0 +1,83 @@
+#ifndef LTTBDOWNSAMPLER_H
+#define LTTBDOWNSAMPLER_H
+
+#include <Arduino.h>
+#include <RecordStore.h>
+#include <SensorReading.h>
+
+// Records read from the store at once while scanning a bucket
+#define LTTB_CHUNK_RECORDS 16
+// Times a point is computed again when records are appended meanwhile
+#define LTTB_ANCHOR_ATTEMPTS 3
+
+enum LttbSeries : uint8_t {
+    LTTB_SERIES_TEMPERATURE = 0,
+    LTTB_SERIES_HUMIDITY = 1,
+};
+
+/**
+ * Largest-Triangle-Three-Buckets downsampling of a time range of a RecordStore.
+ *
+ * Points are produced one at a time, oldest first, straight from the store: selecting a point scans its bucket and
+ * the next one, so memory stays constant whatever the range and the caller can stop or resume at any point. The
+ * first and last records of the range are always part of the output. Ranges with no more records than requested
+ * points are returned as is.
+ *
+ * Store offsets count from the newest record and shift with every append, so the range is anchored on the timestamp
+ * of its oldest record and its offset is checked again for every point. The series ends early if that record is
+ * dropped from the store before the last point.
+ */
+class LttbDownsampler {
+public:
+    LttbDownsampler();
+
+    /**
+     * @brief Starts downsampling the records whose timestamp is within [from, to].
+     * @param store Store to read from, must stay valid until the last point is produced.
+     * @param points Maximum number of points to produce.
+     * @param series Quantity whose shape is preserved, the other one is returned at the same timestamps.
+     * @return False if the range holds no record, nothing is produced then.
+     */
+    bool begin(RecordStore* store, uint32_t from, uint32_t to, uint16_t points, LttbSeries series);
+
+    /**
+     * @brief Produces the next selected record.
+     * @param reading The record.
+     * @param offset Its offset in the store.
+     * @return False once every point has been produced (or on a store error).
+     */
+    bool next(SensorReading& reading, uint32_t& offset);
+
+    [[nodiscard]] bool isActive() const;
+    void cancel();
+
+private:
+    RecordStore* _store;
+    uint32_t _from;
+    uint32_t _oldestOffset; // Offset of the anchor when last checked
+    uint32_t _count;    // Records in the range
+    uint16_t _points;   // Points produced in total
+    uint16_t _produced;
+    LttbSeries _series;
+    uint32_t _origin;   // Timestamp of the first record (the anchor)
+    uint32_t _previousTimestamp; // Last selected point, x coordinates are relative to it
+    float _previousY;
+
+    bool anchor();
+    bool resolveOldest(uint32_t& oldest) const;
+    bool selectNext(uint32_t& index);
+    bool readAt(uint32_t index, SensorReading& reading, uint32_t& offset);
+    bool average(uint32_t first, uint32_t end, float& x, float& y);
+    bool select(uint32_t first, uint32_t end, float nextX, float nextY, uint32_t& selected);
+    [[nodiscard]] uint32_t bucketStart(uint32_t bucket) const;
+    [[nodiscard]] float valueOf(const uint8_t* record) const;
+    [[nodiscard]] float xOf(const uint8_t* record) const;
+
+    /**
+     * @brief Visits the records of [first, end) (chronological indexes) oldest first, a chunk at a time.
+     */
+    template<typename Visitor>
+    bool forEachRecord(uint32_t first, uint32_t end, Visitor visitor);
+};
+
+#endif //LTTBDOWNSAMPLER_H
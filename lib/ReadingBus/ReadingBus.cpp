@@ -0,0 +1,101 @@
+#include "ReadingBus.h"
+
+static uint32_t floatBits(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static float bitsFloat(uint32_t bits) {
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+ReadingBus::ReadingBus() : _published(0) {
+    for (auto &slot: _slots) {
+        slot.version.store(0, std::memory_order_relaxed);
+        slot.index.store(0, std::memory_order_relaxed);
+        slot.temperature.store(0, std::memory_order_relaxed);
+        slot.humidity.store(0, std::memory_order_relaxed);
+        slot.timestamp.store(0, std::memory_order_relaxed);
+    }
+}
+
+void ReadingBus::publish(const SensorReading &reading) {
+    // Single producer: nobody else writes _published or the versions
+    const uint32_t index = _published.load(std::memory_order_relaxed) + 1;
+    Slot &slot = _slots[index % READING_BUS_CAPACITY];
+
+    const uint32_t version = slot.version.load(std::memory_order_relaxed);
+    slot.version.store(version + 1, std::memory_order_relaxed); // Odd: write in progress
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot.index.store(index, std::memory_order_relaxed);
+    slot.temperature.store(floatBits(reading.temperature), std::memory_order_relaxed);
+    slot.humidity.store(floatBits(reading.humidity), std::memory_order_relaxed);
+    slot.timestamp.store(reading.timestamp, std::memory_order_relaxed);
+
+    slot.version.store(version + 2, std::memory_order_release);
+    _published.store(index, std::memory_order_release);
+}
+
+bool ReadingBus::latest(SensorReading &reading) const {
+    while (true) {
+        const uint32_t index = _published.load(std::memory_order_acquire);
+        if (index == 0) {
+            return false;
+        }
+        if (readSlot(index, reading)) {
+            return true;
+        }
+        // The slot was reused by newer readings in the meantime, start over from the new head
+    }
+}
+
+bool ReadingBus::poll(Cursor &cursor, SensorReading &reading) const {
+    while (true) {
+        const uint32_t published = _published.load(std::memory_order_acquire);
+        if (cursor._next > published) {
+            return false;
+        }
+        if (published - cursor._next >= READING_BUS_CAPACITY) {
+            const uint32_t oldest = published - READING_BUS_CAPACITY + 1;
+            cursor._missed += oldest - cursor._next;
+            cursor._next = oldest;
+        }
+        const bool read = readSlot(cursor._next, reading);
+        cursor._next++;
+        if (read) {
+            return true;
+        }
+        cursor._missed++; // Overwritten while we were reading it
+    }
+}
+
+uint32_t ReadingBus::getPublishedCount() const {
+    return _published.load(std::memory_order_acquire);
+}
+
+bool ReadingBus::readSlot(uint32_t index, SensorReading &reading) const {
+    // Never spins on the producer: on a single core a reader preempting it would wait forever. A published slot is
+    // only rewritten READING_BUS_CAPACITY readings later, so an odd or changed version means the reading is gone.
+    const Slot &slot = _slots[index % READING_BUS_CAPACITY];
+    const uint32_t before = slot.version.load(std::memory_order_acquire);
+    if (before & 1) {
+        return false;
+    }
+
+    const uint32_t slotIndex = slot.index.load(std::memory_order_relaxed);
+    const uint32_t temperature = slot.temperature.load(std::memory_order_relaxed);
+    const uint32_t humidity = slot.humidity.load(std::memory_order_relaxed);
+    const uint32_t timestamp = slot.timestamp.load(std::memory_order_relaxed);
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.version.load(std::memory_order_relaxed) != before || slotIndex != index) {
+        return false;
+    }
+
+    reading = SensorReading(bitsFloat(temperature), bitsFloat(humidity), timestamp);
+    return true;
+}
@@ -0,0 +1,78 @@
+#ifndef READINGBUS_H
+#define READINGBUS_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <SensorReading.h>
+
+// Number of readings kept for subscribers that poll less often than the sampling rate
+#define READING_BUS_CAPACITY 8
+
+/**
+ * Lock-free single-producer / multi-consumer channel of timestamped readings.
+ *
+ * The sampling task publishes, any other task (BLE callbacks, display, alerting...) reads without taking a lock.
+ * Every slot is a seqlock: the producer makes its version odd while writing, a reader discards its copy when it saw
+ * an odd version or when the version changed during the copy. A reader therefore never gets a temperature from one
+ * sample paired with the humidity of another, and never waits on the producer.
+ */
+class ReadingBus {
+public:
+    // Position of one subscriber in the stream of published readings
+    class Cursor {
+    public:
+        Cursor() : _next(1), _missed(0) {}
+
+        /**
+         * @return Number of readings overwritten before this subscriber could read them.
+         */
+        [[nodiscard]] uint32_t getMissed() const { return _missed; }
+
+    private:
+        friend class ReadingBus;
+        uint32_t _next;
+        uint32_t _missed;
+    };
+
+    ReadingBus();
+
+    /**
+     * @brief Publishes a reading. Must only be called from the single producer task.
+     */
+    void publish(const SensorReading& reading);
+
+    /**
+     * @brief Copies the most recent reading.
+     * @return False if nothing was published yet.
+     */
+    bool latest(SensorReading& reading) const;
+
+    /**
+     * @brief Copies the next reading this subscriber has not seen. A subscriber that fell more than
+     *        READING_BUS_CAPACITY readings behind skips to the oldest one still available.
+     * @return False if there is no new reading.
+     */
+    bool poll(Cursor& cursor, SensorReading& reading) const;
+
+    /**
+     * @return Number of readings published since boot.
+     */
+    [[nodiscard]] uint32_t getPublishedCount() const;
+
+private:
+    // Fields are stored as atomic words so that concurrent access is well defined, floats as their bit pattern
+    struct Slot {
+        std::atomic<uint32_t> version;
+        std::atomic<uint32_t> index;
+        std::atomic<uint32_t> temperature;
+        std::atomic<uint32_t> humidity;
+        std::atomic<uint32_t> timestamp;
+    };
+
+    Slot _slots[READING_BUS_CAPACITY];
+    std::atomic<uint32_t> _published;
+
+    bool readSlot(uint32_t index, SensorReading& reading) const;
+};
+
+#endif //READINGBUS_H
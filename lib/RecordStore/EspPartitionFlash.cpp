@@ -0,0 +1,38 @@
+#include "EspPartitionFlash.h"
+
+EspPartitionFlash::EspPartitionFlash(const char *label) : _label(label), _partition(nullptr) {
+}
+
+bool EspPartitionFlash::begin() {
+    _partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, _label);
+    if (_partition == nullptr) {
+        Serial.print("EspPartitionFlash: no data partition labelled ");
+        Serial.println(_label);
+        return false;
+    }
+    return true;
+}
+
+uint32_t EspPartitionFlash::size() const {
+    if (_partition == nullptr) {
+        return 0;
+    }
+    return _partition->size - _partition->size % ESP_FLASH_SECTOR_SIZE;
+}
+
+uint32_t EspPartitionFlash::eraseBlockSize() const {
+    return ESP_FLASH_SECTOR_SIZE;
+}
+
+bool EspPartitionFlash::read(uint32_t address, uint8_t *buffer, uint32_t length) {
+    return _partition != nullptr && esp_partition_read(_partition, address, buffer, length) == ESP_OK;
+}
+
+bool EspPartitionFlash::program(uint32_t address, const uint8_t *buffer, uint32_t length) {
+    return _partition != nullptr && esp_partition_write(_partition, address, buffer, length) == ESP_OK;
+}
+
+bool EspPartitionFlash::erase(uint32_t address) {
+    return _partition != nullptr
+           && esp_partition_erase_range(_partition, address, ESP_FLASH_SECTOR_SIZE) == ESP_OK;
+}
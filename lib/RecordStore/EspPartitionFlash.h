@@ -0,0 +1,32 @@
+#ifndef ESPPARTITIONFLASH_H
+#define ESPPARTITIONFLASH_H
+
+#include <esp_partition.h>
+#include "FlashDevice.h"
+
+#define ESP_FLASH_SECTOR_SIZE 4096
+
+/**
+ * FlashDevice over a data partition of the ESP32 flash (or of an external SPI flash registered as a partition).
+ * The partition must be declared in the partition table, e.g. "records, data, 0x40, , 1M".
+ */
+class EspPartitionFlash final : public FlashDevice {
+public:
+    /**
+     * @param label Label of the data partition. Must outlive the device (string literal).
+     */
+    explicit EspPartitionFlash(const char* label);
+
+    bool begin() override;
+    [[nodiscard]] uint32_t size() const override;
+    [[nodiscard]] uint32_t eraseBlockSize() const override;
+    bool read(uint32_t address, uint8_t* buffer, uint32_t length) override;
+    bool program(uint32_t address, const uint8_t* buffer, uint32_t length) override;
+    bool erase(uint32_t address) override;
+
+private:
+    const char* _label;
+    const esp_partition_t* _partition;
+};
+
+#endif //ESPPARTITIONFLASH_H
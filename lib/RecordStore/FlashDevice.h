@@ -0,0 +1,38 @@
+#ifndef FLASHDEVICE_H
+#define FLASHDEVICE_H
+
+#include <Arduino.h>
+
+/**
+ * Minimal NOR flash abstraction used by FlashRecordStore: bytes can only be programmed from 1 to 0,
+ * and go back to 0xFF by erasing a whole block.
+ */
+class FlashDevice {
+public:
+    virtual ~FlashDevice() = default;
+
+    /**
+     * @brief Prepares the device. Called by FlashRecordStore::begin().
+     */
+    virtual bool begin() { return true; }
+
+    /**
+     * @return Usable size in bytes, a multiple of eraseBlockSize().
+     */
+    [[nodiscard]] virtual uint32_t size() const = 0;
+
+    /**
+     * @return Size of the smallest erasable unit in bytes.
+     */
+    [[nodiscard]] virtual uint32_t eraseBlockSize() const = 0;
+
+    virtual bool read(uint32_t address, uint8_t* buffer, uint32_t length) = 0;
+    virtual bool program(uint32_t address, const uint8_t* buffer, uint32_t length) = 0;
+
+    /**
+     * @brief Erases the block starting at address (aligned on eraseBlockSize()).
+     */
+    virtual bool erase(uint32_t address) = 0;
+};
+
+#endif //FLASHDEVICE_H
@@ -0,0 +1,313 @@
+#include "FlashRecordStore.h"
+#include <new>
+
+FlashRecordStore::FlashRecordStore(FlashDevice *flash, uint8_t flushThreshold)
+    : _flash(flash),
+      _flushThreshold(flushThreshold),
+      _blockSize(0),
+      _blockCount(0),
+      _recordsPerBlock(0),
+      _headBlock(0),
+      _usedBlocks(0),
+      _headSequence(0),
+      _headRecords(0),
+      _flushedRecords(0),
+      _pageBuffer(),
+      _firstTimestamps(nullptr) {
+    if (_flushThreshold < 1) _flushThreshold = 1;
+    if (_flushThreshold > FLASH_PAGE_BUFFER_RECORDS) _flushThreshold = FLASH_PAGE_BUFFER_RECORDS;
+}
+
+FlashRecordStore::~FlashRecordStore() {
+    delete[] _firstTimestamps;
+}
+
+bool FlashRecordStore::begin() {
+    std::lock_guard<std::recursive_mutex> guard(_lock);
+    if (!_flash->begin()) {
+        return false;
+    }
+    _blockSize = _flash->eraseBlockSize();
+    const uint32_t blocks = _flash->size() / _blockSize;
+    if (blocks > FLASH_MAX_BLOCKS) {
+        Serial.print("FlashRecordStore: device truncated to ");
+        Serial.print(FLASH_MAX_BLOCKS);
+        Serial.print(" of its ");
+        Serial.print(blocks);
+        Serial.println(" blocks.");
+    }
+    _blockCount = blocks > FLASH_MAX_BLOCKS ? FLASH_MAX_BLOCKS : blocks;
+    _recordsPerBlock = (_blockSize - FLASH_BLOCK_HEADER_SIZE) / RECORD_SIZE_BYTES;
+    if (_blockCount < 2 || _recordsPerBlock == 0) {
+        return false;
+    }
+
+    // Sized once for the device, at boot
+    delete[] _firstTimestamps;
+    _firstTimestamps = new(std::nothrow) uint32_t[_blockCount]();
+    if (_firstTimestamps == nullptr) {
+        Serial.println("FlashRecordStore: not enough RAM for the block index.");
+        return false;
+    }
+
+    // The head of the log is the valid block with the highest sequence
+    bool found = false;
+    for (uint16_t block = 0; block < _blockCount; ++block) {
+        uint32_t sequence, eraseCount;
+        if (readHeader(block, sequence, eraseCount) && (!found || sequence > _headSequence)) {
+            _headBlock = block;
+            _headSequence = sequence;
+            found = true;
+        }
+    }
+    if (!found) {
+        Serial.println("FlashRecordStore: no log found, formatting.");
+        _usedBlocks = 0;
+        _headSequence = 0;
+        _headBlock = _blockCount - 1; // So that the first block opened is block 0
+        return openNextBlock();
+    }
+
+    // Older blocks precede the head with consecutive sequences
+    _usedBlocks = 1;
+    while (_usedBlocks < _blockCount) {
+        const uint16_t block = (_headBlock + _blockCount - _usedBlocks) % _blockCount;
+        uint32_t sequence, eraseCount;
+        if (!readHeader(block, sequence, eraseCount) || sequence != _headSequence - _usedBlocks) {
+            break;
+        }
+        _usedBlocks++;
+    }
+
+    // Slots are programmed in order: binary search for the first empty one of the head block
+    uint16_t low = 0;
+    uint16_t high = _recordsPerBlock;
+    while (low < high) {
+        const uint16_t middle = (low + high) / 2;
+        if (isSlotEmpty(_headBlock, middle)) {
+            high = middle;
+        } else {
+            low = middle + 1;
+        }
+    }
+    _headRecords = low;
+    _flushedRecords = low;
+
+    // Sparse index
+    for (uint16_t position = 0; position < _usedBlocks; ++position) {
+        const uint16_t block = (tailBlock() + position) % _blockCount;
+        uint8_t timestamp[sizeof(uint32_t)];
+        const uint32_t address = blockAddress(block) + FLASH_BLOCK_HEADER_SIZE
+                                 + StoredRecordSchema::offset<STORED_TIMESTAMP>();
+        if (recordsIn(block) > 0 && _flash->read(address, timestamp, sizeof(timestamp))) {
+            _firstTimestamps[block] = wire::loadLittleEndian<uint32_t>(timestamp);
+        }
+    }
+
+    Serial.print("FlashRecordStore: ");
+    Serial.print(count());
+    Serial.print(" records in ");
+    Serial.print(_usedBlocks);
+    Serial.print("/");
+    Serial.print(_blockCount);
+    Serial.println(" blocks.");
+    return true;
+}
+
+bool FlashRecordStore::append(const SensorReading &reading) {
+    std::lock_guard<std::recursive_mutex> guard(_lock);
+    // A failed flush leaves its records in the buffer, never overrun it
+    if (_headRecords - _flushedRecords >= FLASH_PAGE_BUFFER_RECORDS && !flush()) {
+        return false;
+    }
+    if (_headRecords == _recordsPerBlock && !openNextBlock()) {
+        return false;
+    }
+
+    uint8_t *record = _pageBuffer + (_headRecords - _flushedRecords) * RECORD_SIZE_BYTES;
+    StoredRecordSchema::encode(record, reading.temperature, reading.humidity, reading.timestamp);
+    if (_headRecords == 0) {
+        _firstTimestamps[_headBlock] = reading.timestamp;
+    }
+    _headRecords++;
+
+    if (_headRecords - _flushedRecords >= _flushThreshold) {
+        return flush();
+    }
+    return true;
+}
+
+uint32_t FlashRecordStore::count() const {
+    std::lock_guard<std::recursive_mutex> guard(_lock);
+    if (_usedBlocks == 0) {
+        return 0;
+    }
+    return (uint32_t) (_usedBlocks - 1) * _recordsPerBlock + _headRecords;
+}
+
+uint16_t FlashRecordStore::readRecords(uint32_t offset, uint8_t *buffer, uint16_t maxRecords) {
+    std::lock_guard<std::recursive_mutex> guard(_lock);
+    const uint32_t available = count();
+    if (offset >= available) {
+        return 0;
+    }
+    uint16_t remaining = available - offset < maxRecords ? available - offset : maxRecords;
+
+    uint16_t read = 0;
+    while (remaining > 0) {
+        uint16_t block, slot;
+        locate(offset + read, block, slot);
+        uint8_t *out = buffer + read * RECORD_SIZE_BYTES;
+
+        if (block == _headBlock && slot >= _flushedRecords) {
+            // Not programmed yet, still in the page buffer
+            memcpy(out, _pageBuffer + (slot - _flushedRecords) * RECORD_SIZE_BYTES, RECORD_SIZE_BYTES);
+            read++;
+            remaining--;
+            continue;
+        }
+
+        // Slots [slot - run + 1, slot] of this block in one read, then newest first
+        const uint16_t run = remaining < slot + 1 ? remaining : slot + 1;
+        const uint32_t address = blockAddress(block) + FLASH_BLOCK_HEADER_SIZE
+                                 + (uint32_t) (slot - run + 1) * RECORD_SIZE_BYTES;
+        if (!_flash->read(address, out, (uint32_t) run * RECORD_SIZE_BYTES)) {
+            break;
+        }
+        reverseRecords(out, run);
+        read += run;
+        remaining -= run;
+    }
+    return read;
+}
+
+uint32_t FlashRecordStore::findOffset(uint32_t timestamp) {
+    std::lock_guard<std::recursive_mutex> guard(_lock);
+    if (count() == 0) {
+        return RECORD_NOT_FOUND;
+    }
+
+    // First timestamps grow from the tail block to the head block: find the newest block starting at or before
+    // timestamp, the answer is inside it
+    const uint16_t tail = tailBlock();
+    if (_firstTimestamps[tail] > timestamp) {
+        return RECORD_NOT_FOUND;
+    }
+    uint16_t low = 0;
+    uint16_t high = _headRecords > 0 ? _usedBlocks - 1 : _usedBlocks - 2;
+    while (low < high) {
+        const uint16_t middle = (low + high + 1) / 2;
+        if (_firstTimestamps[(tail + middle) % _blockCount] <= timestamp) {
+            low = middle;
+        } else {
+            high = middle - 1;
+        }
+    }
+
+    const uint16_t block = (tail + low) % _blockCount;
+    return findOffsetBetween(timestamp, offsetOf(block, recordsIn(block) - 1), offsetOf(block, 0));
+}
+
+bool FlashRecordStore::flush() {
+    std::lock_guard<std::recursive_mutex> guard(_lock);
+    const uint16_t pending = _headRecords - _flushedRecords;
+    if (pending == 0) {
+        return true;
+    }
+    const uint32_t address = blockAddress(_headBlock) + FLASH_BLOCK_HEADER_SIZE
+                             + (uint32_t) _flushedRecords * RECORD_SIZE_BYTES;
+    if (!_flash->program(address, _pageBuffer, (uint32_t) pending * RECORD_SIZE_BYTES)) {
+        return false;
+    }
+    _flushedRecords = _headRecords;
+    return true;
+}
+
+uint32_t FlashRecordStore::blockAddress(uint16_t block) const {
+    return (uint32_t) block * _blockSize;
+}
+
+uint16_t FlashRecordStore::tailBlock() const {
+    return (_headBlock + _blockCount - (_usedBlocks - 1)) % _blockCount;
+}
+
+uint16_t FlashRecordStore::recordsIn(uint16_t block) const {
+    return block == _headBlock ? _headRecords : _recordsPerBlock;
+}
+
+bool FlashRecordStore::readHeader(uint16_t block, uint32_t &sequence, uint32_t &eraseCount) {
+    uint8_t header[FLASH_BLOCK_HEADER_SIZE];
+    if (!_flash->read(blockAddress(block), header, sizeof(header))
+        || FlashBlockHeaderSchema::get<BLOCK_MAGIC>(header) != FLASH_BLOCK_MAGIC) {
+        return false;
+    }
+    sequence = FlashBlockHeaderSchema::get<BLOCK_SEQUENCE>(header);
+    eraseCount = FlashBlockHeaderSchema::get<BLOCK_ERASE_COUNT>(header);
+    return true;
+}
+
+bool FlashRecordStore::openBlock(uint16_t block, uint32_t sequence) {
+    uint32_t previousSequence;
+    uint32_t eraseCount = 0;
+    readHeader(block, previousSequence, eraseCount); // Keeps counting erases across passes
+
+    if (!_flash->erase(blockAddress(block))) {
+        return false;
+    }
+    uint8_t header[FLASH_BLOCK_HEADER_SIZE];
+    FlashBlockHeaderSchema::encode(header, FLASH_BLOCK_MAGIC, sequence, eraseCount + 1, 0xFFFFFFFF);
+    return _flash->program(blockAddress(block), header, sizeof(header));
+}
+
+bool FlashRecordStore::openNextBlock() {
+    if (!flush()) {
+        return false;
+    }
+    const uint16_t next = (_headBlock + 1) % _blockCount;
+    if (_usedBlocks == _blockCount) {
+        _usedBlocks--; // Next block is the oldest one, its records are dropped
+    }
+    if (!openBlock(next, _headSequence + 1)) {
+        return false;
+    }
+    _headBlock = next;
+    _headSequence++;
+    _usedBlocks++;
+    _headRecords = 0;
+    _flushedRecords = 0;
+    return true;
+}
+
+bool FlashRecordStore::isSlotEmpty(uint16_t block, uint16_t slot) {
+    uint8_t record[RECORD_SIZE_BYTES];
+    const uint32_t address = blockAddress(block) + FLASH_BLOCK_HEADER_SIZE + (uint32_t) slot * RECORD_SIZE_BYTES;
+    if (!_flash->read(address, record, sizeof(record))) {
+        return true;
+    }
+    for (const uint8_t byte: record) {
+        if (byte != 0xFF) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void FlashRecordStore::locate(uint32_t offset, uint16_t &block, uint16_t &slot) const {
+    if (offset < _headRecords) {
+        block = _headBlock;
+        slot = _headRecords - 1 - offset;
+        return;
+    }
+    const uint32_t older = offset - _headRecords;
+    const uint16_t blocksBack = 1 + older / _recordsPerBlock;
+    block = (_headBlock + _blockCount - blocksBack) % _blockCount;
+    slot = _recordsPerBlock - 1 - older % _recordsPerBlock;
+}
+
+uint32_t FlashRecordStore::offsetOf(uint16_t block, uint16_t slot) const {
+    if (block == _headBlock) {
+        return _headRecords - 1 - slot;
+    }
+    const uint16_t blocksBack = (_headBlock + _blockCount - block) % _blockCount;
+    return _headRecords + (uint32_t) (blocksBack - 1) * _recordsPerBlock + (_recordsPerBlock - 1 - slot);
+}
@@ -0,0 +1,77 @@
+#ifndef FLASHRECORDSTORE_H
+#define FLASHRECORDSTORE_H
+
+#include <WireSchema.h>
+#include "FlashDevice.h"
+#include "RecordStore.h"
+
+#define FLASH_BLOCK_MAGIC         0x31534847 // "GHS1"
+#define FLASH_BLOCK_HEADER_SIZE   16
+#define FLASH_MAX_BLOCKS          0xFFFF // Block numbers are 16 bit: 256 MB of 4 KB blocks
+#define FLASH_PAGE_BUFFER_RECORDS 21  // Records fitting in one 256 byte flash page
+
+// Header programmed at the start of every erase block when it is opened
+using FlashBlockHeaderSchema = wire::Schema<uint32_t, uint32_t, uint32_t, uint32_t>;
+enum FlashBlockHeaderField : size_t { BLOCK_MAGIC, BLOCK_SEQUENCE, BLOCK_ERASE_COUNT, BLOCK_RESERVED };
+static_assert(FlashBlockHeaderSchema::size == FLASH_BLOCK_HEADER_SIZE, "Flash block header schema does not match its size");
+
+/**
+ * Log-structured RecordStore for NOR flash.
+ *
+ * Erase blocks are filled one after the other and reused in rotation, so every block is erased exactly once per
+ * pass over the device (wear leveling comes for free with the log). Each block starts with a header holding a
+ * monotonic sequence number and its erase count; begin() rebuilds the log from the headers alone plus a binary
+ * search for the end of the newest block. A sparse RAM index keeps the first timestamp of every block so that time
+ * lookups only touch one block; it is allocated by begin() for the whole device (4 bytes per block). Appends are
+ * collected in a page buffer and programmed together.
+ */
+class FlashRecordStore final : public RecordStore {
+public:
+    /**
+     * @param flash Device holding the log.
+     * @param flushThreshold Appended records kept in the page buffer before being programmed, from 1 (write-through)
+     *                       to FLASH_PAGE_BUFFER_RECORDS. Buffered records are lost on power failure.
+     */
+    explicit FlashRecordStore(FlashDevice* flash, uint8_t flushThreshold = 1);
+    ~FlashRecordStore() override;
+
+    FlashRecordStore(const FlashRecordStore&) = delete;
+    FlashRecordStore& operator=(const FlashRecordStore&) = delete;
+
+    bool begin() override;
+    bool append(const SensorReading& reading) override;
+    [[nodiscard]] uint32_t count() const override;
+    uint16_t readRecords(uint32_t offset, uint8_t* buffer, uint16_t maxRecords) override;
+    uint32_t findOffset(uint32_t timestamp) override;
+
+    /**
+     * @brief Programs the records still held in the page buffer.
+     */
+    bool flush();
+
+private:
+    FlashDevice* _flash;
+    uint8_t _flushThreshold;
+    uint32_t _blockSize;
+    uint16_t _blockCount;
+    uint16_t _recordsPerBlock;
+    uint16_t _headBlock;
+    uint16_t _usedBlocks;
+    uint32_t _headSequence;
+    uint16_t _headRecords;    // Records appended to the head block, buffered ones included
+    uint16_t _flushedRecords; // Records of the head block already programmed
+    uint8_t _pageBuffer[FLASH_PAGE_BUFFER_RECORDS * RECORD_SIZE_BYTES];
+    uint32_t* _firstTimestamps; // _blockCount entries
+
+    [[nodiscard]] uint32_t blockAddress(uint16_t block) const;
+    [[nodiscard]] uint16_t tailBlock() const;
+    [[nodiscard]] uint16_t recordsIn(uint16_t block) const;
+    bool readHeader(uint16_t block, uint32_t& sequence, uint32_t& eraseCount);
+    bool openBlock(uint16_t block, uint32_t sequence);
+    bool openNextBlock();
+    bool isSlotEmpty(uint16_t block, uint16_t slot);
+    void locate(uint32_t offset, uint16_t& block, uint16_t& slot) const;
+    [[nodiscard]] uint32_t offsetOf(uint16_t block, uint16_t slot) const;
+};
+
+#endif //FLASHRECORDSTORE_H
@@ -0,0 +1,81 @@
+#include "FramRecordStore.h"
+
+FramRecordStore::FramRecordStore(FramStorage *fram) : _fram(fram), _header() {
+}
+
+bool FramRecordStore::begin() {
+    std::lock_guard<std::recursive_mutex> guard(_lock);
+    _header = _fram->readRingHeader();
+    if (_header.firstRecordAddress < RECORD_START_ADDRESS || _header.firstRecordAddress >= RECORD_END_ADDRESS
+        || _header.lastRecordAddress < RECORD_START_ADDRESS || _header.lastRecordAddress >= RECORD_END_ADDRESS) {
+        // Never initialized: start an empty ring
+        _header.lastRecordTimestamp = 0;
+        _header.firstRecordAddress = RECORD_START_ADDRESS;
+        _header.lastRecordAddress = RECORD_START_ADDRESS;
+        return _fram->writeUInt32(LAST_RECORD_TIMESTAMP_ADDRESS, _header.lastRecordTimestamp)
+               && _fram->writeUInt16(FIRST_RECORD_ADDRESS, _header.firstRecordAddress)
+               && _fram->writeUInt16(LAST_RECORD_ADDRESS, _header.lastRecordAddress);
+    }
+    return true;
+}
+
+bool FramRecordStore::append(const SensorReading &reading) {
+    std::lock_guard<std::recursive_mutex> guard(_lock);
+    const uint16_t address = NEXT_ADDRESS(_header.lastRecordAddress);
+    if (address == _header.firstRecordAddress) {
+        _header.firstRecordAddress = NEXT_ADDRESS(_header.firstRecordAddress);
+        _fram->writeUInt16(FIRST_RECORD_ADDRESS, _header.firstRecordAddress);
+    }
+
+    // Record first, then the header: a reader never sees a slot that is not written yet
+    if (!_fram->writeSensorReading(address, reading)) {
+        return false;
+    }
+    _header.lastRecordTimestamp = reading.timestamp;
+    _header.lastRecordAddress = address;
+    _fram->writeUInt32(LAST_RECORD_TIMESTAMP_ADDRESS, _header.lastRecordTimestamp);
+    return _fram->writeUInt16(LAST_RECORD_ADDRESS, _header.lastRecordAddress);
+}
+
+uint32_t FramRecordStore::count() const {
+    std::lock_guard<std::recursive_mutex> guard(_lock);
+    // The ring always holds a whole number of slots
+    return (((int32_t) _header.lastRecordAddress - _header.firstRecordAddress) / RECORD_SIZE_BYTES
+            + RECORD_SLOT_COUNT) % RECORD_SLOT_COUNT;
+}
+
+uint16_t FramRecordStore::readRecords(uint32_t offset, uint8_t *buffer, uint16_t maxRecords) {
+    std::lock_guard<std::recursive_mutex> guard(_lock);
+    const uint32_t available = count();
+    if (offset >= available) {
+        return 0;
+    }
+    uint16_t remaining = available - offset < maxRecords ? available - offset : maxRecords;
+
+    // Older records sit at lower addresses: read contiguous runs going down, then put each run newest first
+    uint16_t address = addressOf(offset);
+    uint16_t read = 0;
+    while (remaining > 0) {
+        uint16_t run = (address - RECORD_START_ADDRESS) / RECORD_SIZE_BYTES + 1;
+        if (run > remaining) run = remaining;
+        const uint16_t lowest = address - (run - 1) * RECORD_SIZE_BYTES;
+
+        uint8_t *out = buffer + read * RECORD_SIZE_BYTES;
+        if (_fram->readBytes(lowest, out, run * RECORD_SIZE_BYTES) != run * RECORD_SIZE_BYTES) {
+            break;
+        }
+        reverseRecords(out, run);
+
+        read += run;
+        remaining -= run;
+        address = PREVIOUS_ADDRESS(lowest);
+    }
+    return read;
+}
+
+uint16_t FramRecordStore::addressOf(uint32_t offset) const {
+    int32_t address = _header.lastRecordAddress - (int32_t) offset * RECORD_SIZE_BYTES;
+    if (address < RECORD_START_ADDRESS)
+        address += RECORD_SLOT_COUNT * RECORD_SIZE_BYTES;
+    return address;
+}
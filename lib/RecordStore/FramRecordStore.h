@@ -0,0 +1,29 @@
+#ifndef FRAMRECORDSTORE_H
+#define FRAMRECORDSTORE_H
+
+#include <FramStorage.h>
+#include "RecordStore.h"
+
+/**
+ * RecordStore backed by the record ring of the I2C FRAM (RECORD_START_ADDRESS to RECORD_END_ADDRESS).
+ *
+ * The ring header is read once in begin() and kept in RAM, every append writes it through. As before, the slot at
+ * FIRST_RECORD_ADDRESS is not part of the readable history.
+ */
+class FramRecordStore final : public RecordStore {
+public:
+    explicit FramRecordStore(FramStorage* fram);
+
+    bool begin() override;
+    bool append(const SensorReading& reading) override;
+    [[nodiscard]] uint32_t count() const override;
+    uint16_t readRecords(uint32_t offset, uint8_t* buffer, uint16_t maxRecords) override;
+
+private:
+    FramStorage* _fram;
+    RecordRingHeader _header;
+
+    [[nodiscard]] uint16_t addressOf(uint32_t offset) const;
+};
+
+#endif //FRAMRECORDSTORE_H
@@ -0,0 +1,61 @@
+#include "RecordStore.h"
+
+uint32_t RecordStore::findOffset(uint32_t timestamp) {
+    std::lock_guard<std::recursive_mutex> guard(_lock);
+    const uint32_t available = count();
+    if (available == 0) {
+        return RECORD_NOT_FOUND;
+    }
+    return findOffsetBetween(timestamp, 0, available - 1);
+}
+
+bool RecordStore::readRecord(uint32_t offset, SensorReading &reading) {
+    std::lock_guard<std::recursive_mutex> guard(_lock);
+    uint8_t record[RECORD_SIZE_BYTES];
+    if (readRecords(offset, record, 1) != 1) {
+        return false;
+    }
+    reading = SensorReading(
+        StoredRecordSchema::get<STORED_TEMPERATURE>(record),
+        StoredRecordSchema::get<STORED_HUMIDITY>(record),
+        StoredRecordSchema::get<STORED_TIMESTAMP>(record)
+    );
+    return true;
+}
+
+uint32_t RecordStore::findOffsetBetween(uint32_t timestamp, uint32_t newestOffset, uint32_t oldestOffset) {
+    // Timestamps decrease when the offset grows: look for the smallest offset whose timestamp is <= timestamp
+    if (readTimestamp(oldestOffset) > timestamp) {
+        return RECORD_NOT_FOUND;
+    }
+    uint32_t low = newestOffset;
+    uint32_t high = oldestOffset;
+    while (low < high) {
+        const uint32_t middle = low + (high - low) / 2;
+        if (readTimestamp(middle) <= timestamp) {
+            high = middle;
+        } else {
+            low = middle + 1;
+        }
+    }
+    return low;
+}
+
+uint32_t RecordStore::readTimestamp(uint32_t offset) {
+    uint8_t record[RECORD_SIZE_BYTES];
+    if (readRecords(offset, record, 1) != 1) {
+        return 0;
+    }
+    return StoredRecordSchema::get<STORED_TIMESTAMP>(record);
+}
+
+void RecordStore::reverseRecords(uint8_t *records, uint16_t count) {
+    for (uint16_t i = 0; i < count / 2; ++i) {
+        uint8_t swap[RECORD_SIZE_BYTES];
+        uint8_t *older = records + i * RECORD_SIZE_BYTES;
+        uint8_t *newer = records + (count - 1 - i) * RECORD_SIZE_BYTES;
+        memcpy(swap, older, RECORD_SIZE_BYTES);
+        memcpy(older, newer, RECORD_SIZE_BYTES);
+        memcpy(newer, swap, RECORD_SIZE_BYTES);
+    }
+}
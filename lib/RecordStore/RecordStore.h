@@ -0,0 +1,81 @@
+#ifndef RECORDSTORE_H
+#define RECORDSTORE_H
+
+#include <Arduino.h>
+#include <mutex>
+#include <SensorReading.h>
+
+#define RECORD_NOT_FOUND 0xFFFFFFFF
+
+/**
+ * Persistent history of SensorReadings.
+ *
+ * Records are addressed by offset: 0 is the newest record, count() - 1 the oldest one. They are exchanged in their
+ * stored layout (StoredRecordSchema, RECORD_SIZE_BYTES each) so that readers such as the BLE server can transcode
+ * them straight into their own buffers.
+ *
+ * The sampling loop appends while the BLE task reads: implementations hold _lock in every public method, so a reader
+ * never sees a half updated ring header or log position.
+ */
+class RecordStore {
+public:
+    virtual ~RecordStore() = default;
+
+    /**
+     * @brief Restores the store state from the medium. Must be called before any other method.
+     * @return True if the store is usable.
+     */
+    virtual bool begin() = 0;
+
+    /**
+     * @brief Appends a record, dropping the oldest ones when the medium is full.
+     * @return True on success.
+     */
+    virtual bool append(const SensorReading& reading) = 0;
+
+    /**
+     * @return Number of records available.
+     */
+    [[nodiscard]] virtual uint32_t count() const = 0;
+
+    /**
+     * @brief Reads consecutive records, newest first.
+     * @param offset Offset of the first (newest) record to read.
+     * @param buffer Destination, must hold maxRecords * RECORD_SIZE_BYTES bytes.
+     * @param maxRecords Maximum number of records to read.
+     * @return Number of records read, less than maxRecords when the oldest record is reached or on error.
+     */
+    virtual uint16_t readRecords(uint32_t offset, uint8_t* buffer, uint16_t maxRecords) = 0;
+
+    /**
+     * @brief Finds the newest record with a timestamp lower than or equal to the given one.
+     *        Records are assumed to be appended in timestamp order.
+     * @return Its offset, or RECORD_NOT_FOUND if every record is newer.
+     */
+    virtual uint32_t findOffset(uint32_t timestamp);
+
+    /**
+     * @brief Reads a single record.
+     * @return False if there is no record at that offset.
+     */
+    bool readRecord(uint32_t offset, SensorReading& reading);
+
+protected:
+    // Recursive: findOffset() and readRecord() go through readRecords()
+    mutable std::recursive_mutex _lock;
+
+    /**
+     * @brief Binary search of findOffset() restricted to [newestOffset, oldestOffset].
+     */
+    uint32_t findOffsetBetween(uint32_t timestamp, uint32_t newestOffset, uint32_t oldestOffset);
+
+    /**
+     * @brief Reverses the order of count consecutive records, used to turn oldest-first media reads newest first.
+     */
+    static void reverseRecords(uint8_t* records, uint16_t count);
+
+private:
+    uint32_t readTimestamp(uint32_t offset);
+};
+
+#endif //RECORDSTORE_H
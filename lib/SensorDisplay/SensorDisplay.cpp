@@ -0,0 +1,235 @@
+#include "SensorDisplay.h"
+
+#define SCREEN_MARGIN 4
+
+SensorDisplay::SensorDisplay(Adafruit_GFX *gfx, RecordStore *records)
+    : _gfx(gfx),
+      _records(records),
+      _temperature(),
+      _humidity(),
+      _sparkLeft(SCREEN_MARGIN),
+      _sparkStep(1),
+      _temperatureHistory(),
+      _humidityHistory(),
+      _bucketRecords(),
+      _historyHead(0),
+      _historyCount(0),
+      _newestBucket(0) {
+}
+
+void SensorDisplay::begin() {
+    _gfx->fillScreen(DISPLAY_BACKGROUND);
+    _gfx->setTextWrap(false);
+
+    // Spread the 24h window over the usable width, at least one pixel per bucket
+    const int16_t usableWidth = _gfx->width() - 2 * SCREEN_MARGIN;
+    _sparkStep = usableWidth / (SPARKLINE_POINTS - 1);
+    if (_sparkStep < 1) _sparkStep = 1;
+
+    const int16_t half = _gfx->height() / 2;
+    layoutSection(_temperature, 0, half, "Temperature", 'C', DISPLAY_TEMPERATURE);
+    layoutSection(_humidity, half, _gfx->height() - half, "Humidity", '%', DISPLAY_HUMIDITY);
+
+    loadHistory();
+    drawSparkline(_temperature, _temperatureHistory);
+    drawSparkline(_humidity, _humidityHistory);
+}
+
+void SensorDisplay::showReading(const SensorReading &reading) {
+    drawValue(_temperature, reading.temperature);
+    drawValue(_humidity, reading.humidity);
+}
+
+void SensorDisplay::appendRecord(const SensorReading &reading) {
+    addToHistory(reading.temperature, reading.humidity, reading.timestamp);
+    drawSparkline(_temperature, _temperatureHistory);
+    drawSparkline(_humidity, _humidityHistory);
+}
+
+void SensorDisplay::layoutSection(Section &section, int16_t top, int16_t height, const char *label, char unit,
+                                  uint16_t color) {
+    const int16_t valueTop = top + SCREEN_MARGIN + GLYPH_HEIGHT * LABEL_TEXT_SIZE + 2;
+    const int16_t valueBottom = valueTop + GLYPH_HEIGHT * VALUE_TEXT_SIZE;
+
+    section.top = valueTop;
+    section.sparkTop = valueBottom + SCREEN_MARGIN;
+    section.sparkHeight = top + height - SCREEN_MARGIN - section.sparkTop;
+    if (section.sparkHeight > 255) section.sparkHeight = 255; // Plotted offsets are stored on 8 bits
+    if (section.sparkHeight < 1) section.sparkHeight = 1;
+    section.color = color;
+    memset(section.text, ' ', VALUE_FIELD_LENGTH); // Matches the freshly cleared screen
+    section.text[VALUE_FIELD_LENGTH] = '\0';
+    section.plottedCount = 0;
+
+    // Static parts are drawn once, they are never touched again
+    _gfx->setTextSize(LABEL_TEXT_SIZE);
+    _gfx->setTextColor(color, DISPLAY_BACKGROUND);
+    _gfx->setCursor(_sparkLeft, top + SCREEN_MARGIN);
+    _gfx->print(label);
+    _gfx->drawChar(_sparkLeft + VALUE_FIELD_LENGTH * GLYPH_WIDTH * VALUE_TEXT_SIZE, valueTop, unit,
+                   DISPLAY_FOREGROUND, DISPLAY_BACKGROUND, VALUE_TEXT_SIZE);
+}
+
+void SensorDisplay::loadHistory() {
+    for (uint8_t i = 0; i < SPARKLINE_POINTS; ++i) {
+        _temperatureHistory[i] = NAN;
+        _humidityHistory[i] = NAN;
+        _bucketRecords[i] = 0;
+    }
+    _historyHead = 0;
+    _historyCount = 0;
+
+    // Read the newest records in chunks, the newest bucket goes in the last slot. A day of fast changes is up to
+    // one record per minute, this only runs once from the deferred init.
+    uint8_t chunk[HISTORY_CHUNK_RECORDS * RECORD_SIZE_BYTES];
+    uint32_t offset = 0;
+    bool complete = false;
+    while (!complete) {
+        const uint16_t read = _records->readRecords(offset, chunk, HISTORY_CHUNK_RECORDS);
+        complete = read < HISTORY_CHUNK_RECORDS; // Oldest record reached
+        for (uint16_t i = 0; i < read; ++i) {
+            const uint8_t *record = chunk + i * RECORD_SIZE_BYTES;
+            const uint32_t bucket = StoredRecordSchema::get<STORED_TIMESTAMP>(record) / SPARKLINE_BUCKET_SECONDS;
+            if (offset + i == 0) {
+                _newestBucket = bucket;
+            }
+            if (bucket > _newestBucket || _newestBucket - bucket >= SPARKLINE_POINTS) {
+                complete = true; // Older than 24h (or not a valid record at all)
+                break;
+            }
+            const uint8_t slot = SPARKLINE_POINTS - 1 - (_newestBucket - bucket);
+            addToBucket(slot, StoredRecordSchema::get<STORED_TEMPERATURE>(record),
+                        StoredRecordSchema::get<STORED_HUMIDITY>(record));
+            _historyCount = SPARKLINE_POINTS - slot;
+        }
+        offset += read;
+    }
+    _historyHead = _historyCount > 0 ? SPARKLINE_POINTS - _historyCount : 0;
+}
+
+void SensorDisplay::addToHistory(float temperature, float humidity, uint32_t timestamp) {
+    const uint32_t bucket = timestamp / SPARKLINE_BUCKET_SECONDS;
+    if (_historyCount == 0) {
+        _newestBucket = bucket;
+        _historyCount = 1;
+    } else if (bucket > _newestBucket) {
+        // Scroll: buckets without records stay empty, the polyline holds its last value across them
+        const uint32_t elapsed = bucket - _newestBucket;
+        for (uint32_t i = 0; i < elapsed && i < SPARKLINE_POINTS; ++i) {
+            pushEmptyBucket();
+        }
+        _newestBucket = bucket;
+        // The oldest buckets may have scrolled into a gap, the polyline starts at the oldest record
+        while (_historyCount > 1 && _bucketRecords[_historyHead] == 0) {
+            _historyHead = (_historyHead + 1) % SPARKLINE_POINTS;
+            _historyCount--;
+        }
+    } else if (_newestBucket - bucket >= _historyCount) {
+        return; // Clock set back before the plotted window
+    }
+    addToBucket((_historyHead + _historyCount - 1 - (_newestBucket - bucket)) % SPARKLINE_POINTS, temperature,
+                humidity);
+}
+
+void SensorDisplay::addToBucket(uint8_t slot, float temperature, float humidity) {
+    if (isnan(temperature) || isnan(humidity) || _bucketRecords[slot] == UINT8_MAX) {
+        return;
+    }
+    // Running mean: one float per bucket and quantity whatever the record rate
+    const uint8_t records = ++_bucketRecords[slot];
+    if (records == 1) {
+        _temperatureHistory[slot] = temperature;
+        _humidityHistory[slot] = humidity;
+    } else {
+        _temperatureHistory[slot] += (temperature - _temperatureHistory[slot]) / records;
+        _humidityHistory[slot] += (humidity - _humidityHistory[slot]) / records;
+    }
+}
+
+void SensorDisplay::pushEmptyBucket() {
+    uint8_t index;
+    if (_historyCount < SPARKLINE_POINTS) {
+        index = (_historyHead + _historyCount) % SPARKLINE_POINTS;
+        _historyCount++;
+    } else {
+        index = _historyHead;
+        _historyHead = (_historyHead + 1) % SPARKLINE_POINTS;
+    }
+    _temperatureHistory[index] = NAN;
+    _humidityHistory[index] = NAN;
+    _bucketRecords[index] = 0;
+}
+
+void SensorDisplay::drawValue(Section &section, float value) {
+    char text[VALUE_FIELD_LENGTH + 1];
+    if (isnan(value)) {
+        snprintf(text, sizeof(text), "%*s", VALUE_FIELD_LENGTH, "---");
+    } else {
+        snprintf(text, sizeof(text), "%*.1f", VALUE_FIELD_LENGTH, value);
+    }
+
+    // drawChar with a background color overwrites the whole glyph cell, no need to clear first
+    const int16_t glyphWidth = GLYPH_WIDTH * VALUE_TEXT_SIZE;
+    for (uint8_t i = 0; i < VALUE_FIELD_LENGTH && text[i] != '\0'; ++i) {
+        if (text[i] != section.text[i]) {
+            _gfx->drawChar(_sparkLeft + i * glyphWidth, section.top, text[i], section.color, DISPLAY_BACKGROUND,
+                           VALUE_TEXT_SIZE);
+            section.text[i] = text[i];
+        }
+    }
+}
+
+void SensorDisplay::drawSparkline(Section &section, const float *history) {
+    float minValue = NAN;
+    float maxValue = NAN;
+    for (uint8_t i = 0; i < _historyCount; ++i) {
+        const float value = history[(_historyHead + i) % SPARKLINE_POINTS];
+        if (isnan(value)) continue;
+        if (isnan(minValue) || value < minValue) minValue = value;
+        if (isnan(maxValue) || value > maxValue) maxValue = value;
+    }
+
+    uint8_t points[SPARKLINE_POINTS];
+    uint8_t count = 0;
+    if (!isnan(minValue)) {
+        // Keep at least one unit of range so that sensor noise on a flat day is not blown up to full height
+        if (maxValue - minValue < 1.0f) {
+            const float center = (maxValue + minValue) / 2;
+            minValue = center - 0.5f;
+            maxValue = center + 0.5f;
+        }
+
+        const float scale = (section.sparkHeight - 1) / (maxValue - minValue);
+        uint8_t previous = section.sparkHeight - 1;
+        for (; count < _historyCount; ++count) {
+            const float value = history[(_historyHead + count) % SPARKLINE_POINTS];
+            if (!isnan(value)) {
+                previous = section.sparkHeight - 1 - (uint8_t) lroundf((value - minValue) * scale);
+            }
+            points[count] = previous;
+        }
+    }
+
+    // Erasing the previous polyline pushes far fewer pixels than clearing the whole sparkline area
+    drawPolyline(section, section.plotted, section.plottedCount, DISPLAY_BACKGROUND);
+    drawPolyline(section, points, count, section.color);
+    memcpy(section.plotted, points, count);
+    section.plottedCount = count;
+}
+
+void SensorDisplay::drawPolyline(const Section &section, const uint8_t *points, uint8_t count, uint16_t color) {
+    if (count == 0) return;
+
+    // Newest point is always on the right edge
+    const int16_t left = _sparkLeft + (SPARKLINE_POINTS - count) * _sparkStep;
+
+    _gfx->startWrite();
+    if (count == 1) {
+        _gfx->writePixel(left, section.sparkTop + points[0], color);
+    }
+    for (uint8_t i = 1; i < count; ++i) {
+        _gfx->writeLine(left + (i - 1) * _sparkStep, section.sparkTop + points[i - 1],
+                        left + i * _sparkStep, section.sparkTop + points[i], color);
+    }
+    _gfx->endWrite();
+}
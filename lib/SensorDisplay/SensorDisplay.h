@@ -0,0 +1,95 @@
+#ifndef SENSORDISPLAY_H
+#define SENSORDISPLAY_H
+
+#include <Arduino.h>
+#include <Adafruit_GFX.h>
+#include <FramStorage.h>
+#include <RecordStore.h>
+#include <SensorReading.h>
+
+// Last 24 hours of stored records, bucketed by timestamp: records come at an irregular rate (one per minute during
+// fast changes, one per MAX_RECORD_INTERVAL_SECONDS when flat), the x axis stays linear in time
+#define SPARKLINE_POINTS        72
+#define SPARKLINE_WINDOW_SECONDS (24 * 3600)
+#define SPARKLINE_BUCKET_SECONDS (SPARKLINE_WINDOW_SECONDS / SPARKLINE_POINTS)
+#define HISTORY_CHUNK_RECORDS   12 // Records read per store access while loading the history
+
+// Value fields are drawn as fixed width text so that only changed characters have to be pushed
+#define VALUE_FIELD_LENGTH      5
+#define VALUE_TEXT_SIZE         3
+#define LABEL_TEXT_SIZE         1
+#define GLYPH_WIDTH             6 // Classic GFX font: 5 columns + 1 spacing column
+#define GLYPH_HEIGHT            8
+
+// RGB565 colors
+#define DISPLAY_BACKGROUND      0x0000
+#define DISPLAY_FOREGROUND      0xFFFF
+#define DISPLAY_TEMPERATURE     0xFC00 // Orange
+#define DISPLAY_HUMIDITY        0x07FF // Cyan
+
+class SensorDisplay {
+public:
+    /**
+     * @brief Constructor for the on-device display.
+     * @param gfx Any Adafruit_GFX target (ST7735, ST7789, ...). Must already be initialized by the caller.
+     * @param records Store holding the history used to seed the sparklines.
+     */
+    SensorDisplay(Adafruit_GFX* gfx, RecordStore* records);
+
+    /**
+     * @brief Draws the static layout and the sparklines for the last 24 hours of stored records.
+     */
+    void begin();
+
+    /**
+     * @brief Updates the current temperature and humidity. Only the characters that changed are redrawn.
+     * @param reading The latest sample.
+     */
+    void showReading(const SensorReading& reading);
+
+    /**
+     * @brief Adds a freshly stored record to the sparklines and redraws them. The sparklines scroll when it starts
+     *        a new bucket.
+     * @param reading The record that has just been appended to the store.
+     */
+    void appendRecord(const SensorReading& reading);
+
+private:
+    // Screen area owned by one measured quantity (label, digits and sparkline)
+    struct Section {
+        int16_t top;
+        int16_t sparkTop;
+        int16_t sparkHeight;
+        uint16_t color;
+        char text[VALUE_FIELD_LENGTH + 1];
+        uint8_t plotted[SPARKLINE_POINTS]; // Y offsets of the polyline currently on screen
+        uint8_t plottedCount;
+    };
+
+    Adafruit_GFX* _gfx;
+    RecordStore* _records;
+
+    Section _temperature;
+    Section _humidity;
+    int16_t _sparkLeft;
+    int16_t _sparkStep;
+
+    // History ring of bucket means, oldest bucket at _historyHead, NAN where a bucket holds no record
+    float _temperatureHistory[SPARKLINE_POINTS];
+    float _humidityHistory[SPARKLINE_POINTS];
+    uint8_t _bucketRecords[SPARKLINE_POINTS];
+    uint8_t _historyHead;
+    uint8_t _historyCount;
+    uint32_t _newestBucket; // timestamp / SPARKLINE_BUCKET_SECONDS of the newest bucket
+
+    void layoutSection(Section& section, int16_t top, int16_t height, const char* label, char unit, uint16_t color);
+    void loadHistory();
+    void addToHistory(float temperature, float humidity, uint32_t timestamp);
+    void addToBucket(uint8_t slot, float temperature, float humidity);
+    void pushEmptyBucket();
+    void drawValue(Section& section, float value);
+    void drawSparkline(Section& section, const float* history);
+    void drawPolyline(const Section& section, const uint8_t* points, uint8_t count, uint16_t color);
+};
+
+#endif //SENSORDISPLAY_H
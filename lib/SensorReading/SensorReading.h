@@ -4,6 +4,8 @@
 
 #ifndef SENSORREADING_H
 #define SENSORREADING_H
+#include <WireSchema.h>
+
 // Define the structure for sensor data
 #define RECORD_SIZE_BYTES                12
 
@@ -16,4 +18,10 @@ struct SensorReading {
     SensorReading() : temperature(0.0f), humidity(0.0f), timestamp(0L) {}
     SensorReading(float temp, float hum, uint32_t ts) : temperature(temp), humidity(hum), timestamp(ts) {}
 };
+
+// Layout of a SensorReading as stored in FRAM (raw struct bytes, little-endian targets)
+using StoredRecordSchema = wire::Schema<float, float, uint32_t>;
+enum StoredRecordField : size_t { STORED_TEMPERATURE, STORED_HUMIDITY, STORED_TIMESTAMP };
+static_assert(StoredRecordSchema::size == RECORD_SIZE_BYTES, "Stored record schema does not match RECORD_SIZE_BYTES");
+static_assert(sizeof(SensorReading) == RECORD_SIZE_BYTES, "SensorReading is not packed as RECORD_SIZE_BYTES");
 #endif //SENSORREADING_H
@@ -0,0 +1,93 @@
+#include "Sht3xSensor.h"
+#include <Trace.h>
+
+#define SHT3X_CMD_FETCH_DATA    0xE000
+#define SHT3X_CMD_BREAK         0x3093
+#define SHT3X_BREAK_DELAY_MS    1
+
+// Periodic mode commands, indexed by [rate][repeatability] (datasheet table 10)
+static const uint16_t PERIODIC_COMMANDS[5][3] = {
+    {0x202F, 0x2024, 0x2032}, // 0.5 mps
+    {0x212D, 0x2126, 0x2130}, // 1 mps
+    {0x222B, 0x2220, 0x2236}, // 2 mps
+    {0x2329, 0x2322, 0x2334}, // 4 mps
+    {0x272A, 0x2721, 0x2737}, // 10 mps
+};
+
+Sht3xSensor::Sht3xSensor(uint8_t address, TwoWire *wire)
+    : _address(address),
+      _wire(wire),
+      _temperature(NAN),
+      _humidity(NAN) {
+}
+
+bool Sht3xSensor::begin(MeasurementRate rate, Repeatability repeatability) {
+    // The sensor is not reset with the MCU, it may still be in a periodic mode from the previous boot
+    stop();
+    return startPeriodic(rate, repeatability);
+}
+
+bool Sht3xSensor::startPeriodic(MeasurementRate rate, Repeatability repeatability) {
+    return sendCommand(PERIODIC_COMMANDS[rate][repeatability]);
+}
+
+bool Sht3xSensor::stop() {
+    const bool acknowledged = sendCommand(SHT3X_CMD_BREAK);
+    delay(SHT3X_BREAK_DELAY_MS);
+    return acknowledged;
+}
+
+bool Sht3xSensor::fetch() {
+    TRACE_SCOPE("sht.fetch");
+    // Invalid until this fetch succeeds: a caller missing the return value never sees an older measurement
+    _temperature = NAN;
+    _humidity = NAN;
+    if (!sendCommand(SHT3X_CMD_FETCH_DATA)) {
+        return false;
+    }
+    // The sensor NACKs the read header when no measurement completed since the last fetch
+    if (_wire->requestFrom(_address, (uint8_t) SHT3X_DATA_LENGTH) != SHT3X_DATA_LENGTH) {
+        return false;
+    }
+
+    uint8_t data[SHT3X_DATA_LENGTH];
+    for (uint8_t i = 0; i < SHT3X_DATA_LENGTH; ++i) {
+        data[i] = _wire->read();
+    }
+    if (crc8(data, 2) != data[2] || crc8(data + 3, 2) != data[5]) {
+        return false;
+    }
+
+    const uint16_t rawTemperature = (data[0] << 8) | data[1];
+    const uint16_t rawHumidity = (data[3] << 8) | data[4];
+    _temperature = -45.0f + 175.0f * rawTemperature / 65535.0f;
+    _humidity = 100.0f * rawHumidity / 65535.0f;
+    return true;
+}
+
+float Sht3xSensor::getTemperature() const {
+    return _temperature;
+}
+
+float Sht3xSensor::getHumidity() const {
+    return _humidity;
+}
+
+bool Sht3xSensor::sendCommand(uint16_t command) {
+    _wire->beginTransmission(_address);
+    _wire->write((uint8_t) (command >> 8));
+    _wire->write((uint8_t) (command & 0xFF));
+    return _wire->endTransmission() == 0;
+}
+
+// CRC-8, polynomial 0x31, initialization 0xFF (datasheet section 4.12)
+uint8_t Sht3xSensor::crc8(const uint8_t *data, uint8_t length) {
+    uint8_t crc = 0xFF;
+    for (uint8_t i = 0; i < length; ++i) {
+        crc ^= data[i];
+        for (uint8_t bit = 0; bit < 8; ++bit) {
+            crc = (crc & 0x80) ? (uint8_t) ((crc << 1) ^ 0x31) : (uint8_t) (crc << 1);
+        }
+    }
+    return crc;
+}
@@ -0,0 +1,78 @@
+#ifndef SHT3XSENSOR_H
+#define SHT3XSENSOR_H
+
+#include <Arduino.h>
+#include <Wire.h>
+
+#define SHT3X_DEFAULT_ADDRESS 0x44
+#define SHT3X_DATA_LENGTH     6 // Temperature MSB, LSB, CRC, humidity MSB, LSB, CRC
+
+/**
+ * Non-blocking SHT3x driver.
+ *
+ * The sensor runs in periodic acquisition mode and converts on its own; fetch() only issues the "fetch data"
+ * command and reads the latest result, so the CPU is busy for the I2C transfer only instead of the whole
+ * conversion (up to 15 ms at high repeatability) like a single shot read with clock stretching.
+ */
+class Sht3xSensor {
+public:
+    enum Repeatability {
+        REPEATABILITY_LOW,
+        REPEATABILITY_MEDIUM,
+        REPEATABILITY_HIGH
+    };
+
+    enum MeasurementRate {
+        RATE_0_5_MPS,
+        RATE_1_MPS,
+        RATE_2_MPS,
+        RATE_4_MPS,
+        RATE_10_MPS
+    };
+
+    explicit Sht3xSensor(uint8_t address = SHT3X_DEFAULT_ADDRESS, TwoWire* wire = &Wire);
+
+    /**
+     * @brief Stops any acquisition left running by a previous boot and starts periodic mode.
+     * @return True if the sensor acknowledged the commands.
+     */
+    bool begin(MeasurementRate rate = RATE_2_MPS, Repeatability repeatability = REPEATABILITY_MEDIUM);
+
+    /**
+     * @brief Switches to another periodic mode. The first result of the new mode is available one period later.
+     */
+    bool startPeriodic(MeasurementRate rate, Repeatability repeatability);
+
+    /**
+     * @brief Stops periodic acquisition, the sensor goes back to idle.
+     */
+    bool stop();
+
+    /**
+     * @brief Reads the latest measurement without waiting for a conversion.
+     * @return True if a new measurement was read and passed the CRC check. False if no measurement completed
+     *         since the previous fetch, on I2C error or CRC mismatch; the values are NAN until the next success.
+     */
+    bool fetch();
+
+    /**
+     * @return Temperature in °C read by the last fetch(), NAN if it failed.
+     */
+    [[nodiscard]] float getTemperature() const;
+
+    /**
+     * @return Relative humidity in %RH read by the last fetch(), NAN if it failed.
+     */
+    [[nodiscard]] float getHumidity() const;
+
+private:
+    uint8_t _address;
+    TwoWire* _wire;
+    float _temperature;
+    float _humidity;
+
+    bool sendCommand(uint16_t command);
+    static uint8_t crc8(const uint8_t* data, uint8_t length);
+};
+
+#endif //SHT3XSENSOR_H
@@ -0,0 +1,48 @@
+#include "Trace.h"
+
+#ifdef TRACE_ENABLED
+
+TraceBuffer trace;
+
+TraceBuffer::TraceBuffer() : _events(), _recorded(0) {
+}
+
+void TraceBuffer::record(const char *name, uint32_t startMicros, uint32_t durationCycles) {
+    // A slot being rewritten while it is dumped yields one garbled line, never a blocked caller
+    TraceEvent &event = _events[_recorded.fetch_add(1, std::memory_order_relaxed) % TRACE_BUFFER_EVENTS];
+    event.name = name;
+    event.task = pcTaskGetName(nullptr);
+    event.startMicros = startMicros;
+    event.durationCycles = durationCycles;
+}
+
+void TraceBuffer::dump(Print &out) {
+    const uint32_t recorded = _recorded.exchange(0, std::memory_order_relaxed);
+    const uint32_t count = recorded < TRACE_BUFFER_EVENTS ? recorded : TRACE_BUFFER_EVENTS;
+
+    out.print("TRACE BEGIN ");
+    out.print(ESP.getCpuFreqMHz());
+    out.print(" ");
+    out.println(count);
+    for (uint32_t i = recorded - count; i < recorded; ++i) {
+        const TraceEvent &event = _events[i % TRACE_BUFFER_EVENTS];
+        out.print(event.startMicros);
+        out.print(" ");
+        out.print(event.durationCycles);
+        out.print(" ");
+        out.print(event.task);
+        out.print(" ");
+        out.println(event.name);
+    }
+    out.println("TRACE END");
+}
+
+TraceScope::TraceScope(const char *name) : _name(name), _startMicros(micros()), _startCycles(ESP.getCycleCount()) {
+}
+
+TraceScope::~TraceScope() {
+    // Same task, hence same core, as the constructor: the cycle difference is meaningful
+    trace.record(_name, _startMicros, ESP.getCycleCount() - _startCycles);
+}
+
+#endif
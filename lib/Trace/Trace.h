@@ -0,0 +1,81 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <Arduino.h>
+#include <atomic>
+
+// Events kept in RAM, the oldest ones are overwritten
+#define TRACE_BUFFER_EVENTS 256
+
+/**
+ * Scoped trace points recorded into a fixed RAM ring, for the cases counters cannot explain (why did this loop()
+ * iteration take 300 ms?).
+ *
+ * Build with -D TRACE_ENABLED (the *-trace envs) to turn them on. Without it TRACE_SCOPE and TRACE_DUMP expand to
+ * nothing and the buffer is not even instantiated. Durations are measured with the CPU cycle counter. The cycle
+ * counters of the two ESP32 cores are not synchronized, so scope starts are stamped with micros() to put every task
+ * on one timeline.
+ * Any task can record: slots are claimed with an atomic counter, nothing blocks.
+ *
+ * The dump is plain text, converted to Chrome trace JSON (chrome://tracing, Perfetto) by tools/trace2chrome.py:
+ *
+ *     TRACE BEGIN <cpu MHz> <events>
+ *     <start us> <duration cycles> <task> <name>
+ *     TRACE END
+ */
+struct TraceEvent {
+    const char* name;
+    const char* task;
+    uint32_t startMicros;
+    uint32_t durationCycles;
+};
+
+class TraceBuffer {
+public:
+    TraceBuffer();
+
+    /**
+     * @brief Records one completed scope.
+     * @param name Name of the scope, must outlive the buffer (string literal) and contain no newline.
+     */
+    void record(const char* name, uint32_t startMicros, uint32_t durationCycles);
+
+    /**
+     * @brief Prints the buffered events, oldest first, then clears the buffer.
+     * @param out Where to print, usually Serial.
+     */
+    void dump(Print& out);
+
+private:
+    TraceEvent _events[TRACE_BUFFER_EVENTS];
+    std::atomic<uint32_t> _recorded;
+};
+
+// Records the time spent between its construction and the end of the enclosing block
+class TraceScope {
+public:
+    explicit TraceScope(const char* name);
+    ~TraceScope();
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* _name;
+    uint32_t _startMicros;
+    uint32_t _startCycles;
+};
+
+#ifdef TRACE_ENABLED
+extern TraceBuffer trace;
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(_traceScope, __LINE__)(name)
+#define TRACE_DUMP(out) trace.dump(out)
+#else
+#define TRACE_SCOPE(name) do {} while (0)
+#define TRACE_DUMP(out) do {} while (0)
+#endif
+
+#endif //TRACE_H
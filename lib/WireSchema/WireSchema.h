@@ -0,0 +1,122 @@
+#ifndef WIRESCHEMA_H
+#define WIRESCHEMA_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <tuple>
+#include <type_traits>
+
+/**
+ * Compile-time description of packed little-endian records.
+ *
+ * A schema is the ordered list of its field types, offsets and total size are derived at compile time:
+ *
+ *     using Record = wire::Schema<uint16_t, float, float, uint32_t>;
+ *     Record::put<1>(buffer, 21.5f);           // temperature at byte 2
+ *     const float t = Record::get<1>(buffer);
+ *     static_assert(Record::size == 14, "");
+ *
+ * Little-endian targets (ESP32, x86 hosts) copy the field bytes as they are, others go byte by byte through shifts.
+ * Compilers do not reliably fold the byte loop into plain loads and stores (see the test_wire_schema benchmark).
+ */
+namespace wire {
+    template<size_t Size>
+    struct UnsignedOfSize;
+    template<> struct UnsignedOfSize<1> { using type = uint8_t; };
+    template<> struct UnsignedOfSize<2> { using type = uint16_t; };
+    template<> struct UnsignedOfSize<4> { using type = uint32_t; };
+    template<> struct UnsignedOfSize<8> { using type = uint64_t; };
+
+    template<typename T>
+    inline void storeLittleEndian(uint8_t *destination, T value) {
+        static_assert(std::is_arithmetic<T>::value, "Only arithmetic fields can be encoded");
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        memcpy(destination, &value, sizeof(T));
+#else
+        typename UnsignedOfSize<sizeof(T)>::type bits;
+        memcpy(&bits, &value, sizeof(T));
+        for (size_t i = 0; i < sizeof(T); ++i) {
+            destination[i] = static_cast<uint8_t>(bits >> (8 * i));
+        }
+#endif
+    }
+
+    template<typename T>
+    inline T loadLittleEndian(const uint8_t *source) {
+        static_assert(std::is_arithmetic<T>::value, "Only arithmetic fields can be decoded");
+        T value;
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        memcpy(&value, source, sizeof(T));
+#else
+        using Bits = typename UnsignedOfSize<sizeof(T)>::type;
+        Bits bits = 0;
+        for (size_t i = 0; i < sizeof(T); ++i) {
+            bits |= static_cast<Bits>(static_cast<Bits>(source[i]) << (8 * i));
+        }
+        memcpy(&value, &bits, sizeof(T));
+#endif
+        return value;
+    }
+
+    template<typename... Fields>
+    struct Schema {
+        static constexpr size_t fieldCount = sizeof...(Fields);
+        static constexpr size_t size = (sizeof(Fields) + ... + 0);
+
+        template<size_t Index>
+        using FieldType = typename std::tuple_element<Index, std::tuple<Fields...> >::type;
+
+        template<size_t Index>
+        static constexpr size_t offset() {
+            static_assert(Index < fieldCount, "Field index out of range");
+            constexpr size_t sizes[] = {sizeof(Fields)...};
+            size_t result = 0;
+            for (size_t i = 0; i < Index; ++i) {
+                result += sizes[i];
+            }
+            return result;
+        }
+
+        template<size_t Index>
+        static void put(uint8_t *record, FieldType<Index> value) {
+            storeLittleEndian(record + offset<Index>(), value);
+        }
+
+        template<size_t Index>
+        static FieldType<Index> get(const uint8_t *record) {
+            return loadLittleEndian<FieldType<Index> >(record + offset<Index>());
+        }
+
+        /**
+         * @brief Encodes all fields of one record, in schema order.
+         */
+        static void encode(uint8_t *record, Fields... values) {
+            encodeFrom<0>(record, values...);
+        }
+
+    private:
+        template<size_t Index>
+        static void encodeFrom(uint8_t *) {
+        }
+
+        template<size_t Index, typename First, typename... Rest>
+        static void encodeFrom(uint8_t *record, First first, Rest... rest) {
+            put<Index>(record, first);
+            encodeFrom<Index + 1>(record, rest...);
+        }
+    };
+
+    /**
+     * @brief Copies field SourceIndex of a Source record into field DestinationIndex of a Destination record.
+     */
+    template<typename Source, size_t SourceIndex, typename Destination, size_t DestinationIndex>
+    inline void copyField(const uint8_t *source, uint8_t *destination) {
+        static_assert(std::is_same<typename Source::template FieldType<SourceIndex>,
+                          typename Destination::template FieldType<DestinationIndex> >::value,
+                      "Copied fields must have the same type");
+        Destination::template put<DestinationIndex>(destination, Source::template get<SourceIndex>(source));
+    }
+}
+
+#endif //WIRESCHEMA_H
@@ -7,7 +7,6 @@ import com.zelgius.greenhousesensor.common.service.BleService
 import com.zelgius.greenhousesensor.common.service.GattConfig
 import java.nio.ByteBuffer
 import com.zelgius.greenhousesensor.common.model.SensorRecord
-import com.zelgius.greenhousesensor.common.repository.RecordRepository.Companion.NUMBER_OF_RECORDS_IN_A_DAY
 import com.zelgius.greenhousesensor.common.repository.RecordRepository.Companion.RECORD_DATA_CHARACTERISTIC_UUID
 import com.zelgius.greenhousesensor.common.repository.RecordRepository.Companion.RECORD_REQUEST_CHARACTERISTIC_UUID
 import com.zelgius.greenhousesensor.common.toByteArray
@@ -21,6 +20,11 @@ import kotlinx.coroutines.launch
 import kotlinx.coroutines.sync.Mutex
 import kotlinx.coroutines.sync.withLock
 import java.nio.ByteOrder
+import kotlin.time.Clock
+import kotlin.time.Duration
+import kotlin.time.Duration.Companion.days
+import kotlin.time.Duration.Companion.hours
+import kotlin.time.ExperimentalTime
 
 interface RecordRepository {
     companion object {
@@ -28,7 +32,10 @@ interface RecordRepository {
         const val RECORD_REQUEST_CHARACTERISTIC_UUID = "00000001-1fb5-459e-8fcc-c5c9c331914b"
         const val RECORD_DATA_CHARACTERISTIC_UUID = "00000002-1fb5-459e-8fcc-c5c9c331914b"
 
-        const val NUMBER_OF_RECORDS_IN_A_DAY = 72 // a record each 20 min
+        // The sensor records on change: at least one record every 2 h, up to one a minute when values move.
+        // The number of records in a day is not fixed, history is requested by time range.
+        val MAX_RECORD_INTERVAL = 2.hours
+        const val CURRENT_RECORD_OFFSET = 0xFFFF
 
         val RECORD_GATT_CONFIG = GattConfig(
             serviceUid = RECORD_LIST_SERVICE_UUID, characteristicUids = listOf(
@@ -39,7 +46,7 @@ interface RecordRepository {
 
     }
 
-    suspend fun requestRecords(count: Int = NUMBER_OF_RECORDS_IN_A_DAY): Flow<List<SensorRecord>>
+    suspend fun requestRecords(range: Duration = 1.days): Flow<List<SensorRecord>>
     fun connect(address: String)
     fun connect(device: BluetoothDevice)
     fun disconnect()
@@ -61,25 +68,28 @@ class RecordRepositoryImpl(private val bleService: BleService) : RecordRepositor
 
     @RequiresPermission(Manifest.permission.BLUETOOTH_CONNECT)
     override suspend fun getCurrentRecord(): SensorRecord? {
-        return readRecord(0xffFF) // Current record is always present
+        return readRecord(RecordRepository.CURRENT_RECORD_OFFSET) // Current record is always present
     }
 
     private val mutex = Mutex()
 
+    @OptIn(ExperimentalTime::class)
     @RequiresPermission(Manifest.permission.BLUETOOTH_CONNECT)
-    override suspend fun requestRecords(count: Int) = mutex.withLock {
+    override suspend fun requestRecords(range: Duration) = mutex.withLock {
         flow {
             val records = mutableListOf<SensorRecord>()
+            val oldest = Clock.System.now() - range
 
-            for (i in 0 until count) {
-                val record = readRecord(i)
-
-                record?.let {
-                    println("Record $i: $it")
-                    records.add(it)
-                }
+            // Newest first, until a record falls out of the range or the history ends (empty response)
+            var offset = 0
+            while (offset < RecordRepository.CURRENT_RECORD_OFFSET) {
+                val record = readRecord(offset) ?: break
+                if (record.date < oldest) break
 
+                println("Record $offset: $record")
+                records.add(record)
                 emit(records.toList())
+                ++offset
             }
         }
     }
@@ -117,10 +127,11 @@ class RecordRepositoryImpl(private val bleService: BleService) : RecordRepositor
 
 class MockRecordRepository(private val bleService: BleService) : RecordRepository {
     private val scope = CoroutineScope(Dispatchers.IO)
-    override suspend fun requestRecords(count: Int): Flow<List<SensorRecord>> {
+    @OptIn(ExperimentalTime::class)
+    override suspend fun requestRecords(range: Duration): Flow<List<SensorRecord>> {
         return flow {
             val records: MutableList<SensorRecord> = mutableListOf()
-            sample.slice(0..count.coerceAtMost(sample.lastIndex)).forEach {
+            sample.takeWhile { sample.first().date - it.date <= range }.forEach {
                 records.add(it)
                 delay(10)
                 emit(records)
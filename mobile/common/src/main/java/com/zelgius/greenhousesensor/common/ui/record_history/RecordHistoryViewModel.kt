@@ -9,6 +9,7 @@ import com.patrykandpatrick.vico.core.cartesian.data.lineSeries
 import com.patrykandpatrick.vico.core.common.data.ExtraStore
 import com.zelgius.greenhousesensor.common.usecases.GetRecordHistoryUseCase
 import com.zelgius.greenhousesensor.common.model.SensorRecord
+import com.zelgius.greenhousesensor.common.repository.RecordRepository
 import kotlinx.coroutines.flow.MutableStateFlow
 import kotlinx.coroutines.flow.asStateFlow
 import kotlinx.coroutines.launch
@@ -131,7 +132,8 @@ fun List<SensorRecord>.splitSeries(): List<List<SensorRecord>> {
     var currentRecord: SensorRecord? = null
 
     forEach {
-        if (currentRecord == null || currentRecord.date - it.date < 25.minutes) {
+        // Records are at most MAX_RECORD_INTERVAL apart while the sensor runs, a longer gap is an outage
+        if (currentRecord == null || currentRecord.date - it.date < RecordRepository.MAX_RECORD_INTERVAL + 5.minutes) {
             currentSerie.add(it)
         } else {
             series.add(currentSerie)
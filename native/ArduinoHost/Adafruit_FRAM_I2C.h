@@ -0,0 +1,44 @@
+#ifndef ADAFRUIT_FRAM_I2C_HOST_H
+#define ADAFRUIT_FRAM_I2C_HOST_H
+
+#include <Wire.h>
+
+#define HOST_FRAM_SIZE 32768
+
+/**
+ * RAM backed MB85RC256V. Contents survive as long as the object, like the chip survives MCU resets. Every transfer
+ * advances the host clock by its bus time (address byte, two memory address bytes and the data).
+ */
+class Adafruit_FRAM_I2C {
+public:
+    Adafruit_FRAM_I2C() { memset(_memory, 0, sizeof(_memory)); }
+
+    bool begin(uint8_t address = 0x50, TwoWire* wire = &Wire) { return true; }
+
+    bool write(uint16_t address, uint8_t value) { return write(address, &value, 1); }
+
+    uint8_t read(uint16_t address) {
+        uint8_t value = 0;
+        read(address, &value, 1);
+        return value;
+    }
+
+    bool write(uint16_t address, uint8_t* buffer, uint16_t length) {
+        if ((uint32_t) address + length > HOST_FRAM_SIZE) return false;
+        host::advanceMicros((3 + length) * I2C_BYTE_MICROS);
+        memcpy(_memory + address, buffer, length);
+        return true;
+    }
+
+    bool read(uint16_t address, uint8_t* buffer, uint16_t length) {
+        if ((uint32_t) address + length > HOST_FRAM_SIZE) return false;
+        host::advanceMicros((4 + length) * I2C_BYTE_MICROS);
+        memcpy(buffer, _memory + address, length);
+        return true;
+    }
+
+private:
+    uint8_t _memory[HOST_FRAM_SIZE];
+};
+
+#endif //ADAFRUIT_FRAM_I2C_HOST_H
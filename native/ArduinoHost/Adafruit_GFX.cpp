@@ -0,0 +1,94 @@
+#include "Adafruit_GFX.h"
+#include <utility>
+
+// Bresenham, as in the real library
+void Adafruit_GFX::writeLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color) {
+    const bool steep = abs(y1 - y0) > abs(x1 - x0);
+    if (steep) {
+        std::swap(x0, y0);
+        std::swap(x1, y1);
+    }
+    if (x0 > x1) {
+        std::swap(x0, x1);
+        std::swap(y0, y1);
+    }
+
+    const int16_t dx = x1 - x0;
+    const int16_t dy = abs(y1 - y0);
+    const int16_t yStep = y0 < y1 ? 1 : -1;
+    int16_t error = dx / 2;
+    for (; x0 <= x1; x0++) {
+        if (steep) {
+            writePixel(y0, x0, color);
+        } else {
+            writePixel(x0, y0, color);
+        }
+        error -= dy;
+        if (error < 0) {
+            y0 += yStep;
+            error += dx;
+        }
+    }
+}
+
+void Adafruit_GFX::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    startWrite();
+    for (int16_t row = y; row < y + h; ++row) {
+        for (int16_t column = x; column < x + w; ++column) {
+            writePixel(column, row, color);
+        }
+    }
+    endWrite();
+}
+
+void Adafruit_GFX::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+    startWrite();
+    writeLine(x, y, x, y + h - 1, color);
+    endWrite();
+}
+
+void Adafruit_GFX::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+    startWrite();
+    writeLine(x, y, x + w - 1, y, color);
+    endWrite();
+}
+
+void Adafruit_GFX::drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color) {
+    startWrite();
+    writeLine(x0, y0, x1, y1, color);
+    endWrite();
+}
+
+void Adafruit_GFX::drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg, uint8_t size) {
+    startWrite();
+    for (int8_t column = 0; column < 6; ++column) {
+        for (int8_t row = 0; row < 8; ++row) {
+            // Stand-in glyph: columns 0-4 hold a pattern derived from the character, column 5 is spacing
+            const bool on = column < 5 && c != ' ' && ((c * 7 + column * 3 + row * 5) % 4) == 0;
+            if (on || bg != color) {
+                const uint16_t pixelColor = on ? color : bg;
+                if (size == 1) {
+                    writePixel(x + column, y + row, pixelColor);
+                } else {
+                    writeFillRect(x + column * size, y + row * size, size, size, pixelColor);
+                }
+            }
+        }
+    }
+    endWrite();
+}
+
+size_t Adafruit_GFX::write(uint8_t c) {
+    if (c == '\n') {
+        _cursorX = 0;
+        _cursorY += 8 * _textSize;
+    } else if (c != '\r') {
+        if (_wrap && _cursorX + 6 * _textSize > _width) {
+            _cursorX = 0;
+            _cursorY += 8 * _textSize;
+        }
+        drawChar(_cursorX, _cursorY, c, _textColor, _textBackground, _textSize);
+        _cursorX += 6 * _textSize;
+    }
+    return 1;
+}
@@ -0,0 +1,58 @@
+#ifndef ADAFRUIT_GFX_HOST_H
+#define ADAFRUIT_GFX_HOST_H
+
+#include <Arduino.h>
+
+/**
+ * Adafruit_GFX for the native build. Same virtual structure as the real library: everything ends up in drawPixel()
+ * unless a subclass overrides the faster primitives, so a framebuffer fake only needs drawPixel() to see every
+ * pixel pushed. Characters use the classic 6x8 cell with a made up glyph pattern: pixel counts match the real
+ * font when a background color is given (the whole cell is drawn), shapes do not.
+ */
+class Adafruit_GFX : public Print {
+public:
+    Adafruit_GFX(int16_t w, int16_t h) : _width(w), _height(h) {}
+
+    virtual void drawPixel(int16_t x, int16_t y, uint16_t color) = 0;
+
+    virtual void startWrite() {}
+    virtual void endWrite() {}
+    virtual void writePixel(int16_t x, int16_t y, uint16_t color) { drawPixel(x, y, color); }
+    virtual void writeFillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) { fillRect(x, y, w, h, color); }
+    virtual void writeFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) { writeFillRect(x, y, 1, h, color); }
+    virtual void writeFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) { writeFillRect(x, y, w, 1, color); }
+    virtual void writeLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color);
+
+    virtual void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+    virtual void fillScreen(uint16_t color) { fillRect(0, 0, _width, _height, color); }
+    virtual void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color);
+    virtual void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color);
+    virtual void drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color);
+    virtual void setRotation(uint8_t rotation) {}
+
+    void drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg, uint8_t size);
+
+    size_t write(uint8_t c) override;
+    using Print::write;
+
+    void setCursor(int16_t x, int16_t y) { _cursorX = x; _cursorY = y; }
+    void setTextSize(uint8_t size) { _textSize = size > 0 ? size : 1; }
+    void setTextColor(uint16_t color) { _textColor = color; _textBackground = color; }
+    void setTextColor(uint16_t color, uint16_t background) { _textColor = color; _textBackground = background; }
+    void setTextWrap(bool wrap) { _wrap = wrap; }
+
+    [[nodiscard]] int16_t width() const { return _width; }
+    [[nodiscard]] int16_t height() const { return _height; }
+
+protected:
+    int16_t _width;
+    int16_t _height;
+    int16_t _cursorX = 0;
+    int16_t _cursorY = 0;
+    uint16_t _textColor = 0xFFFF;
+    uint16_t _textBackground = 0xFFFF;
+    uint8_t _textSize = 1;
+    bool _wrap = true;
+};
+
+#endif //ADAFRUIT_GFX_HOST_H
@@ -0,0 +1,31 @@
+#ifndef ADAFRUIT_ST7789_HOST_H
+#define ADAFRUIT_ST7789_HOST_H
+
+#include <Adafruit_GFX.h>
+
+#define ST77XX_BLACK 0x0000
+#define ST77XX_WHITE 0xFFFF
+#define ST77XX_RED 0xF800
+#define ST77XX_GREEN 0x07E0
+#define ST77XX_BLUE 0x001F
+#define ST77XX_CYAN 0x07FF
+#define ST77XX_MAGENTA 0xF81F
+#define ST77XX_YELLOW 0xFFE0
+#define ST77XX_ORANGE 0xFC00
+
+// Panel without a screen: pixels are accepted and dropped
+class Adafruit_ST7789 : public Adafruit_GFX {
+public:
+    Adafruit_ST7789(int8_t cs, int8_t dc, int8_t rst) : Adafruit_GFX(240, 320) {}
+
+    void init(uint16_t width, uint16_t height, uint8_t spiMode = 0) {
+        _width = width;
+        _height = height;
+    }
+
+    void setSPISpeed(uint32_t frequency) {}
+
+    void drawPixel(int16_t x, int16_t y, uint16_t color) override {}
+};
+
+#endif //ADAFRUIT_ST7789_HOST_H
@@ -0,0 +1,108 @@
+#include "Arduino.h"
+
+HardwareSerial Serial;
+EspClass ESP;
+
+static uint64_t clockMicros = 0;
+
+uint64_t host::nowMicros() {
+    return clockMicros;
+}
+
+void host::advanceMicros(uint64_t micros) {
+    clockMicros += micros;
+}
+
+void host::resetClock() {
+    clockMicros = 0;
+}
+
+unsigned long millis() {
+    return (unsigned long) (uint32_t) (clockMicros / 1000);
+}
+
+unsigned long micros() {
+    return (unsigned long) (uint32_t) clockMicros;
+}
+
+void delay(unsigned long ms) {
+    clockMicros += (uint64_t) ms * 1000;
+}
+
+void delayMicroseconds(unsigned int us) {
+    clockMicros += us;
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+}
+
+void rgbLedWrite(uint8_t pin, uint8_t red, uint8_t green, uint8_t blue) {
+}
+
+// 240 MHz core running on the simulated clock
+uint32_t EspClass::getCycleCount() {
+    return (uint32_t) (clockMicros * 240);
+}
+
+size_t Print::write(const uint8_t *buffer, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+        write(buffer[i]);
+    }
+    return size;
+}
+
+size_t Print::print(const char *text) {
+    return write(reinterpret_cast<const uint8_t *>(text), strlen(text));
+}
+
+size_t Print::print(long value, int base) {
+    if (base != HEX) {
+        char text[24];
+        snprintf(text, sizeof(text), "%ld", value);
+        return print(text);
+    }
+    return print((unsigned long) value, base);
+}
+
+size_t Print::print(unsigned long value, int base) {
+    char text[24];
+    snprintf(text, sizeof(text), base == HEX ? "%lX" : "%lu", value);
+    return print(text);
+}
+
+size_t Print::print(double value, int digits) {
+    char text[48];
+    snprintf(text, sizeof(text), "%.*f", digits, value);
+    return print(text);
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+    if (!_muted) {
+        fputc(c, stdout);
+    }
+    return 1;
+}
+
+size_t HardwareSerial::write(const uint8_t *buffer, size_t size) {
+    if (!_muted) {
+        fwrite(buffer, 1, size, stdout);
+    }
+    return size;
+}
+
+int HardwareSerial::available() {
+    return (int) _input.size();
+}
+
+int HardwareSerial::read() {
+    if (_input.empty()) {
+        return -1;
+    }
+    const int c = (uint8_t) _input[0];
+    _input.erase(0, 1);
+    return c;
+}
+
+void HardwareSerial::feed(const char *input) {
+    _input += input;
+}
@@ -0,0 +1,108 @@
+#ifndef ARDUINO_HOST_H
+#define ARDUINO_HOST_H
+
+// Minimal Arduino-ESP32 API for the native build. Only what the firmware uses is provided.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+#include <string>
+#include "HostClock.h"
+
+#define ARDUINO 10819
+
+#define HEX 16
+#define DEC 10
+#define OUTPUT 0x03
+#define BUILTIN_LED 8
+
+// No separate program memory on the host
+#define PSTR(s) (s)
+#define snprintf_P snprintf
+
+class String {
+public:
+    String() = default;
+    String(const char* text) : _text(text != nullptr ? text : "") {}
+    String(const char* data, unsigned int length) : _text(data, length) {}
+    String(const uint8_t* data, unsigned int length) : _text((const char*) data, length) {}
+
+    [[nodiscard]] size_t length() const { return _text.size(); }
+    [[nodiscard]] const char* c_str() const { return _text.c_str(); }
+    [[nodiscard]] char charAt(size_t index) const { return _text[index]; }
+    void reserve(size_t size) { _text.reserve(size); }
+    String& operator+=(char c) { _text += c; return *this; }
+
+private:
+    std::string _text;
+};
+
+class Print {
+public:
+    virtual ~Print() = default;
+
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* buffer, size_t size);
+
+    size_t print(const char* text);
+    size_t print(const String& text) { return print(text.c_str()); }
+    size_t print(char c) { return write((uint8_t) c); }
+    size_t print(int value, int base = DEC) { return print((long) value, base); }
+    size_t print(unsigned value, int base = DEC) { return print((unsigned long) value, base); }
+    size_t print(long value, int base = DEC);
+    size_t print(unsigned long value, int base = DEC);
+    size_t print(double value, int digits = 2);
+
+    size_t println() { return print("\r\n"); }
+    template<typename T>
+    size_t println(T value) { const size_t n = print(value); return n + println(); }
+    template<typename T>
+    size_t println(T value, int format) { const size_t n = print(value, format); return n + println(); }
+};
+
+/**
+ * Serial console. Output goes to stdout unless muted (benchmarks), input is whatever was queued with feed().
+ */
+class HardwareSerial : public Print {
+public:
+    void begin(unsigned long baud) {}
+    explicit operator bool() const { return true; }
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+    int available();
+    int read();
+
+    void mute(bool muted) { _muted = muted; }
+    void feed(const char* input);
+
+private:
+    bool _muted = false;
+    std::string _input;
+};
+
+extern HardwareSerial Serial;
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void pinMode(uint8_t pin, uint8_t mode);
+void rgbLedWrite(uint8_t pin, uint8_t red, uint8_t green, uint8_t blue);
+
+class EspClass {
+public:
+    uint32_t getCycleCount();
+    uint32_t getCpuFreqMHz() { return 240; }
+    uint32_t getFreeHeap() { return 0; }
+    uint32_t getMinFreeHeap() { return 0; }
+    uint32_t getMaxAllocHeap() { return 0; }
+};
+
+extern EspClass ESP;
+
+inline const char* pcTaskGetName(void* task) { return "host"; }
+
+#endif //ARDUINO_HOST_H
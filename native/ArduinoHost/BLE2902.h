@@ -0,0 +1,10 @@
+#ifndef BLE2902_HOST_H
+#define BLE2902_HOST_H
+
+#include "BLEDevice.h"
+
+// Client Characteristic Configuration descriptor, subscriptions are kept by FakeGattClient
+class BLE2902 : public BLEDescriptor {
+};
+
+#endif //BLE2902_HOST_H
@@ -0,0 +1,243 @@
+#include "BLEDevice.h"
+#include "FakeGattClient.h"
+#include "esp_gap_ble_api.h"
+#include <algorithm>
+#include <cstring>
+
+static BLEServer* hostServer = nullptr;
+static BLEAdvertising* hostAdvertising = nullptr;
+
+BLECharacteristic::BLECharacteristic(const char* uuid, uint32_t properties, BLEServer* server)
+    : _uuid(uuid), _properties(properties), _server(server) {
+}
+
+BLECharacteristic::~BLECharacteristic() {
+    for (BLEDescriptor* descriptor: _descriptors) {
+        delete descriptor;
+    }
+}
+
+void BLECharacteristic::setValue(uint8_t* data, size_t length) {
+    _value.assign(data, data + (data == nullptr ? 0 : length));
+}
+
+void BLECharacteristic::notify(bool isNotification) {
+    _server->deliverNotification(this);
+}
+
+void BLECharacteristic::handleWrite(uint16_t connId, const uint8_t* data, size_t length) {
+    // Like the ESP32 library: the value is updated before the callback sees it
+    _value.assign(data, data + length);
+    esp_ble_gatts_cb_param_t param{};
+    param.write.conn_id = connId;
+    param.write.len = length;
+    param.write.value = _value.data();
+    if (_callbacks != nullptr) {
+        _callbacks->onWrite(this, &param);
+    }
+}
+
+size_t BLECharacteristic::handleRead(uint16_t connId, uint8_t* buffer, size_t capacity) {
+    esp_ble_gatts_cb_param_t param{};
+    param.read.conn_id = connId;
+    if (_callbacks != nullptr) {
+        _callbacks->onRead(this, &param);
+    }
+    const size_t length = std::min(_value.size(), capacity);
+    memcpy(buffer, _value.data(), length);
+    return length;
+}
+
+BLEService::~BLEService() {
+    for (BLECharacteristic* characteristic: _characteristics) {
+        delete characteristic;
+    }
+}
+
+BLECharacteristic* BLEService::createCharacteristic(const char* uuid, uint32_t properties) {
+    _characteristics.push_back(new BLECharacteristic(uuid, properties, _server));
+    return _characteristics.back();
+}
+
+BLECharacteristic* BLEService::getCharacteristic(const char* uuid) {
+    for (BLECharacteristic* characteristic: _characteristics) {
+        if (characteristic->uuid() == uuid) {
+            return characteristic;
+        }
+    }
+    return nullptr;
+}
+
+BLEServer::~BLEServer() {
+    for (BLEService* service: _services) {
+        delete service;
+    }
+}
+
+BLEService* BLEServer::createService(const char* uuid) {
+    _services.push_back(new BLEService(this));
+    return _services.back();
+}
+
+void BLEServer::startAdvertising() {
+    BLEDevice::startAdvertising();
+}
+
+uint16_t BLEServer::getPeerMTU(uint16_t connId) {
+    for (const Connection& connection: _connections) {
+        if (connection.connId == connId) {
+            return connection.client->getMtu();
+        }
+    }
+    return 0;
+}
+
+size_t BLEServer::getConnectedCount() const {
+    return _connections.size();
+}
+
+bool BLEServer::connect(FakeGattClient* client, uint16_t& connId) {
+    BLEAdvertising* advertising = BLEDevice::getAdvertising();
+    if (_connections.size() >= HOST_BLE_MAX_CONNECTIONS || !advertising->isAdvertising()) {
+        return false;
+    }
+    advertising->stop();
+    connId = _nextConnId++;
+    _connections.push_back({client, connId});
+    esp_ble_gatts_cb_param_t param{};
+    param.connect.conn_id = connId;
+    if (_callbacks != nullptr) {
+        _callbacks->onConnect(this, &param);
+    }
+    return true;
+}
+
+void BLEServer::disconnect(uint16_t connId) {
+    const auto connection = std::find_if(_connections.begin(), _connections.end(),
+                                         [connId](const Connection& c) { return c.connId == connId; });
+    if (connection == _connections.end()) {
+        return;
+    }
+    _connections.erase(connection);
+    esp_ble_gatts_cb_param_t param{};
+    param.disconnect.conn_id = connId;
+    if (_callbacks != nullptr) {
+        _callbacks->onDisconnect(this, &param);
+    }
+}
+
+BLECharacteristic* BLEServer::findCharacteristic(const char* uuid) {
+    for (BLEService* service: _services) {
+        BLECharacteristic* characteristic = service->getCharacteristic(uuid);
+        if (characteristic != nullptr) {
+            return characteristic;
+        }
+    }
+    return nullptr;
+}
+
+void BLEServer::deliverNotification(BLECharacteristic* characteristic) {
+    for (const Connection& connection: _connections) {
+        if (connection.client->isSubscribed()) {
+            // Notifications are truncated to the MTU like any unsegmented ATT PDU
+            const size_t length = std::min<size_t>(characteristic->getLength(), connection.client->getMtu() - 3);
+            connection.client->receiveNotification(characteristic->getData(), length);
+        }
+    }
+}
+
+void BLEDevice::init(const String& deviceName) {
+    delete hostServer;
+    hostServer = nullptr;
+    delete hostAdvertising;
+    hostAdvertising = new BLEAdvertising();
+}
+
+BLEServer* BLEDevice::createServer() {
+    delete hostServer;
+    hostServer = new BLEServer();
+    return hostServer;
+}
+
+BLEAdvertising* BLEDevice::getAdvertising() {
+    if (hostAdvertising == nullptr) {
+        hostAdvertising = new BLEAdvertising();
+    }
+    return hostAdvertising;
+}
+
+void BLEDevice::startAdvertising() {
+    getAdvertising()->start();
+}
+
+BLEServer* BLEDevice::getServer() {
+    return hostServer;
+}
+
+BLEUUID::BLEUUID(const String& uuid) : _uuid() {
+    // From the last hex digit: the last byte of the string form is the first one over the air
+    const char* text = uuid.c_str();
+    size_t byte = 0;
+    for (int i = (int) uuid.length() - 1; i > 0 && byte < sizeof(_uuid); --i) {
+        if (text[i] == '-') {
+            continue;
+        }
+        const char hex[3] = {text[i - 1], text[i], '\0'};
+        _uuid[byte++] = strtoul(hex, nullptr, 16);
+        --i;
+    }
+}
+
+void BLEAdvertisementData::setFlags(uint8_t flags) {
+    addStructure(ESP_BLE_AD_TYPE_FLAG, (const char*) &flags, 1);
+}
+
+void BLEAdvertisementData::setCompleteServices(const BLEUUID& uuid) {
+    addStructure(ESP_BLE_AD_TYPE_128SRV_CMPL, (const char*) uuid.data(), uuid.bitSize() / 8);
+}
+
+void BLEAdvertisementData::setManufacturerData(const String& data) {
+    addStructure(ESP_BLE_AD_MANUFACTURER_SPECIFIC_TYPE, data.c_str(), data.length());
+}
+
+void BLEAdvertisementData::setName(const String& name) {
+    addStructure(ESP_BLE_AD_TYPE_NAME_CMPL, name.c_str(), name.length());
+}
+
+void BLEAdvertisementData::setShortName(const String& name) {
+    addStructure(ESP_BLE_AD_TYPE_NAME_SHORT, name.c_str(), name.length());
+}
+
+void BLEAdvertisementData::addData(const char* data, size_t length) {
+    if (_payload.size() + length <= ESP_BLE_ADV_DATA_LEN_MAX) {
+        _payload.append(data, length);
+    }
+}
+
+void BLEAdvertisementData::addStructure(uint8_t type, const char* data, size_t length) {
+    std::string structure;
+    structure += (char) (length + 1);
+    structure += (char) type;
+    structure.append(data, length);
+    addData(structure.data(), structure.size());
+}
+
+void BLEAdvertising::setAdvertisementData(BLEAdvertisementData& data) {
+    const String payload = data.getPayload();
+    setRawPayload((const uint8_t*) payload.c_str(), payload.length());
+}
+
+void BLEAdvertising::setScanResponseData(BLEAdvertisementData& data) {
+    const String payload = data.getPayload();
+    setRawScanResponse((const uint8_t*) payload.c_str(), payload.length());
+}
+
+esp_err_t esp_ble_gap_config_adv_data_raw(uint8_t* raw_data, uint32_t raw_data_len) {
+    BLEDevice::getAdvertising()->setRawPayload(raw_data, raw_data_len);
+    return ESP_OK;
+}
+
+esp_err_t esp_ble_gap_config_scan_rsp_data_raw(uint8_t* raw_data, uint32_t raw_data_len) {
+    BLEDevice::getAdvertising()->setRawScanResponse(raw_data, raw_data_len);
+    return ESP_OK;
+}
@@ -0,0 +1,207 @@
+#ifndef BLEDEVICE_HOST_H
+#define BLEDEVICE_HOST_H
+
+// ESP32 BLE Arduino API for the native build: a GATT server whose peers are FakeGattClients. Callbacks run
+// synchronously in the caller of the client operation, which plays the part of the BLE stack task.
+
+#include <Arduino.h>
+#include <string>
+#include <vector>
+
+#define HOST_BLE_MAX_CONNECTIONS 9 // CONFIG_BT_ACL_CONNECTIONS upper bound
+
+typedef union {
+    struct {
+        uint16_t conn_id;
+    } connect;
+    struct {
+        uint16_t conn_id;
+    } disconnect;
+    struct {
+        uint16_t conn_id;
+        uint16_t handle;
+        uint16_t offset;
+    } read;
+    struct {
+        uint16_t conn_id;
+        uint16_t handle;
+        uint16_t len;
+        uint8_t* value;
+    } write;
+    struct {
+        uint16_t conn_id;
+        uint16_t mtu;
+    } mtu;
+} esp_ble_gatts_cb_param_t;
+
+class BLEServer;
+class BLECharacteristic;
+class FakeGattClient;
+
+class BLEDescriptor {
+public:
+    virtual ~BLEDescriptor() = default;
+};
+
+class BLECharacteristicCallbacks {
+public:
+    virtual ~BLECharacteristicCallbacks() = default;
+    virtual void onRead(BLECharacteristic* characteristic, esp_ble_gatts_cb_param_t* param) {}
+    virtual void onWrite(BLECharacteristic* characteristic, esp_ble_gatts_cb_param_t* param) {}
+};
+
+class BLECharacteristic {
+public:
+    static const uint32_t PROPERTY_READ = 1 << 0;
+    static const uint32_t PROPERTY_WRITE = 1 << 1;
+    static const uint32_t PROPERTY_NOTIFY = 1 << 2;
+    static const uint32_t PROPERTY_BROADCAST = 1 << 3;
+    static const uint32_t PROPERTY_INDICATE = 1 << 4;
+    static const uint32_t PROPERTY_WRITE_NR = 1 << 5;
+
+    BLECharacteristic(const char* uuid, uint32_t properties, BLEServer* server);
+    ~BLECharacteristic();
+
+    void setCallbacks(BLECharacteristicCallbacks* callbacks) { _callbacks = callbacks; }
+    void setValue(uint8_t* data, size_t length);
+    uint8_t* getData() { return _value.data(); }
+    size_t getLength() const { return _value.size(); }
+    void notify(bool isNotification = true);
+    void addDescriptor(BLEDescriptor* descriptor) { _descriptors.push_back(descriptor); }
+
+    // Host side, called by FakeGattClient
+    [[nodiscard]] const std::string& uuid() const { return _uuid; }
+    [[nodiscard]] uint32_t properties() const { return _properties; }
+    void handleWrite(uint16_t connId, const uint8_t* data, size_t length);
+    size_t handleRead(uint16_t connId, uint8_t* buffer, size_t capacity);
+
+private:
+    std::string _uuid;
+    uint32_t _properties;
+    BLEServer* _server;
+    BLECharacteristicCallbacks* _callbacks = nullptr;
+    std::vector<uint8_t> _value;
+    std::vector<BLEDescriptor*> _descriptors;
+};
+
+class BLEService {
+public:
+    explicit BLEService(BLEServer* server) : _server(server) {}
+    ~BLEService();
+
+    BLECharacteristic* createCharacteristic(const char* uuid, uint32_t properties);
+    void start() {}
+
+    // Host side
+    BLECharacteristic* getCharacteristic(const char* uuid);
+
+private:
+    BLEServer* _server;
+    std::vector<BLECharacteristic*> _characteristics;
+};
+
+class BLEServerCallbacks {
+public:
+    virtual ~BLEServerCallbacks() = default;
+    virtual void onConnect(BLEServer* server, esp_ble_gatts_cb_param_t* param) {}
+    virtual void onDisconnect(BLEServer* server, esp_ble_gatts_cb_param_t* param) {}
+};
+
+class BLEServer {
+public:
+    ~BLEServer();
+
+    void setCallbacks(BLEServerCallbacks* callbacks) { _callbacks = callbacks; }
+    BLEService* createService(const char* uuid);
+    void startAdvertising();
+    uint16_t getPeerMTU(uint16_t connId);
+    size_t getConnectedCount() const;
+
+    // Host side, called by FakeGattClient. Centrals only connect to an advertising server, and the controller stops
+    // advertising when one does
+    bool connect(FakeGattClient* client, uint16_t& connId);
+    void disconnect(uint16_t connId);
+    BLECharacteristic* findCharacteristic(const char* uuid);
+    void deliverNotification(BLECharacteristic* characteristic);
+
+private:
+    struct Connection {
+        FakeGattClient* client;
+        uint16_t connId;
+    };
+
+    BLEServerCallbacks* _callbacks = nullptr;
+    std::vector<BLEService*> _services;
+    std::vector<Connection> _connections;
+    uint16_t _nextConnId = 0;
+};
+
+class BLEUUID {
+public:
+    // 128-bit UUIDs in their string form, stored little-endian like esp_bt_uuid_t
+    explicit BLEUUID(const String& uuid);
+
+    [[nodiscard]] uint8_t bitSize() const { return 128; }
+    [[nodiscard]] const uint8_t* data() const { return _uuid; }
+
+private:
+    uint8_t _uuid[16];
+};
+
+/**
+ * AD structures of an advertisement or scan response. Like the ESP32 library, a structure that would overflow the
+ * ESP_BLE_ADV_DATA_LEN_MAX bytes of a legacy payload is dropped.
+ */
+class BLEAdvertisementData {
+public:
+    void setFlags(uint8_t flags);
+    void setCompleteServices(const BLEUUID& uuid);
+    void setManufacturerData(const String& data);
+    void setName(const String& name);
+    void setShortName(const String& name);
+    void addData(const char* data, size_t length);
+
+    [[nodiscard]] String getPayload() const { return String(_payload.data(), _payload.size()); }
+
+private:
+    std::string _payload;
+
+    void addStructure(uint8_t type, const char* data, size_t length);
+};
+
+class BLEAdvertising {
+public:
+    void addServiceUUID(const char* uuid) {}
+    void setScanResponse(bool enabled) {}
+    void setMinPreferred(uint16_t interval) {}
+    void setMaxPreferred(uint16_t interval) {}
+    void setAdvertisementData(BLEAdvertisementData& data);
+    void setScanResponseData(BLEAdvertisementData& data);
+    void start() { _advertising = true; }
+    void stop() { _advertising = false; }
+
+    // Host side: what scanners see
+    [[nodiscard]] bool isAdvertising() const { return _advertising; }
+    [[nodiscard]] const std::vector<uint8_t>& getPayload() const { return _payload; }
+    [[nodiscard]] const std::vector<uint8_t>& getScanResponse() const { return _scanResponse; }
+    void setRawPayload(const uint8_t* data, size_t length) { _payload.assign(data, data + length); }
+    void setRawScanResponse(const uint8_t* data, size_t length) { _scanResponse.assign(data, data + length); }
+
+private:
+    bool _advertising = false;
+    std::vector<uint8_t> _payload;
+    std::vector<uint8_t> _scanResponse;
+};
+
+class BLEDevice {
+public:
+    static void init(const String& deviceName);
+    static BLEServer* createServer();
+    static BLEAdvertising* getAdvertising();
+    static void startAdvertising();
+
+    // Host side: the server clients connect to
+    static BLEServer* getServer();
+};
+
+#endif //BLEDEVICE_HOST_H
@@ -0,0 +1,6 @@
+#ifndef BLESERVER_HOST_H
+#define BLESERVER_HOST_H
+
+#include "BLEDevice.h"
+
+#endif //BLESERVER_HOST_H
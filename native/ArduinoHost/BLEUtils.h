@@ -0,0 +1,6 @@
+#ifndef BLEUTILS_HOST_H
+#define BLEUTILS_HOST_H
+
+#include "BLEDevice.h"
+
+#endif //BLEUTILS_HOST_H
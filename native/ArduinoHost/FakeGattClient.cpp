@@ -0,0 +1,121 @@
+#include "FakeGattClient.h"
+#include "HostClock.h"
+
+// ATT PDU sizes: opcode and handle before the value of requests and notifications, opcode before responses
+#define ATT_REQUEST_HEADER  3
+#define ATT_RESPONSE_HEADER 1
+
+FakeGattClient::FakeGattClient(uint16_t mtu, uint32_t connectionIntervalMicros, uint32_t operationLatencyMicros)
+    : _mtu(mtu),
+      _connectionInterval(connectionIntervalMicros),
+      _operationLatency(operationLatencyMicros),
+      _anchor(0),
+      _lastEvent(0),
+      _roundTrips(0),
+      _bytesOnAir(0),
+      _connected(false),
+      _connId(0),
+      _subscribed(false),
+      _notifications(0),
+      _lastNotification() {
+}
+
+FakeGattClient::~FakeGattClient() {
+    disconnect();
+}
+
+bool FakeGattClient::connect() {
+    BLEServer* server = BLEDevice::getServer();
+    if (_connected || server == nullptr) {
+        return false;
+    }
+    _connected = server->connect(this, _connId);
+    _anchor = host::nowMicros();
+    _lastEvent = _anchor;
+    resetStats();
+    return _connected;
+}
+
+void FakeGattClient::disconnect() {
+    if (!_connected) {
+        return;
+    }
+    _connected = false;
+    _subscribed = false;
+    BLEServer* server = BLEDevice::getServer();
+    if (server != nullptr) {
+        server->disconnect(_connId);
+    }
+}
+
+void FakeGattClient::resetStats() {
+    _roundTrips = 0;
+    _bytesOnAir = 0;
+}
+
+bool FakeGattClient::write(const char* uuid, const uint8_t* data, size_t length) {
+    BLECharacteristic* characteristic = _connected ? BLEDevice::getServer()->findCharacteristic(uuid) : nullptr;
+    if (characteristic == nullptr || length > (size_t) _mtu - 3) {
+        return false;
+    }
+    sendRequest(ATT_REQUEST_HEADER + length);
+    characteristic->handleWrite(_connId, data, length);
+    receiveResponse(ATT_RESPONSE_HEADER);
+    return true;
+}
+
+size_t FakeGattClient::read(const char* uuid, uint8_t* buffer, size_t capacity) {
+    BLECharacteristic* characteristic = _connected ? BLEDevice::getServer()->findCharacteristic(uuid) : nullptr;
+    if (characteristic == nullptr) {
+        return 0;
+    }
+    const size_t attCapacity = (size_t) _mtu - 1;
+    sendRequest(ATT_REQUEST_HEADER);
+    const size_t length = characteristic->handleRead(_connId, buffer, capacity < attCapacity ? capacity : attCapacity);
+    receiveResponse(ATT_RESPONSE_HEADER + length);
+    return length;
+}
+
+void FakeGattClient::receiveNotification(const uint8_t* data, size_t length) {
+    _notifications++;
+    _lastNotification.assign(data, data + length);
+    transmit(ATT_REQUEST_HEADER + length);
+}
+
+void FakeGattClient::sendRequest(size_t attLength) {
+    if (_connectionInterval > 0) {
+        host::advanceMicros(_operationLatency);
+    }
+    waitForConnectionEvent();
+    transmit(attLength);
+}
+
+void FakeGattClient::receiveResponse(size_t attLength) {
+    // The server answers once the callback returned, in a later connection event than the request
+    waitForConnectionEvent();
+    transmit(attLength);
+    _roundTrips++;
+}
+
+void FakeGattClient::waitForConnectionEvent() {
+    if (_connectionInterval == 0) {
+        return;
+    }
+    const uint64_t now = host::nowMicros();
+    uint64_t event = _anchor + (now - _anchor + _connectionInterval - 1) / _connectionInterval * _connectionInterval;
+    if (event <= _lastEvent) {
+        event = _lastEvent + _connectionInterval;
+    }
+    host::advanceMicros(event - now);
+    _lastEvent = event;
+}
+
+void FakeGattClient::transmit(size_t attLength) {
+    const size_t l2cap = BLE_L2CAP_HEADER + attLength;
+    const size_t packets = (l2cap + BLE_LL_MAX_PAYLOAD - 1) / BLE_LL_MAX_PAYLOAD;
+    const size_t bytes = l2cap + packets * BLE_LL_PACKET_OVERHEAD;
+    _bytesOnAir += bytes;
+    if (_connectionInterval > 0) {
+        host::advanceMicros(bytes * BLE_AIR_MICROS_PER_BYTE + packets * BLE_INTER_FRAME_MICROS);
+    }
+}
@@ -0,0 +1,85 @@
+#ifndef FAKEGATTCLIENT_H
+#define FAKEGATTCLIENT_H
+
+#include <BLEDevice.h>
+
+#define ATT_DEFAULT_MTU 23
+
+// Radio model of the timed clients, LE 1M PHY without data length extension
+#define BLE_LL_MAX_PAYLOAD      27  // Bytes of L2CAP data per link layer packet
+#define BLE_LL_PACKET_OVERHEAD  10  // Preamble, access address, header and CRC
+#define BLE_L2CAP_HEADER        4
+#define BLE_AIR_MICROS_PER_BYTE 8
+#define BLE_INTER_FRAME_MICROS  150 // Between a packet and the peer's reply in the same connection event
+
+/**
+ * Central connected to the host GATT server (BLEDevice::getServer()). Every operation runs the server callbacks
+ * synchronously, like the ESP32 BLE task would when the request reaches the device.
+ *
+ * With a connection interval the client also advances the host clock as a real link would: a request waits for the
+ * next connection event and its response for the one after it, packets take their air time, and the central adds
+ * its own latency (OS and app) before every operation. Round trips and bytes on air are counted, which makes sync
+ * protocols comparable in simulated time.
+ */
+class FakeGattClient {
+public:
+    /**
+     * @param mtu ATT MTU negotiated for the connection.
+     * @param connectionIntervalMicros Connection interval, 0 for an untimed client (callbacks only).
+     * @param operationLatencyMicros Delay of the central before each request.
+     */
+    explicit FakeGattClient(uint16_t mtu = ATT_DEFAULT_MTU, uint32_t connectionIntervalMicros = 0,
+                            uint32_t operationLatencyMicros = 0);
+    ~FakeGattClient();
+
+    bool connect();
+    void disconnect();
+    [[nodiscard]] bool isConnected() const { return _connected; }
+    [[nodiscard]] uint16_t getConnId() const { return _connId; }
+    [[nodiscard]] uint16_t getMtu() const { return _mtu; }
+
+    // ATT request/response pairs and link layer bytes (both directions) since connect() or resetStats()
+    [[nodiscard]] uint32_t getRoundTrips() const { return _roundTrips; }
+    [[nodiscard]] uint32_t getBytesOnAir() const { return _bytesOnAir; }
+    void resetStats();
+
+    /**
+     * @brief ATT write request.
+     * @return False if not connected or the characteristic does not exist.
+     */
+    bool write(const char* uuid, const uint8_t* data, size_t length);
+
+    /**
+     * @brief ATT read request, answered with at most MTU - 1 bytes.
+     * @return Bytes placed in buffer.
+     */
+    size_t read(const char* uuid, uint8_t* buffer, size_t capacity);
+
+    // Notifications are received once subscribed, the last one is kept
+    void subscribe() { _subscribed = true; }
+    [[nodiscard]] bool isSubscribed() const { return _subscribed; }
+    void receiveNotification(const uint8_t* data, size_t length);
+    [[nodiscard]] uint32_t getNotificationCount() const { return _notifications; }
+    [[nodiscard]] const std::vector<uint8_t>& getLastNotification() const { return _lastNotification; }
+
+private:
+    uint16_t _mtu;
+    uint32_t _connectionInterval;
+    uint32_t _operationLatency;
+    uint64_t _anchor;    // First connection event
+    uint64_t _lastEvent; // Connection event of the last packet sent
+    uint32_t _roundTrips;
+    uint32_t _bytesOnAir;
+    bool _connected;
+    uint16_t _connId;
+    bool _subscribed;
+    uint32_t _notifications;
+    std::vector<uint8_t> _lastNotification;
+
+    void sendRequest(size_t attLength);
+    void receiveResponse(size_t attLength);
+    void waitForConnectionEvent();
+    void transmit(size_t attLength);
+};
+
+#endif //FAKEGATTCLIENT_H
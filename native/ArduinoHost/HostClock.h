@@ -0,0 +1,22 @@
+#ifndef HOSTCLOCK_H
+#define HOSTCLOCK_H
+
+#include <stdint.h>
+
+/**
+ * Simulated time of the native build. Nothing runs in real time: millis(), micros() and the RTC read this clock,
+ * delay() and modelled bus transfers advance it. A loop() that sleeps until its next deadline therefore jumps
+ * straight to it, which turns the firmware into a discrete-event simulation.
+ */
+namespace host {
+
+    uint64_t nowMicros();
+
+    void advanceMicros(uint64_t micros);
+
+    // Back to t = 0, for tests that need independent runs in one process
+    void resetClock();
+
+}
+
+#endif //HOSTCLOCK_H
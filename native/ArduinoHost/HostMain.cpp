@@ -0,0 +1,261 @@
+// Entry point of `pio run -e native`: the firmware of src/main.cpp running against simulated peripherals, as a
+// discrete-event simulation (see HostClock.h). Usage: program [hours] [--devices N], one simulated day of one
+// device by default.
+//
+// Only linked when nothing else defines main(): unit tests keep their own.
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <esp_partition.h>
+#include <esp_system.h>
+#include <BleSensorServer.h>
+#include <FramStorage.h>
+#include <Sht3xSensor.h>
+#include "FakeGattClient.h"
+#include "SimDs3231.h"
+#include "SimSht3x.h"
+#ifdef RECORD_STORE_FLASH_PARTITION
+#include <FlashRecordStore.h>
+#else
+#include <FramRecordStore.h>
+#endif
+
+void setup();
+void loop();
+
+// Globals of src/main.cpp read back for the report
+extern FramStorage fram;
+#ifdef RECORD_STORE_FLASH_PARTITION
+extern FlashRecordStore records;
+#else
+extern FramRecordStore records;
+#endif
+
+#define SIM_DEFAULT_HOURS           24
+#define SIM_SHT_OSCILLATOR_ERROR    0.02f // Within the ±5% of the datasheet, conversions drift against millis()
+#define SIM_RTC_DRIFT_PPM           2.0f
+#define SIM_PHONE_SYNC_SECONDS      (30 * 60)
+#define SIM_WATCH_POLL_SECONDS      (5 * 60)
+#define SIM_PHONE_MTU               185
+#define SIM_PHONE_INTERVAL_MICROS   30000 // Android's balanced connection priority
+#define SIM_PHONE_LATENCY_MICROS    2000  // Per GATT operation, OS queue and app
+#define SIM_RECORD_PARTITION_SIZE   0x1F0000 // As in partitions.csv
+#define SIM_RECORD_PARTITION_FILE   "records-%u.bin" // One per device, kept between runs
+#define SIM_MAX_DEVICES             256
+
+// Greenhouse day: diurnal cycle, with the values the sensor sees at any simulated time
+static void greenhouse(uint64_t micros, float &temperature, float &humidity) {
+    const double seconds = micros / 1e6;
+    const double day = fmod(seconds, 86400.0) / 86400.0;
+    temperature = (float) (18.0 + 6.0 * sin(2 * M_PI * (day - 0.3)) + 0.05 * sin(seconds / 7.0));
+    humidity = (float) (70.0 - 15.0 * sin(2 * M_PI * (day - 0.3)) + 0.3 * sin(seconds / 11.0));
+}
+
+struct SimSyncStats {
+    uint32_t syncs;
+    uint32_t records;
+    uint32_t newestTimestamp;
+    uint64_t totalMicros;
+    uint64_t maxMicros;
+};
+
+// Newest first batches until the previously synced record is reached, like the app does, over a timed link
+static void syncPhone(SimSyncStats &stats) {
+    const uint64_t start = host::nowMicros();
+    FakeGattClient phone(SIM_PHONE_MTU, SIM_PHONE_INTERVAL_MICROS, SIM_PHONE_LATENCY_MICROS);
+    if (!phone.connect()) {
+        return;
+    }
+    uint32_t newest = stats.newestTimestamp;
+    uint16_t offset = 0;
+    bool done = false;
+    while (!done) {
+        uint8_t request[BatchRequestSchema::size];
+        BatchRequestSchema::encode(request, REQUEST_BATCH_OPCODE, offset, BATCH_MAX_RECORDS);
+        phone.write(RECORD_REQUEST_CHARACTERISTIC_UUID, request, sizeof(request));
+        uint8_t response[BLUETOOTH_RESPONSE_MAX_SIZE];
+        const size_t length = phone.read(RECORD_DATA_CHARACTERISTIC_UUID, response, sizeof(response));
+        done = length < BLUETOOTH_RECORD_SIZE;
+        for (size_t i = 0; i + BLUETOOTH_RECORD_SIZE <= length; i += BLUETOOTH_RECORD_SIZE) {
+            const uint32_t timestamp = BluetoothRecordSchema::get<BT_TIMESTAMP>(response + i);
+            if (timestamp <= stats.newestTimestamp) {
+                done = true;
+                break;
+            }
+            if (timestamp > newest) {
+                newest = timestamp;
+            }
+            stats.records++;
+            offset++;
+        }
+    }
+    stats.newestTimestamp = newest;
+    stats.syncs++;
+    phone.disconnect();
+
+    const uint64_t duration = host::nowMicros() - start;
+    stats.totalMicros += duration;
+    if (duration > stats.maxMicros) {
+        stats.maxMicros = duration;
+    }
+}
+
+static void pollWatch(SimSyncStats &stats) {
+    FakeGattClient watch;
+    if (!watch.connect()) {
+        return;
+    }
+    uint8_t request[RecordRequestSchema::size];
+    RecordRequestSchema::encode(request, CURRENT_RECORD_OFFSET);
+    watch.write(RECORD_REQUEST_CHARACTERISTIC_UUID, request, sizeof(request));
+    uint8_t response[BLUETOOTH_RECORD_SIZE];
+    if (watch.read(RECORD_DATA_CHARACTERISTIC_UUID, response, sizeof(response)) == BLUETOOTH_RECORD_SIZE) {
+        stats.records++;
+    }
+    stats.syncs++;
+    watch.disconnect();
+}
+
+// End state of the history: size, both ends and whether every record is older than the one after it
+static void reportRing(FILE *out) {
+    const uint32_t count = records.count();
+    SensorReading newest;
+    SensorReading oldest;
+    if (count == 0 || !records.readRecord(0, newest) || !records.readRecord(count - 1, oldest)) {
+        fprintf(out, "  Ring: empty\n");
+        return;
+    }
+    uint32_t unordered = 0;
+    uint32_t previous = newest.timestamp;
+    for (uint32_t offset = 1; offset < count; ++offset) {
+        SensorReading reading;
+        if (!records.readRecord(offset, reading) || reading.timestamp >= previous) {
+            unordered++;
+        }
+        previous = reading.timestamp;
+    }
+    fprintf(out, "  Ring: %u records, %u out of order, oldest %u (%.2f C, %.1f %%RH), newest %u (%.2f C, %.1f %%RH)\n",
+            count, unordered, oldest.timestamp, oldest.temperature, oldest.humidity, newest.timestamp,
+            newest.temperature, newest.humidity);
+}
+
+// One board: its own sensor and RTC tolerances, its own flash file. Device 0 of 1 runs the nominal tolerances.
+static int runDevice(unsigned device, unsigned devices, double hours, FILE *out) {
+    const float spread = devices > 1 ? 1.0f - 2.0f * device / (devices - 1) : 1.0f;
+    static SimSht3x sht(greenhouse, SIM_SHT_OSCILLATOR_ERROR * spread);
+    // Sensor and RTC as a battery backed board leaves them, the RTC set a day after the build
+    static SimDs3231 rtc(RtcDateTime(__DATE__, __TIME__).Unix32Time() + 86400, SIM_RTC_DRIFT_PPM * spread);
+    Wire.attach(SHT3X_DEFAULT_ADDRESS, &sht);
+    Wire.attach(DS3231_ADDRESS, &rtc);
+    host::setResetReason(ESP_RST_POWERON);
+#ifdef RECORD_STORE_FLASH_PARTITION
+    char path[32];
+    snprintf(path, sizeof(path), SIM_RECORD_PARTITION_FILE, device);
+    if (!host::addFilePartition(RECORD_STORE_FLASH_PARTITION, SIM_RECORD_PARTITION_SIZE, path)) {
+        fprintf(out, "Device %u: cannot open %s\n", device, path);
+        return 1;
+    }
+#endif
+
+    setup();
+    const uint64_t end = host::nowMicros() + (uint64_t) (hours * 3600e6);
+    uint64_t nextPhoneSync = host::nowMicros() + SIM_PHONE_SYNC_SECONDS * 1000000ULL;
+    uint64_t nextWatchPoll = host::nowMicros() + SIM_WATCH_POLL_SECONDS * 1000000ULL;
+    SimSyncStats phone{};
+    SimSyncStats watch{};
+    // The BLE task runs between loop iterations: a sync never interleaves with a sample here
+    while (host::nowMicros() < end) {
+        loop();
+        if (host::nowMicros() >= nextPhoneSync) {
+            syncPhone(phone);
+            nextPhoneSync += SIM_PHONE_SYNC_SECONDS * 1000000ULL;
+        }
+        if (host::nowMicros() >= nextWatchPoll) {
+            pollWatch(watch);
+            nextWatchPoll += SIM_WATCH_POLL_SECONDS * 1000000ULL;
+        }
+    }
+
+    const FramTrafficStats traffic = fram.getTrafficStats();
+    fprintf(out, "Device %u: SHT oscillator %+.1f %%, RTC drift %+.1f ppm, %.1f h simulated\n", device,
+            SIM_SHT_OSCILLATOR_ERROR * spread * 100, SIM_RTC_DRIFT_PPM * spread, hours);
+    reportRing(out);
+    fprintf(out, "  I2C: %u FRAM transfers (%u reads / %u B, %u writes / %u B), %u sensor and RTC transactions\n",
+            traffic.readTransfers + traffic.writeTransfers, traffic.readTransfers, traffic.bytesRead,
+            traffic.writeTransfers, traffic.bytesWritten, Wire.getTransactionCount());
+    fprintf(out, "  SHT: %u conversions, %u fetched\n", sht.getConversionCount(), sht.getFetchedCount());
+    fprintf(out, "  Phone: %u syncs, %u records, sync %.0f ms mean / %.0f ms max. Watch: %u polls, %u current "
+                 "readings\n", phone.syncs, phone.records,
+            phone.syncs > 0 ? phone.totalMicros / 1e3 / phone.syncs : 0.0, phone.maxMicros / 1e3, watch.syncs,
+            watch.records);
+    return 0;
+}
+
+// Every device in a process of its own: the firmware state (src/main.cpp globals, Wire, the BLE stack and the host
+// clock) is per process, so devices never share anything and run on all cores. Reports come back through pipes and
+// are printed in device order once every device is done.
+static int runDevices(unsigned devices, double hours) {
+    pid_t pids[SIM_MAX_DEVICES];
+    FILE *reports[SIM_MAX_DEVICES];
+    fflush(stdout);
+    for (unsigned device = 0; device < devices; ++device) {
+        int fds[2];
+        if (pipe(fds) != 0) {
+            perror("pipe");
+            return 1;
+        }
+        pids[device] = fork();
+        if (pids[device] < 0) {
+            perror("fork");
+            return 1;
+        }
+        if (pids[device] == 0) {
+            close(fds[0]);
+            Serial.mute(true); // Interleaved logs of every device would be unreadable
+            FILE *out = fdopen(fds[1], "w");
+            const int result = runDevice(device, devices, hours, out);
+            fclose(out);
+            _exit(result);
+        }
+        close(fds[1]);
+        reports[device] = fdopen(fds[0], "r");
+    }
+
+    int result = 0;
+    for (unsigned device = 0; device < devices; ++device) {
+        char line[256];
+        while (fgets(line, sizeof(line), reports[device]) != nullptr) {
+            fputs(line, stdout);
+        }
+        fclose(reports[device]);
+        int status;
+        if (waitpid(pids[device], &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            printf("Device %u failed\n", device);
+            result = 1;
+        }
+    }
+    return result;
+}
+
+int main(int argc, char **argv) {
+    double hours = SIM_DEFAULT_HOURS;
+    unsigned devices = 1;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--devices") == 0 && i + 1 < argc) {
+            devices = (unsigned) atoi(argv[++i]);
+        } else {
+            hours = atof(argv[i]);
+        }
+    }
+    if (devices == 0 || devices > SIM_MAX_DEVICES) {
+        fprintf(stderr, "Usage: %s [hours] [--devices 1..%u]\n", argv[0], SIM_MAX_DEVICES);
+        return 2;
+    }
+
+    if (devices == 1) {
+        return runDevice(0, 1, hours, stdout); // In this process, with the firmware log
+    }
+    return runDevices(devices, hours);
+}
@@ -0,0 +1,201 @@
+#ifndef RTCDS3231_HOST_H
+#define RTCDS3231_HOST_H
+
+// DS3231 driver with the interface of the Rtc by Makuna library, talking to the chip registers over the given
+// wire so that it runs against SimDs3231 (or any device at DS3231_ADDRESS).
+
+#include <Arduino.h>
+#include "RtcDateTime.h"
+
+#define DS3231_ADDRESS          0x68
+#define DS3231_REG_TIMEDATE     0x00
+#define DS3231_REG_TIMEDATE_SIZE 7
+#define DS3231_REG_CONTROL      0x0E
+#define DS3231_REG_STATUS       0x0F
+#define DS3231_REG_TEMP         0x11
+
+// Control register bits
+#define DS3231_EOSC   7
+#define DS3231_BBSQW  6
+#define DS3231_INTCN  2
+#define DS3231_AIEMASK 0x03
+// Status register bits
+#define DS3231_OSF    7
+#define DS3231_EN32KHZ 3
+
+#define Rtc_Wire_Error_None 0
+#define Rtc_Wire_Error_TxBufferOverflow 1
+#define Rtc_Wire_Error_NoAddressableDevice 2
+#define Rtc_Wire_Error_UnsupportedRequest 3
+#define Rtc_Wire_Error_Unspecific 4
+#define Rtc_Wire_Error_CommunicationTimeout 5
+
+enum DS3231SquareWavePinMode {
+    DS3231SquareWavePin_ModeNone,
+    DS3231SquareWavePin_ModeBatteryBackup,
+    DS3231SquareWavePin_ModeClock,
+    DS3231SquareWavePin_ModeAlarmOne,
+    DS3231SquareWavePin_ModeAlarmTwo,
+    DS3231SquareWavePin_ModeAlarmBoth
+};
+
+class RtcTemperature {
+public:
+    explicit RtcTemperature(int16_t centiDegC = 0) : _centiDegC(centiDegC) {}
+    [[nodiscard]] float AsFloatDegC() const { return _centiDegC / 100.0f; }
+    [[nodiscard]] int16_t AsCentiDegC() const { return _centiDegC; }
+
+private:
+    int16_t _centiDegC;
+};
+
+inline uint8_t RtcBcdToUint8(uint8_t bcd) {
+    return (bcd >> 4) * 10 + (bcd & 0x0F);
+}
+
+inline uint8_t RtcUint8ToBcd(uint8_t value) {
+    return ((value / 10) << 4) | (value % 10);
+}
+
+template<class T_WIRE_METHOD>
+class RtcDS3231 {
+public:
+    explicit RtcDS3231(T_WIRE_METHOD& wire) : _wire(wire), _lastError(Rtc_Wire_Error_None) {}
+
+    void Begin() { _wire.begin(); }
+
+    uint8_t LastError() { return _lastError; }
+
+    bool IsDateTimeValid() {
+        const uint8_t status = getReg(DS3231_REG_STATUS);
+        return !(status & (1 << DS3231_OSF)) && _lastError == Rtc_Wire_Error_None;
+    }
+
+    bool GetIsRunning() {
+        const uint8_t control = getReg(DS3231_REG_CONTROL);
+        return !(control & (1 << DS3231_EOSC)) && _lastError == Rtc_Wire_Error_None;
+    }
+
+    void SetIsRunning(bool isRunning) {
+        uint8_t control = getReg(DS3231_REG_CONTROL);
+        if (isRunning) {
+            control &= ~(1 << DS3231_EOSC);
+        } else {
+            control |= (1 << DS3231_EOSC);
+        }
+        setReg(DS3231_REG_CONTROL, control);
+    }
+
+    void SetDateTime(const RtcDateTime& dt) {
+        // Setting the time makes it valid again
+        const uint8_t status = getReg(DS3231_REG_STATUS);
+        setReg(DS3231_REG_STATUS, status & ~(1 << DS3231_OSF));
+
+        _wire.beginTransmission(DS3231_ADDRESS);
+        _wire.write(DS3231_REG_TIMEDATE);
+        _wire.write(RtcUint8ToBcd(dt.Second()));
+        _wire.write(RtcUint8ToBcd(dt.Minute()));
+        _wire.write(RtcUint8ToBcd(dt.Hour())); // 24 hour mode
+        _wire.write(RtcUint8ToBcd(dt.DayOfWeek() + 1));
+        _wire.write(RtcUint8ToBcd(dt.Day()));
+        _wire.write(RtcUint8ToBcd(dt.Month())); // Century bit clear, 20xx
+        _wire.write(RtcUint8ToBcd(dt.Year() - 2000));
+        _lastError = _wire.endTransmission();
+    }
+
+    RtcDateTime GetDateTime() {
+        _wire.beginTransmission(DS3231_ADDRESS);
+        _wire.write(DS3231_REG_TIMEDATE);
+        _lastError = _wire.endTransmission();
+        if (_lastError != Rtc_Wire_Error_None) {
+            return RtcDateTime(0);
+        }
+        if (_wire.requestFrom(DS3231_ADDRESS, DS3231_REG_TIMEDATE_SIZE) != DS3231_REG_TIMEDATE_SIZE) {
+            _lastError = Rtc_Wire_Error_Unspecific;
+            return RtcDateTime(0);
+        }
+        const uint8_t second = RtcBcdToUint8(_wire.read() & 0x7F);
+        const uint8_t minute = RtcBcdToUint8(_wire.read());
+        const uint8_t hour = RtcBcdToUint8(_wire.read() & 0x3F);
+        _wire.read(); // Day of week
+        const uint8_t dayOfMonth = RtcBcdToUint8(_wire.read());
+        const uint8_t month = RtcBcdToUint8(_wire.read() & 0x7F);
+        const uint8_t year = RtcBcdToUint8(_wire.read());
+        return RtcDateTime(2000 + year, month, dayOfMonth, hour, minute, second);
+    }
+
+    RtcTemperature GetTemperature() {
+        _wire.beginTransmission(DS3231_ADDRESS);
+        _wire.write(DS3231_REG_TEMP);
+        _lastError = _wire.endTransmission();
+        if (_lastError != Rtc_Wire_Error_None || _wire.requestFrom(DS3231_ADDRESS, 2) != 2) {
+            return RtcTemperature(0);
+        }
+        const int8_t degrees = (int8_t) _wire.read();
+        const uint8_t quarters = _wire.read() >> 6;
+        return RtcTemperature(degrees * 100 + quarters * 25);
+    }
+
+    void Enable32kHzPin(bool enable) {
+        uint8_t status = getReg(DS3231_REG_STATUS);
+        if (enable) {
+            status |= (1 << DS3231_EN32KHZ);
+        } else {
+            status &= ~(1 << DS3231_EN32KHZ);
+        }
+        setReg(DS3231_REG_STATUS, status);
+    }
+
+    void SetSquareWavePin(DS3231SquareWavePinMode pinMode, bool enableWhileInBatteryBackup = true) {
+        uint8_t control = getReg(DS3231_REG_CONTROL);
+        control &= ~(DS3231_AIEMASK | (1 << DS3231_BBSQW) | (1 << DS3231_INTCN));
+        if (enableWhileInBatteryBackup) {
+            control |= (1 << DS3231_BBSQW);
+        }
+        switch (pinMode) {
+            case DS3231SquareWavePin_ModeNone:
+                control |= (1 << DS3231_INTCN);
+                break;
+            case DS3231SquareWavePin_ModeBatteryBackup:
+            case DS3231SquareWavePin_ModeClock:
+                break;
+            case DS3231SquareWavePin_ModeAlarmOne:
+                control |= (1 << DS3231_INTCN) | 0x01;
+                break;
+            case DS3231SquareWavePin_ModeAlarmTwo:
+                control |= (1 << DS3231_INTCN) | 0x02;
+                break;
+            case DS3231SquareWavePin_ModeAlarmBoth:
+                control |= (1 << DS3231_INTCN) | DS3231_AIEMASK;
+                break;
+        }
+        setReg(DS3231_REG_CONTROL, control);
+    }
+
+private:
+    T_WIRE_METHOD& _wire;
+    uint8_t _lastError;
+
+    uint8_t getReg(uint8_t reg) {
+        _wire.beginTransmission(DS3231_ADDRESS);
+        _wire.write(reg);
+        _lastError = _wire.endTransmission();
+        if (_lastError != Rtc_Wire_Error_None) {
+            return 0;
+        }
+        if (_wire.requestFrom(DS3231_ADDRESS, 1) != 1) {
+            _lastError = Rtc_Wire_Error_Unspecific;
+            return 0;
+        }
+        return _wire.read();
+    }
+
+    void setReg(uint8_t reg, uint8_t value) {
+        _wire.beginTransmission(DS3231_ADDRESS);
+        _wire.write(reg);
+        _wire.write(value);
+        _lastError = _wire.endTransmission();
+    }
+};
+
+#endif //RTCDS3231_HOST_H
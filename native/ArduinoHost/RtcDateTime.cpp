@@ -0,0 +1,77 @@
+#include "RtcDateTime.h"
+#include <string.h>
+#include <stdlib.h>
+
+static const uint8_t DAYS_IN_MONTH[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+
+static bool isLeapYear(uint16_t yearFrom2000) {
+    return yearFrom2000 % 4 == 0; // Exact for 2000-2099
+}
+
+static uint8_t daysInMonth(uint16_t yearFrom2000, uint8_t month) {
+    return month == 2 && isLeapYear(yearFrom2000) ? 29 : DAYS_IN_MONTH[month - 1];
+}
+
+RtcDateTime::RtcDateTime(uint32_t secondsFrom2000) {
+    initWithSecondsFrom2000(secondsFrom2000);
+}
+
+RtcDateTime::RtcDateTime(uint16_t year, uint8_t month, uint8_t dayOfMonth, uint8_t hour, uint8_t minute,
+                         uint8_t second)
+    : _yearFrom2000(year >= 2000 ? year - 2000 : year),
+      _month(month),
+      _dayOfMonth(dayOfMonth),
+      _hour(hour),
+      _minute(minute),
+      _second(second) {
+}
+
+RtcDateTime::RtcDateTime(const char *date, const char *time) {
+    static const char MONTHS[] = "JanFebMarAprMayJunJulAugSepOctNovDec";
+    char month[4] = {date[0], date[1], date[2], '\0'};
+    _month = (uint8_t) ((strstr(MONTHS, month) - MONTHS) / 3 + 1);
+    _dayOfMonth = (uint8_t) atoi(date + 4);
+    _yearFrom2000 = (uint8_t) (atoi(date + 7) - 2000);
+    _hour = (uint8_t) atoi(time);
+    _minute = (uint8_t) atoi(time + 3);
+    _second = (uint8_t) atoi(time + 6);
+}
+
+uint8_t RtcDateTime::DayOfWeek() const {
+    return (daysFrom2000() + 6) % 7; // 2000-01-01 was a Saturday
+}
+
+uint32_t RtcDateTime::TotalSeconds() const {
+    return ((daysFrom2000() * 24 + _hour) * 60 + _minute) * 60 + _second;
+}
+
+uint32_t RtcDateTime::daysFrom2000() const {
+    uint32_t days = _dayOfMonth - 1;
+    for (uint8_t month = 1; month < _month; ++month) {
+        days += daysInMonth(_yearFrom2000, month);
+    }
+    for (uint16_t year = 0; year < _yearFrom2000; ++year) {
+        days += isLeapYear(year) ? 366 : 365;
+    }
+    return days;
+}
+
+void RtcDateTime::initWithSecondsFrom2000(uint32_t seconds) {
+    _second = seconds % 60;
+    seconds /= 60;
+    _minute = seconds % 60;
+    seconds /= 60;
+    _hour = seconds % 24;
+    uint32_t days = seconds / 24;
+    _yearFrom2000 = 0;
+    while (days >= (isLeapYear(_yearFrom2000) ? 366u : 365u)) {
+        days -= isLeapYear(_yearFrom2000) ? 366 : 365;
+        _yearFrom2000++;
+    }
+    _month = 1;
+    while (days >= daysInMonth(_yearFrom2000, _month)) {
+        days -= daysInMonth(_yearFrom2000, _month);
+        _month++;
+    }
+    _dayOfMonth = days + 1;
+}
@@ -0,0 +1,52 @@
+#ifndef RTCDATETIME_HOST_H
+#define RTCDATETIME_HOST_H
+
+#include <stdint.h>
+
+// Seconds between the Unix epoch and the 2000-01-01 epoch of RtcDateTime
+#define RTC_UNIX_EPOCH_OFFSET 946684800
+
+/**
+ * Calendar date and time from 2000 on, as in the Rtc by Makuna library.
+ */
+class RtcDateTime {
+public:
+    explicit RtcDateTime(uint32_t secondsFrom2000 = 0);
+    RtcDateTime(uint16_t year, uint8_t month, uint8_t dayOfMonth, uint8_t hour, uint8_t minute, uint8_t second);
+    // From the __DATE__ ("Mmm dd yyyy") and __TIME__ ("hh:mm:ss") macros
+    RtcDateTime(const char* date, const char* time);
+
+    [[nodiscard]] uint16_t Year() const { return 2000 + _yearFrom2000; }
+    [[nodiscard]] uint8_t Month() const { return _month; }
+    [[nodiscard]] uint8_t Day() const { return _dayOfMonth; }
+    [[nodiscard]] uint8_t Hour() const { return _hour; }
+    [[nodiscard]] uint8_t Minute() const { return _minute; }
+    [[nodiscard]] uint8_t Second() const { return _second; }
+    // 0 is Sunday
+    [[nodiscard]] uint8_t DayOfWeek() const;
+
+    [[nodiscard]] uint32_t TotalSeconds() const;
+    [[nodiscard]] uint32_t Unix32Time() const { return TotalSeconds() + RTC_UNIX_EPOCH_OFFSET; }
+    [[nodiscard]] uint64_t Unix64Time() const { return (uint64_t) TotalSeconds() + RTC_UNIX_EPOCH_OFFSET; }
+    void InitWithUnix32Time(uint32_t time) { initWithSecondsFrom2000(time - RTC_UNIX_EPOCH_OFFSET); }
+
+    bool operator==(const RtcDateTime& other) const { return TotalSeconds() == other.TotalSeconds(); }
+    bool operator!=(const RtcDateTime& other) const { return TotalSeconds() != other.TotalSeconds(); }
+    bool operator<(const RtcDateTime& other) const { return TotalSeconds() < other.TotalSeconds(); }
+    bool operator>(const RtcDateTime& other) const { return TotalSeconds() > other.TotalSeconds(); }
+    bool operator<=(const RtcDateTime& other) const { return TotalSeconds() <= other.TotalSeconds(); }
+    bool operator>=(const RtcDateTime& other) const { return TotalSeconds() >= other.TotalSeconds(); }
+
+private:
+    uint8_t _yearFrom2000;
+    uint8_t _month;
+    uint8_t _dayOfMonth;
+    uint8_t _hour;
+    uint8_t _minute;
+    uint8_t _second;
+
+    void initWithSecondsFrom2000(uint32_t seconds);
+    [[nodiscard]] uint32_t daysFrom2000() const;
+};
+
+#endif //RTCDATETIME_HOST_H
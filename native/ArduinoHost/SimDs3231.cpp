@@ -0,0 +1,82 @@
+#include "SimDs3231.h"
+
+// Power-on register values (datasheet figure 1): INTCN and rate select set, OSF and EN32kHz set
+#define DS3231_CONTROL_POWER_ON 0x1C
+#define DS3231_STATUS_POWER_ON  0x88
+
+SimDs3231::SimDs3231() : _registers(), _pointer(0), _secondsFrom2000(0), _setAt(0), _driftPpm(0), _temperature(25.0f) {
+    _registers[DS3231_REG_CONTROL] = DS3231_CONTROL_POWER_ON;
+    _registers[DS3231_REG_STATUS] = DS3231_STATUS_POWER_ON;
+    setTime(0);
+}
+
+SimDs3231::SimDs3231(uint32_t unixTime, float driftPpm)
+    : _registers(), _pointer(0), _secondsFrom2000(0), _setAt(0), _driftPpm(driftPpm), _temperature(25.0f) {
+    _registers[DS3231_REG_CONTROL] = (1 << DS3231_BBSQW) | (1 << DS3231_INTCN);
+    _registers[DS3231_REG_STATUS] = 0;
+    setTime(unixTime - RTC_UNIX_EPOCH_OFFSET);
+}
+
+uint32_t SimDs3231::getUnixTime() const {
+    return currentSecondsFrom2000() + RTC_UNIX_EPOCH_OFFSET;
+}
+
+void SimDs3231::setTime(uint32_t secondsFrom2000) {
+    _secondsFrom2000 = secondsFrom2000;
+    _setAt = host::nowMicros();
+}
+
+uint32_t SimDs3231::currentSecondsFrom2000() const {
+    const double elapsed = (host::nowMicros() - _setAt) * (1.0 + _driftPpm * 1e-6) / 1e6;
+    return _secondsFrom2000 + (uint32_t) elapsed;
+}
+
+// Copies the running time into the time registers, the chip does it on every read of them
+void SimDs3231::latchTime() {
+    const RtcDateTime now(currentSecondsFrom2000());
+    _registers[0] = RtcUint8ToBcd(now.Second());
+    _registers[1] = RtcUint8ToBcd(now.Minute());
+    _registers[2] = RtcUint8ToBcd(now.Hour());
+    _registers[3] = RtcUint8ToBcd(now.DayOfWeek() + 1);
+    _registers[4] = RtcUint8ToBcd(now.Day());
+    _registers[5] = RtcUint8ToBcd(now.Month());
+    _registers[6] = RtcUint8ToBcd(now.Year() - 2000);
+
+    const int16_t quarters = (int16_t) lroundf(_temperature * 4);
+    _registers[DS3231_REG_TEMP] = (uint8_t) (int8_t) (quarters >> 2);
+    _registers[DS3231_REG_TEMP + 1] = (uint8_t) ((quarters & 0x03) << 6);
+}
+
+bool SimDs3231::receive(const uint8_t *data, size_t length) {
+    if (length == 0) {
+        return true;
+    }
+    _pointer = data[0] % SIM_DS3231_REGISTER_COUNT;
+    bool timeWritten = false;
+    for (size_t i = 1; i < length; ++i) {
+        if (_pointer < DS3231_REG_TIMEDATE_SIZE) {
+            if (!timeWritten) {
+                latchTime(); // Partial writes keep the other fields
+                timeWritten = true;
+            }
+        }
+        _registers[_pointer] = data[i];
+        _pointer = (_pointer + 1) % SIM_DS3231_REGISTER_COUNT;
+    }
+    if (timeWritten) {
+        const RtcDateTime written(2000 + RtcBcdToUint8(_registers[6]), RtcBcdToUint8(_registers[5] & 0x7F),
+                                  RtcBcdToUint8(_registers[4]), RtcBcdToUint8(_registers[2] & 0x3F),
+                                  RtcBcdToUint8(_registers[1]), RtcBcdToUint8(_registers[0] & 0x7F));
+        setTime(written.TotalSeconds());
+    }
+    return true;
+}
+
+size_t SimDs3231::request(uint8_t *data, size_t length) {
+    latchTime();
+    for (size_t i = 0; i < length; ++i) {
+        data[i] = _registers[_pointer];
+        _pointer = (_pointer + 1) % SIM_DS3231_REGISTER_COUNT;
+    }
+    return length;
+}
@@ -0,0 +1,39 @@
+#ifndef SIMDS3231_H
+#define SIMDS3231_H
+
+#include <Wire.h>
+#include "RtcDS3231.h"
+
+#define SIM_DS3231_REGISTER_COUNT 0x13
+
+/**
+ * DS3231 register file on the simulated I2C bus. Time runs from the host clock, optionally off by a fixed
+ * crystal error, and is read back in BCD like on the chip.
+ */
+class SimDs3231 : public I2cDevice {
+public:
+    // Power-on state of a chip with a fresh battery: oscillator stopped flag set, 2000-01-01
+    SimDs3231();
+    // Already running, valid and configured like DS3231Clock::begin() leaves it (fast boot path)
+    explicit SimDs3231(uint32_t unixTime, float driftPpm = 0);
+
+    bool receive(const uint8_t* data, size_t length) override;
+    size_t request(uint8_t* data, size_t length) override;
+
+    void setTemperature(float celsius) { _temperature = celsius; }
+    [[nodiscard]] uint32_t getUnixTime() const;
+
+private:
+    uint8_t _registers[SIM_DS3231_REGISTER_COUNT];
+    uint8_t _pointer;
+    uint32_t _secondsFrom2000; // At _setAt
+    uint64_t _setAt;           // host::nowMicros()
+    float _driftPpm;
+    float _temperature;
+
+    void setTime(uint32_t secondsFrom2000);
+    [[nodiscard]] uint32_t currentSecondsFrom2000() const;
+    void latchTime();
+};
+
+#endif //SIMDS3231_H
@@ -0,0 +1,85 @@
+#include "SimSht3x.h"
+
+#define SHT3X_CMD_FETCH_DATA 0xE000
+#define SHT3X_CMD_BREAK      0x3093
+
+SimSht3x::SimSht3x(Signal signal, float oscillatorError)
+    : _signal(signal), _oscillatorError(oscillatorError), _periodic(false), _startedAt(0), _periodMicros(0),
+      _lastFetched(0), _fetchedCount(0), _fetchPending(false) {
+}
+
+uint32_t SimSht3x::getConversionCount() const {
+    if (!_periodic) {
+        return 0;
+    }
+    // The first result is available one period after the start command
+    return (uint32_t) ((host::nowMicros() - _startedAt) / _periodMicros);
+}
+
+bool SimSht3x::receive(const uint8_t *data, size_t length) {
+    if (length != 2) {
+        return false;
+    }
+    const uint16_t command = (data[0] << 8) | data[1];
+    if (command == SHT3X_CMD_FETCH_DATA) {
+        _fetchPending = true; // Acknowledged even when idle, the read header is NACKed then
+        return true;
+    }
+    if (command == SHT3X_CMD_BREAK) {
+        _periodic = false;
+        return true;
+    }
+
+    // Periodic mode: the MSB selects the rate (datasheet table 10)
+    float measurementsPerSecond;
+    switch (data[0]) {
+        case 0x20: measurementsPerSecond = 0.5f; break;
+        case 0x21: measurementsPerSecond = 1; break;
+        case 0x22: measurementsPerSecond = 2; break;
+        case 0x23: measurementsPerSecond = 4; break;
+        case 0x27: measurementsPerSecond = 10; break;
+        default: return false;
+    }
+    _periodic = true;
+    _startedAt = host::nowMicros();
+    _periodMicros = (uint64_t) (1e6 / measurementsPerSecond * (1 + _oscillatorError));
+    _lastFetched = 0;
+    return true;
+}
+
+size_t SimSht3x::request(uint8_t *data, size_t length) {
+    const uint32_t conversion = getConversionCount();
+    if (!_fetchPending || !_periodic || length < 6 || conversion == _lastFetched) {
+        _fetchPending = false;
+        return 0;
+    }
+    _fetchPending = false;
+    _lastFetched = conversion;
+    _fetchedCount++;
+
+    float temperature;
+    float humidity;
+    _signal(_startedAt + conversion * _periodMicros, temperature, humidity);
+    const float clampedTemperature = fminf(fmaxf(temperature, -45.0f), 130.0f);
+    const float clampedHumidity = fminf(fmaxf(humidity, 0.0f), 100.0f);
+    const uint16_t rawTemperature = (uint16_t) lroundf((clampedTemperature + 45.0f) / 175.0f * 65535.0f);
+    const uint16_t rawHumidity = (uint16_t) lroundf(clampedHumidity / 100.0f * 65535.0f);
+    data[0] = rawTemperature >> 8;
+    data[1] = rawTemperature & 0xFF;
+    data[2] = crc8(data, 2);
+    data[3] = rawHumidity >> 8;
+    data[4] = rawHumidity & 0xFF;
+    data[5] = crc8(data + 3, 2);
+    return 6;
+}
+
+uint8_t SimSht3x::crc8(const uint8_t *data, uint8_t length) {
+    uint8_t crc = 0xFF;
+    for (uint8_t i = 0; i < length; ++i) {
+        crc ^= data[i];
+        for (uint8_t bit = 0; bit < 8; ++bit) {
+            crc = (crc & 0x80) ? (uint8_t) ((crc << 1) ^ 0x31) : (uint8_t) (crc << 1);
+        }
+    }
+    return crc;
+}
@@ -0,0 +1,41 @@
+#ifndef SIMSHT3X_H
+#define SIMSHT3X_H
+
+#include <Wire.h>
+
+/**
+ * SHT3x in periodic acquisition mode on the simulated I2C bus. Conversions complete on the sensor's own
+ * oscillator, which can run off the host clock by a relative error; a fetch with no new conversion since the
+ * previous one is NACKed like on the chip.
+ */
+class SimSht3x : public I2cDevice {
+public:
+    // Environment seen by the sensor at a host time
+    typedef void (*Signal)(uint64_t micros, float& temperature, float& humidity);
+
+    /**
+     * @param signal Values returned by the conversions.
+     * @param oscillatorError Relative period error, 0.05 makes every conversion 5% late (datasheet tolerance).
+     */
+    explicit SimSht3x(Signal signal, float oscillatorError = 0);
+
+    bool receive(const uint8_t* data, size_t length) override;
+    size_t request(uint8_t* data, size_t length) override;
+
+    [[nodiscard]] uint32_t getConversionCount() const;
+    [[nodiscard]] uint32_t getFetchedCount() const { return _fetchedCount; }
+
+private:
+    Signal _signal;
+    float _oscillatorError;
+    bool _periodic;
+    uint64_t _startedAt;
+    uint64_t _periodMicros;
+    uint32_t _lastFetched; // Conversion index returned by the last fetch
+    uint32_t _fetchedCount;
+    bool _fetchPending;
+
+    static uint8_t crc8(const uint8_t* data, uint8_t length);
+};
+
+#endif //SIMSHT3X_H
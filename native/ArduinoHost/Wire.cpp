@@ -0,0 +1,85 @@
+#include "Wire.h"
+
+TwoWire Wire;
+
+void TwoWire::attach(uint8_t address, I2cDevice *device) {
+    for (uint8_t i = 0; i < I2C_MAX_DEVICES; ++i) {
+        if (_devices[i] != nullptr && _addresses[i] == address) {
+            _devices[i] = device;
+            return;
+        }
+    }
+    for (uint8_t i = 0; i < I2C_MAX_DEVICES; ++i) {
+        if (_devices[i] == nullptr) {
+            _devices[i] = device;
+            _addresses[i] = address;
+            return;
+        }
+    }
+}
+
+I2cDevice *TwoWire::find(uint8_t address) {
+    for (uint8_t i = 0; i < I2C_MAX_DEVICES; ++i) {
+        if (_devices[i] != nullptr && _addresses[i] == address) {
+            return _devices[i];
+        }
+    }
+    return nullptr;
+}
+
+void TwoWire::beginTransmission(uint8_t address) {
+    _txAddress = address;
+    _txLength = 0;
+}
+
+size_t TwoWire::write(uint8_t c) {
+    if (_txLength >= I2C_BUFFER_LENGTH) {
+        return 0;
+    }
+    _tx[_txLength++] = c;
+    return 1;
+}
+
+size_t TwoWire::write(const uint8_t *buffer, size_t size) {
+    size_t written = 0;
+    while (written < size && write(buffer[written]) == 1) {
+        written++;
+    }
+    return written;
+}
+
+// Same codes as the ESP32 core: 0 success, 2 address NACK, 3 data NACK
+uint8_t TwoWire::endTransmission(bool sendStop) {
+    host::advanceMicros((1 + _txLength) * I2C_BYTE_MICROS);
+    _transactions++;
+    I2cDevice *device = find(_txAddress);
+    if (device == nullptr) {
+        return 2;
+    }
+    return device->receive(_tx, _txLength) ? 0 : 3;
+}
+
+uint8_t TwoWire::requestFrom(uint8_t address, uint8_t quantity) {
+    _rxIndex = 0;
+    _rxLength = 0;
+    if (quantity > I2C_BUFFER_LENGTH) {
+        quantity = I2C_BUFFER_LENGTH;
+    }
+    _transactions++;
+    I2cDevice *device = find(address);
+    if (device == nullptr) {
+        host::advanceMicros(I2C_BYTE_MICROS);
+        return 0;
+    }
+    _rxLength = device->request(_rx, quantity);
+    host::advanceMicros((1 + _rxLength) * I2C_BYTE_MICROS);
+    return _rxLength;
+}
+
+int TwoWire::available() {
+    return (int) (_rxLength - _rxIndex);
+}
+
+int TwoWire::read() {
+    return _rxIndex < _rxLength ? _rx[_rxIndex++] : -1;
+}
@@ -0,0 +1,68 @@
+#ifndef WIRE_HOST_H
+#define WIRE_HOST_H
+
+#include <Arduino.h>
+
+#define I2C_MAX_DEVICES 8
+#define I2C_BUFFER_LENGTH 128
+// Bus time of one byte at 400 kHz: 8 data bits and the acknowledge
+#define I2C_BYTE_MICROS 23
+
+/**
+ * Simulated peripheral, attached to a TwoWire at its 7-bit address.
+ */
+class I2cDevice {
+public:
+    virtual ~I2cDevice() = default;
+
+    /**
+     * @brief A write transaction addressed to the device.
+     * @return False to NACK it.
+     */
+    virtual bool receive(const uint8_t* data, size_t length) = 0;
+
+    /**
+     * @brief A read transaction addressed to the device.
+     * @return Bytes placed in data, 0 to NACK the read header.
+     */
+    virtual size_t request(uint8_t* data, size_t length) = 0;
+};
+
+class TwoWire : public Print {
+public:
+    bool begin(int sda = -1, int scl = -1, uint32_t frequency = 0) { return true; }
+    void setClock(uint32_t frequency) {}
+    void setWireTimeout(uint32_t timeoutMicros, bool resetOnTimeout) {}
+
+    void beginTransmission(uint8_t address);
+    uint8_t endTransmission(bool sendStop = true);
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+    uint8_t requestFrom(uint8_t address, uint8_t quantity);
+    uint8_t requestFrom(int address, int quantity) { return requestFrom((uint8_t) address, (uint8_t) quantity); }
+    int available();
+    int read();
+
+    // Host side: plugs a simulated device on the bus (nullptr removes it)
+    void attach(uint8_t address, I2cDevice* device);
+
+    // Host side: addressed writes and reads issued since boot, NACKed ones included
+    [[nodiscard]] uint32_t getTransactionCount() const { return _transactions; }
+
+private:
+    I2cDevice* _devices[I2C_MAX_DEVICES] = {};
+    uint8_t _addresses[I2C_MAX_DEVICES] = {};
+    uint8_t _txAddress = 0;
+    uint8_t _tx[I2C_BUFFER_LENGTH] = {};
+    size_t _txLength = 0;
+    uint8_t _rx[I2C_BUFFER_LENGTH] = {};
+    size_t _rxLength = 0;
+    size_t _rxIndex = 0;
+    uint32_t _transactions = 0;
+
+    I2cDevice* find(uint8_t address);
+};
+
+extern TwoWire Wire;
+
+#endif //WIRE_HOST_H
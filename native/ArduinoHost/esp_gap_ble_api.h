@@ -0,0 +1,20 @@
+#ifndef ESP_GAP_BLE_API_HOST_H
+#define ESP_GAP_BLE_API_HOST_H
+
+#include <stdint.h>
+#include "esp_err.h"
+
+#define ESP_BLE_ADV_DATA_LEN_MAX 31
+#define ESP_BLE_AD_TYPE_FLAG 0x01
+#define ESP_BLE_AD_TYPE_128SRV_CMPL 0x07
+#define ESP_BLE_AD_TYPE_NAME_SHORT 0x08
+#define ESP_BLE_AD_TYPE_NAME_CMPL 0x09
+#define ESP_BLE_AD_MANUFACTURER_SPECIFIC_TYPE 0xFF
+#define ESP_BLE_ADV_FLAG_GEN_DISC (0x01 << 1)
+#define ESP_BLE_ADV_FLAG_BREDR_NOT_SPT (0x01 << 2)
+
+// The payloads are kept in BLEDevice::getAdvertising(), where scanners read them
+esp_err_t esp_ble_gap_config_adv_data_raw(uint8_t* raw_data, uint32_t raw_data_len);
+esp_err_t esp_ble_gap_config_scan_rsp_data_raw(uint8_t* raw_data, uint32_t raw_data_len);
+
+#endif //ESP_GAP_BLE_API_HOST_H
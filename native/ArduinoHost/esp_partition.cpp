@@ -0,0 +1,157 @@
+#include "esp_partition.h"
+#include <stdio.h>
+#include <string.h>
+#include "HostClock.h"
+
+struct FilePartition {
+    esp_partition_t partition;
+    FILE* file;
+};
+
+static FilePartition partitions[HOST_FLASH_MAX_PARTITIONS];
+static uint8_t partitionCount = 0;
+
+static FILE* fileOf(const esp_partition_t* partition) {
+    for (uint8_t i = 0; i < partitionCount; ++i) {
+        if (&partitions[i].partition == partition) {
+            return partitions[i].file;
+        }
+    }
+    return nullptr;
+}
+
+static bool inBounds(const esp_partition_t* partition, size_t offset, size_t size) {
+    return offset <= partition->size && size <= partition->size - offset;
+}
+
+const esp_partition_t* esp_partition_find_first(esp_partition_type_t type, esp_partition_subtype_t subtype,
+                                                const char* label) {
+    for (uint8_t i = 0; i < partitionCount; ++i) {
+        const esp_partition_t& partition = partitions[i].partition;
+        if (partition.type == type && (subtype == ESP_PARTITION_SUBTYPE_ANY || partition.subtype == subtype)
+            && (label == nullptr || strcmp(partition.label, label) == 0)) {
+            return &partition;
+        }
+    }
+    return nullptr;
+}
+
+esp_err_t esp_partition_read(const esp_partition_t* partition, size_t offset, void* dst, size_t size) {
+    FILE* file = fileOf(partition);
+    if (file == nullptr || dst == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!inBounds(partition, offset, size)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    host::advanceMicros(HOST_FLASH_COMMAND_MICROS + size / HOST_FLASH_READ_BYTES_PER_MICRO);
+    if (fseek(file, (long) offset, SEEK_SET) != 0 || fread(dst, 1, size, file) != size) {
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_partition_write(const esp_partition_t* partition, size_t offset, const void* src, size_t size) {
+    FILE* file = fileOf(partition);
+    if (file == nullptr || src == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!inBounds(partition, offset, size)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    if (size == 0) {
+        return ESP_OK;
+    }
+    const size_t pages = (offset + size - 1) / HOST_FLASH_PAGE_SIZE - offset / HOST_FLASH_PAGE_SIZE + 1;
+    host::advanceMicros(HOST_FLASH_COMMAND_MICROS + pages * HOST_FLASH_PAGE_PROGRAM_MICROS);
+
+    // Programming only clears bits
+    uint8_t page[HOST_FLASH_PAGE_SIZE];
+    const auto* in = static_cast<const uint8_t*>(src);
+    for (size_t done = 0; done < size;) {
+        const size_t chunk = size - done < sizeof(page) ? size - done : sizeof(page);
+        if (fseek(file, (long) (offset + done), SEEK_SET) != 0 || fread(page, 1, chunk, file) != chunk) {
+            return ESP_FAIL;
+        }
+        for (size_t i = 0; i < chunk; ++i) {
+            page[i] &= in[done + i];
+        }
+        if (fseek(file, (long) (offset + done), SEEK_SET) != 0 || fwrite(page, 1, chunk, file) != chunk) {
+            return ESP_FAIL;
+        }
+        done += chunk;
+    }
+    return fflush(file) == 0 ? ESP_OK : ESP_FAIL;
+}
+
+esp_err_t esp_partition_erase_range(const esp_partition_t* partition, size_t offset, size_t size) {
+    FILE* file = fileOf(partition);
+    if (file == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (offset % HOST_FLASH_SECTOR_SIZE != 0 || size % HOST_FLASH_SECTOR_SIZE != 0) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    if (!inBounds(partition, offset, size)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    uint8_t erased[HOST_FLASH_SECTOR_SIZE];
+    memset(erased, 0xFF, sizeof(erased));
+    for (size_t sector = 0; sector < size; sector += HOST_FLASH_SECTOR_SIZE) {
+        host::advanceMicros(HOST_FLASH_SECTOR_ERASE_MICROS);
+        if (fseek(file, (long) (offset + sector), SEEK_SET) != 0
+            || fwrite(erased, 1, sizeof(erased), file) != sizeof(erased)) {
+            return ESP_FAIL;
+        }
+    }
+    return fflush(file) == 0 ? ESP_OK : ESP_FAIL;
+}
+
+namespace host {
+
+    bool addFilePartition(const char* label, uint32_t size, const char* path) {
+        if (partitionCount == HOST_FLASH_MAX_PARTITIONS || strlen(label) >= sizeof(esp_partition_t::label)) {
+            return false;
+        }
+
+        FILE* file = fopen(path, "r+b");
+        if (file != nullptr && (fseek(file, 0, SEEK_END) != 0 || ftell(file) != (long) size)) {
+            fclose(file);
+            file = nullptr;
+        }
+        if (file == nullptr) {
+            // Fresh chip: every byte erased
+            file = fopen(path, "w+b");
+            if (file == nullptr) {
+                return false;
+            }
+            uint8_t erased[HOST_FLASH_SECTOR_SIZE];
+            memset(erased, 0xFF, sizeof(erased));
+            for (uint32_t written = 0; written < size;) {
+                const uint32_t chunk = size - written < sizeof(erased) ? size - written : sizeof(erased);
+                fwrite(erased, 1, chunk, file);
+                written += chunk;
+            }
+            fflush(file);
+        }
+
+        FilePartition& entry = partitions[partitionCount];
+        entry.partition.type = ESP_PARTITION_TYPE_DATA;
+        entry.partition.subtype = ESP_PARTITION_SUBTYPE_ANY;
+        entry.partition.address = 0;
+        entry.partition.size = size;
+        strcpy(entry.partition.label, label);
+        entry.file = file;
+        partitionCount++;
+        return true;
+    }
+
+    void clearPartitions() {
+        for (uint8_t i = 0; i < partitionCount; ++i) {
+            fclose(partitions[i].file);
+            partitions[i].file = nullptr;
+        }
+        partitionCount = 0;
+    }
+
+}
@@ -0,0 +1,57 @@
+#ifndef ESP_PARTITION_HOST_H
+#define ESP_PARTITION_HOST_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+// Partition API of ESP-IDF over files: host::addFilePartition() plays the part of a partitions.csv entry. Writes only
+// clear bits and erases set whole sectors back to 0xFF like NOR flash, and every operation advances the host clock
+// by the typical timings of an SPI NOR chip.
+
+#define HOST_FLASH_SECTOR_SIZE          4096
+#define HOST_FLASH_PAGE_SIZE            256
+#define HOST_FLASH_MAX_PARTITIONS       4
+#define HOST_FLASH_COMMAND_MICROS       2     // Per read or program command
+#define HOST_FLASH_READ_BYTES_PER_MICRO 10    // 40 MHz dual I/O
+#define HOST_FLASH_PAGE_PROGRAM_MICROS  700   // Per page touched
+#define HOST_FLASH_SECTOR_ERASE_MICROS  45000
+
+typedef enum {
+    ESP_PARTITION_TYPE_APP = 0x00,
+    ESP_PARTITION_TYPE_DATA = 0x01,
+} esp_partition_type_t;
+
+typedef enum {
+    ESP_PARTITION_SUBTYPE_ANY = 0xff,
+} esp_partition_subtype_t;
+
+typedef struct {
+    esp_partition_type_t type;
+    esp_partition_subtype_t subtype;
+    uint32_t address;
+    uint32_t size;
+    char label[17];
+} esp_partition_t;
+
+const esp_partition_t* esp_partition_find_first(esp_partition_type_t type, esp_partition_subtype_t subtype,
+                                                const char* label);
+esp_err_t esp_partition_read(const esp_partition_t* partition, size_t offset, void* dst, size_t size);
+esp_err_t esp_partition_write(const esp_partition_t* partition, size_t offset, const void* src, size_t size);
+esp_err_t esp_partition_erase_range(const esp_partition_t* partition, size_t offset, size_t size);
+
+namespace host {
+
+    /**
+     * @brief Declares a data partition stored in a file. The file is created erased (0xFF) when missing or of
+     *        another size, and kept otherwise, so that a second run sees what the first one programmed.
+     * @return False if the file cannot be opened or the table is full.
+     */
+    bool addFilePartition(const char* label, uint32_t size, const char* path);
+
+    // Empties the partition table and closes the files
+    void clearPartitions();
+
+}
+
+#endif //ESP_PARTITION_HOST_H
@@ -0,0 +1,25 @@
+#ifndef ESP_SYSTEM_HOST_H
+#define ESP_SYSTEM_HOST_H
+
+typedef enum {
+    ESP_RST_UNKNOWN,
+    ESP_RST_POWERON,
+    ESP_RST_EXT,
+    ESP_RST_SW,
+    ESP_RST_PANIC,
+    ESP_RST_INT_WDT,
+    ESP_RST_TASK_WDT,
+    ESP_RST_WDT,
+    ESP_RST_DEEPSLEEP,
+    ESP_RST_BROWNOUT,
+    ESP_RST_SDIO,
+} esp_reset_reason_t;
+
+esp_reset_reason_t esp_reset_reason(void);
+
+namespace host {
+    // Reason reported by esp_reset_reason(), power-on by default
+    void setResetReason(esp_reset_reason_t reason);
+}
+
+#endif //ESP_SYSTEM_HOST_H
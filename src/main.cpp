@@ -1,17 +1,103 @@
 #include <Wire.h>
 #include <Arduino.h>
-#include <SHTSensor.h>
+#include <Sht3xSensor.h>
 #include <DS3132Clock.h>
 #include <FramStorage.h>
 #include <SensorReading.h>
 #include <BleSensorServer.h>
+#include <ReadingBus.h>
+#include <FramRecordStore.h>
+#ifdef RECORD_STORE_FLASH_PARTITION
+#include <EspPartitionFlash.h>
+#include <FlashRecordStore.h>
+#endif
+#include <Adafruit_ST7789.h>
+#include <SensorDisplay.h>
+#include <AdaptiveRecorder.h>
+#include <AlertEngine.h>
+#include <BurstCapture.h>
+#include <Instrumentation.h>
+#include <Trace.h>
+#include <esp_system.h>
 
-SHTSensor sht;
+// ST7789 on the default hardware SPI bus
+#ifndef TFT_CS
+#define TFT_CS   5
+#endif
+#ifndef TFT_DC
+#define TFT_DC   16
+#endif
+#ifndef TFT_RST
+#define TFT_RST  17
+#endif
+#define TFT_SPI_FREQUENCY 40000000
+
+#define SAMPLE_INTERVAL_MS  1000
+#define STATS_REPORT_INTERVAL_SECONDS 3600
+// Window captured when an alert rule with ALERT_TRIGGER_BURST is raised
+#define ALERT_BURST_SAMPLES 100
+
+// RAM budgets of the largest subsystems, checked at build time. Every subsystem is a global object, its sizeof is
+// its whole footprint: the ESP32 builds print them all after linking (tools/footprint.py).
+#define BLE_RAM_BUDGET      2560
+#define DISPLAY_RAM_BUDGET  1024
+static_assert(sizeof(BleSensorServer) <= BLE_RAM_BUDGET, "BleSensorServer exceeds its RAM budget");
+static_assert(sizeof(SensorDisplay) <= DISPLAY_RAM_BUDGET, "SensorDisplay exceeds its RAM budget");
+
+Sht3xSensor sht;
 DS3231Clock rtc = DS3231Clock();
 FramStorage fram;
-BleSensorServer bleServer("Greenhouse Sensor", &fram, &sht, &rtc); // Customize device name if desired
+// History backend: the FRAM ring by default, or a log in a flash data partition
+// (-D RECORD_STORE_FLASH_PARTITION=\"records\" and the "records" entry of partitions.csv, as the *-flash-records envs
+// do; the FRAM history of a device switched over is not migrated)
+#ifdef RECORD_STORE_FLASH_PARTITION
+EspPartitionFlash recordFlash(RECORD_STORE_FLASH_PARTITION);
+FlashRecordStore records(&recordFlash);
+#else
+FramRecordStore records(&fram);
+#endif
+ReadingBus readings; // Written by sample() only, latest() is read from the BLE task
+// Subscribers of the bus in loop()
+ReadingBus::Cursor alertCursor;
+ReadingBus::Cursor recordCursor;
+ReadingBus::Cursor displayCursor;
+AlertEngine alerts(&fram);
+BurstCapture burst(&fram);
+AdaptiveRecorder recorder(&fram);
+BleSensorServer bleServer("Greenhouse Sensor", &records, &readings, &alerts, &burst, &recorder); // Customize device name if desired
+Adafruit_ST7789 tft(TFT_CS, TFT_DC, TFT_RST);
+SensorDisplay display(&tft, &records);
+bool deferredInitPending = true;
+uint32_t lastStatsReport = 0;
+uint32_t nextSampleAt = 0; // millis()
+uint32_t nextBurstPollAt = 0;
+bool burstMeasured = false; // A burst poll got a new measurement since the last 1 Hz sample, which reuses it
+SensorReading burstMeasurement; // Its values, kept here: the next polls fail and leave NAN in sht
 
-void saveRecordIfNeeded(const SensorReading &reading);
+bool saveRecordIfNeeded(const SensorReading &reading);
+void checkAlerts(const SensorReading &reading);
+void sample();
+void updateDisplay(SensorReading shown);
+void startBurst(uint16_t samples);
+void pollBurstSample();
+void deferredInit(const SensorReading &firstReading);
+void reportStats();
+
+// After a brownout, watchdog or crash reset the hardware is already configured: skip the settling delay and
+// the RTC configuration so that sampling and advertising come back as fast as possible.
+bool isFastBoot() {
+    switch (esp_reset_reason()) {
+        case ESP_RST_BROWNOUT:
+        case ESP_RST_PANIC:
+        case ESP_RST_INT_WDT:
+        case ESP_RST_TASK_WDT:
+        case ESP_RST_WDT:
+        case ESP_RST_SW:
+            return true;
+        default:
+            return false;
+    }
+}
 
 [[noreturn]] void error() {
     while (true) {
@@ -23,14 +109,19 @@ void saveRecordIfNeeded(const SensorReading &reading);
 }
 
 void setup() {
+    instrumentation.markBootPhase("reset");
+    const bool fastBoot = isFastBoot();
+
     pinMode(BUILTIN_LED, OUTPUT);
     rgbLedWrite(BUILTIN_LED, 255, 255, 255);
 
     Wire.begin(21, 22);
     Serial.begin(9600);
-    Serial.println("Serial Initialized.");
-    delay(1000); // let serial console settle
-
+    Serial.println(fastBoot ? "Serial Initialized (fast boot)." : "Serial Initialized.");
+    if (!fastBoot) {
+        delay(1000); // let serial console settle
+    }
+    instrumentation.markBootPhase("serial");
 
     if (fram.begin(DEFAULT_FRAM_I2C_ADDRESS, 32 * 1024)) {
         Serial.println("FRAM Initialized.");
@@ -38,56 +129,239 @@ void setup() {
         Serial.println("FRAM Initialization Failed!");
         error();
     }
+    if (!records.begin()) {
+        Serial.println("Record store Initialization Failed!");
+        error();
+    }
+    SensorReading lastRecord;
+    records.readRecord(0, lastRecord);
+    recorder.begin(lastRecord);
+    alerts.begin();
+    burst.begin();
+    instrumentation.markBootPhase("fram");
 
-    rtc.begin();
+    if (fastBoot) {
+        rtc.beginFast();
+    } else {
+        rtc.begin();
+    }
 
     if (rtc.getCurrentDateTime().Unix64Time() == 0)
         rtc.setTime(RtcDateTime(2025, 5, 21, 16, 32, 15));
+    instrumentation.markBootPhase("rtc");
 
-    if (sht.init()) {
+    // Periodic mode at twice the loop rate: every 1 Hz fetch finds a completed conversion
+    if (sht.begin(Sht3xSensor::RATE_2_MPS, Sht3xSensor::REPEATABILITY_MEDIUM)) {
         Serial.print("init(): success\n");
     } else {
         Serial.print("init(): failed\n");
         error();
     }
-    sht.setAccuracy(SHTSensor::SHT_ACCURACY_MEDIUM); // only supported by SHT3x
-
-    /*fram.writeUInt16(LAST_RECORD_ADDRESS, RECORD_START_ADDRESS + RECORD_SIZE_BYTES);
-    fram.writeUInt16(FIRST_RECORD_ADDRESS, RECORD_START_ADDRESS);
-    fram.writeUInt32(LAST_RECORD_TIMESTAMP_ADDRESS, 0);*/
+    instrumentation.markBootPhase("sht");
 
     bleServer.begin();
+    instrumentation.markBootPhase("ble");
+
     rgbLedWrite(BUILTIN_LED, 16, 0, 0);
 }
 
+// Everything not needed to sample and advertise, run once the first sample is taken
+void deferredInit(const SensorReading &firstReading) {
+    TRACE_SCOPE("deferred init");
+    tft.init(240, 240);
+    tft.setSPISpeed(TFT_SPI_FREQUENCY);
+    display.begin();
+    display.showReading(firstReading);
+    instrumentation.markBootPhase("display");
+
+    instrumentation.reportBoot(Serial);
+    instrumentation.markSteadyState();
+}
+
+// Deadline driven: the 1 Hz sample and, during a capture, the burst polls run on their own schedule
 void loop() {
+    uint16_t burstSamples;
+    if (burst.takeRequest(burstSamples)) {
+        startBurst(burstSamples);
+    }
+
+    const uint32_t now = millis();
+    if (burst.isCapturing() && (int32_t) (now - nextBurstPollAt) >= 0) {
+        nextBurstPollAt += BURST_POLL_INTERVAL_MS;
+        pollBurstSample();
+    }
+    if ((int32_t) (now - nextSampleAt) >= 0) {
+        // Fixed rate, but never try to catch up on samples missed by a long iteration
+        nextSampleAt = (int32_t) (now - nextSampleAt) >= SAMPLE_INTERVAL_MS ? now + SAMPLE_INTERVAL_MS
+                                                                            : nextSampleAt + SAMPLE_INTERVAL_MS;
+        sample();
+    }
+
+#ifdef TRACE_ENABLED
+    // Send 't' on the serial console to dump the trace
+    while (Serial.available() > 0) {
+        if (Serial.read() == 't') {
+            TRACE_DUMP(Serial);
+        }
+    }
+#endif
+
+    // Sleep until the next deadline
+    int32_t wait = (int32_t) (nextSampleAt - millis());
+    if (burst.isCapturing() && (int32_t) (nextBurstPollAt - millis()) < wait) {
+        wait = (int32_t) (nextBurstPollAt - millis());
+    }
+    if (wait > 0) {
+        delay(wait);
+    }
+}
 
+void sample() {
     const RtcDateTime dt = rtc.getCurrentDateTime();
-    if (sht.readSample()) {
-        const auto humidity = sht.getHumidity();
-        const auto temperature = sht.getTemperature();
-        saveRecordIfNeeded(SensorReading{temperature, humidity, dt.Unix32Time()});
+    SensorReading reading{NAN, NAN, dt.Unix32Time()};
+    bool sampled;
+    if (burst.isCapturing()) {
+        sampled = burstMeasured; // The burst owns the sensor, a second fetch would find no new measurement
+        burstMeasured = false;
+        if (sampled) {
+            reading.temperature = burstMeasurement.temperature;
+            reading.humidity = burstMeasurement.humidity;
+        }
+    } else {
+        const uint32_t fetchStart = micros();
+        sampled = sht.fetch();
+        instrumentation.addSampleBusyTime(micros() - fetchStart);
+        reading.temperature = sht.getTemperature(); // NAN when the fetch failed
+        reading.humidity = sht.getHumidity();
+    }
+    if (sampled) {
+        readings.publish(reading);
+        bleServer.updateAdvertisedReading(reading);
     } else {
-        Serial.print("Error in readSample()\n");
+        Serial.print("Error in fetch()\n");
+    }
+
+    // Consumers follow the bus through their own cursor: alerts and the recorder see every reading, the display
+    // only the newest one
+    SensorReading next;
+    while (readings.poll(alertCursor, next)) {
+        checkAlerts(next);
+    }
+    while (readings.poll(recordCursor, next)) {
+        if (saveRecordIfNeeded(next) && !deferredInitPending) {
+            TRACE_SCOPE("display");
+            display.appendRecord(next);
+        }
+    }
+    updateDisplay(reading);
+
+    if (reading.timestamp - lastStatsReport >= STATS_REPORT_INTERVAL_SECONDS) {
+        reportStats();
+        lastStatsReport = reading.timestamp;
+    }
+}
+
+// Shows the newest reading of the bus, or the failed sample (NAN values) when nothing new was published
+void updateDisplay(SensorReading shown) {
+    bool published = false;
+    SensorReading next;
+    while (readings.poll(displayCursor, next)) {
+        shown = next;
+        published = true;
+    }
+
+    if (deferredInitPending) {
+        // Boot ends with the first valid reading: a failed fetch neither shows NaNs nor closes the boot timeline
+        if (published) {
+            instrumentation.markBootPhase("first sample");
+            deferredInit(shown); // Loads the sparklines from the store, including a record written just above
+            deferredInitPending = false;
+        }
+        return;
+    }
+    TRACE_SCOPE("display");
+    display.showReading(shown);
+}
+
+void startBurst(uint16_t samples) {
+    Serial.print("Burst capture started, samples: ");
+    Serial.println(samples);
+    sht.begin(Sht3xSensor::RATE_10_MPS, Sht3xSensor::REPEATABILITY_LOW);
+    burst.start(rtc.getCurrentDateTime().Unix32Time(), samples, millis());
+    burstMeasured = false;
+    nextBurstPollAt = millis() + BURST_POLL_INTERVAL_MS;
+}
+
+// Polled faster than the sensor converts: a fetch only succeeds once per conversion, whatever its oscillator
+void pollBurstSample() {
+    TRACE_SCOPE("burst");
+    if (sht.fetch()) {
+        burstMeasured = true;
+        burstMeasurement.temperature = sht.getTemperature();
+        burstMeasurement.humidity = sht.getHumidity();
+        burst.add(burstMeasurement.temperature, burstMeasurement.humidity, millis());
     }
-    delay(1000);
+    burst.skipMissed(millis());
+    if (!burst.isCapturing()) {
+        Serial.print("Burst capture done, samples: ");
+        Serial.println(burst.getSampleCount());
+        sht.begin(Sht3xSensor::RATE_2_MPS, Sht3xSensor::REPEATABILITY_MEDIUM);
+    }
+}
+
+// Long-run counters, comparable between firmware versions and across soak runs
+void reportStats() {
+    const FramTrafficStats traffic = fram.getTrafficStats();
+    Serial.print("Uptime: ");
+    Serial.print(millis() / 1000);
+    Serial.print(" s, records: ");
+    Serial.print(recorder.getRecordCount());
+    Serial.print(" (");
+    Serial.print(recorder.getEarlyRecordCount());
+    Serial.println(" early)");
+    Serial.print("FRAM I2C: ");
+    Serial.print(traffic.readTransfers);
+    Serial.print(" reads / ");
+    Serial.print(traffic.bytesRead);
+    Serial.print(" B, ");
+    Serial.print(traffic.writeTransfers);
+    Serial.print(" writes / ");
+    Serial.print(traffic.bytesWritten);
+    Serial.println(" B");
+    instrumentation.reportSampling(Serial);
+    bleServer.reportSync(Serial);
+    instrumentation.reportHeap(Serial);
 }
 
-void saveRecordIfNeeded(const SensorReading &reading) {
-    const auto lastRecordTimestamp = fram.readUInt32(LAST_RECORD_TIMESTAMP_ADDRESS);
-    if (reading.timestamp - lastRecordTimestamp > RECORD_INTERVAL_SECONDS) {
-        const auto firstAddress = fram.readUInt16(FIRST_RECORD_ADDRESS);
-
-        const auto lastAddress = fram.readUInt16(LAST_RECORD_ADDRESS);
-        const uint16_t address = NEXT_ADDRESS(lastAddress);
-        Serial.print("NEXT_ADDRESS: ");
-        Serial.println(address, HEX);
-        if (address == firstAddress) {
-            fram.writeUInt16(FIRST_RECORD_ADDRESS, NEXT_ADDRESS(firstAddress));
+bool saveRecordIfNeeded(const SensorReading &reading) {
+    if (recorder.shouldRecord(reading)) {
+        TRACE_SCOPE("store.append");
+        if (!records.append(reading)) {
+            Serial.println("Failed to store record");
+            return false;
         }
+        Serial.print("Records stored: ");
+        Serial.println(records.count());
+        recorder.markRecorded(reading);
+        return true;
+    }
+    return false;
+}
+
+void checkAlerts(const SensorReading &reading) {
+    TRACE_SCOPE("alerts");
+    AlertEvent events[MAX_ALERT_RULES];
+    const uint8_t count = alerts.evaluate(reading, events, MAX_ALERT_RULES);
+    for (uint8_t i = 0; i < count; ++i) {
+        Serial.print("Alert ");
+        Serial.print(events[i].rule);
+        Serial.print(events[i].raised ? " raised: " : " cleared: ");
+        Serial.println(events[i].value);
+        bleServer.notifyAlert(events[i]);
 
-        fram.writeSensorReading(address, reading);
-        fram.writeUInt32(LAST_RECORD_TIMESTAMP_ADDRESS, reading.timestamp);
-        fram.writeUInt16(LAST_RECORD_ADDRESS, address);
+        AlertRule rule;
+        if (events[i].raised && alerts.getRule(events[i].rule, rule) && rule.triggersBurst) {
+            burst.request(ALERT_BURST_SAMPLES);
+        }
     }
 }
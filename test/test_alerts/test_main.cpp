@@ -0,0 +1,276 @@
+#include <unity.h>
+#include <thread>
+#include <vector>
+#include <AlertEngine.h>
+
+// Replays a one day greenhouse trace at the 1 Hz sampling rate and compares the raised and cleared alerts with the
+// timeline worked out from the trace: frost at night, overheat in the afternoon, a door opening and an irrigation.
+
+#define TRACE_SECONDS      (24 * 3600)
+#define TIMELINE_TOLERANCE 60 // Seconds, the trace noise moves the crossings a little
+#define STAGING_ROUNDS     20000
+#define STAGING_MIN_WRITES 5000
+#define LOGGING_ROUNDS     20000
+#define LOGGING_MIN_READS  2000
+
+static const uint32_t START = 1750000000;
+
+static uint32_t noiseState;
+
+// Deterministic noise in [-amplitude, amplitude]
+static float noise(float amplitude) {
+    noiseState = noiseState * 1664525u + 1013904223u;
+    return amplitude * (2.0f * (noiseState >> 8) / (float) (1u << 24) - 1.0f);
+}
+
+struct Knot {
+    uint32_t second;
+    float value;
+};
+
+// Night down to 0.5 °C, afternoon up to 38 °C, then the door opens at 14:00: -8 °C in 10 minutes
+static const Knot TEMPERATURE[] = {
+    {0, 8.0f}, {2 * 3600, 0.5f}, {4 * 3600, 0.5f}, {5 * 3600, 8.0f}, {11 * 3600, 30.0f}, {13 * 3600, 38.0f},
+    {14 * 3600, 38.0f}, {14 * 3600 + 600, 30.0f}, {16 * 3600, 30.0f}, {24 * 3600, 8.0f},
+};
+
+static float interpolate(const Knot *knots, size_t count, uint32_t second) {
+    for (size_t i = 1; i < count; ++i) {
+        if (second <= knots[i].second) {
+            const float f = (float) (second - knots[i - 1].second) / (knots[i].second - knots[i - 1].second);
+            return knots[i - 1].value + f * (knots[i].value - knots[i - 1].value);
+        }
+    }
+    return knots[count - 1].value;
+}
+
+// Irrigation at 16:00: 60 -> 95 %RH in 5 minutes, then back with a 20 minutes time constant
+static float humidityAt(uint32_t second) {
+    const int32_t sinceIrrigation = (int32_t) second - 16 * 3600;
+    if (sinceIrrigation < 0) {
+        return 60.0f;
+    }
+    if (sinceIrrigation < 300) {
+        return 60.0f + 35.0f * sinceIrrigation / 300.0f;
+    }
+    return 60.0f + 35.0f * expf(-(sinceIrrigation - 300) / 1200.0f);
+}
+
+static SensorReading traceAt(uint32_t second) {
+    const float temperature = interpolate(TEMPERATURE, sizeof(TEMPERATURE) / sizeof(TEMPERATURE[0]), second);
+    return {temperature + noise(0.05f), humidityAt(second) + noise(0.3f), START + second};
+}
+
+static AlertRule makeRule(uint8_t type, uint8_t quantity, float threshold, float hysteresis,
+                          uint16_t windowSeconds = 0) {
+    AlertRule rule;
+    rule.type = type;
+    rule.quantity = quantity;
+    rule.threshold = threshold;
+    rule.hysteresis = hysteresis;
+    rule.windowSeconds = windowSeconds;
+    return rule;
+}
+
+struct ExpectedEvent {
+    uint8_t rule;
+    bool raised;
+    uint32_t second;
+};
+
+static FramStorage *fram;
+
+void setUp() {
+    fram = new FramStorage();
+    fram->begin(DEFAULT_FRAM_I2C_ADDRESS, 32 * 1024);
+    noiseState = 1;
+}
+
+void tearDown() {
+    delete fram;
+}
+
+void test_trace_replay_matches_timeline() {
+    AlertEngine engine(fram);
+    engine.begin();
+    TEST_ASSERT_TRUE(engine.setRule(0, makeRule(ALERT_BELOW, ALERT_TEMPERATURE, 2.0f, 0.5f)));
+    TEST_ASSERT_TRUE(engine.setRule(1, makeRule(ALERT_ABOVE, ALERT_TEMPERATURE, 35.0f, 1.0f)));
+    TEST_ASSERT_TRUE(engine.setRule(2, makeRule(ALERT_RATE, ALERT_TEMPERATURE, 20.0f, 5.0f, 300)));
+    TEST_ASSERT_TRUE(engine.setRule(3, makeRule(ALERT_ABOVE, ALERT_HUMIDITY, 90.0f, 3.0f)));
+
+    // Crossings of the noiseless trace, hysteresis keeps the noise from toggling any alert
+    const ExpectedEvent expected[] = {
+        {0, true, 5760},   // Below 2 °C on the way down to 0.5
+        {0, false, 15360}, // Above 2.5 °C on the way up to 8
+        {1, true, 44100},  // Above 35 °C
+        {1, false, 50700}, // Below 34 °C halfway through the door opening
+        {2, true, 50700},  // Its first 5 minute window: -48 °C/h (same sample, rules in index order)
+        {2, false, 51300}, // First flat window after it
+        {3, true, 57857},  // Above 90 %RH during the irrigation
+        {3, false, 58211}, // Below 87 %RH while drying
+    };
+    const size_t expectedCount = sizeof(expected) / sizeof(expected[0]);
+
+    std::vector<AlertEvent> timeline;
+    for (uint32_t second = 0; second < TRACE_SECONDS; ++second) {
+        AlertEvent events[MAX_ALERT_RULES];
+        const uint8_t count = engine.evaluate(traceAt(second), events, MAX_ALERT_RULES);
+        timeline.insert(timeline.end(), events, events + count);
+    }
+
+    TEST_ASSERT_EQUAL_UINT32(expectedCount, timeline.size());
+    for (size_t i = 0; i < expectedCount; ++i) {
+        char message[64];
+        snprintf(message, sizeof(message), "event %u", (unsigned) i);
+        TEST_ASSERT_EQUAL_UINT8_MESSAGE(expected[i].rule, timeline[i].rule, message);
+        TEST_ASSERT_EQUAL_MESSAGE(expected[i].raised, timeline[i].raised, message);
+        TEST_ASSERT_UINT32_WITHIN_MESSAGE(TIMELINE_TOLERANCE, START + expected[i].second, timeline[i].timestamp,
+                                          message);
+    }
+
+    // The FRAM log holds the same events, newest first
+    TEST_ASSERT_EQUAL_UINT8(expectedCount, engine.getEventCount());
+    uint8_t logged[ALERT_EVENT_SLOTS * AlertEventSchema::size];
+    TEST_ASSERT_EQUAL_UINT8(expectedCount, engine.readEvents(0, logged, ALERT_EVENT_SLOTS));
+    for (size_t i = 0; i < expectedCount; ++i) {
+        const AlertEvent &event = timeline[expectedCount - 1 - i];
+        const uint8_t *record = logged + i * AlertEventSchema::size;
+        TEST_ASSERT_EQUAL_UINT8(event.rule, AlertEventSchema::get<EVENT_RULE>(record));
+        TEST_ASSERT_EQUAL_UINT32(event.timestamp, AlertEventSchema::get<EVENT_TIMESTAMP>(record));
+    }
+}
+
+void test_staged_rule_is_applied_at_next_sample() {
+    AlertEngine engine(fram);
+    engine.begin();
+    TEST_ASSERT_FALSE(engine.setRule(MAX_ALERT_RULES, makeRule(ALERT_ABOVE, ALERT_TEMPERATURE, 30.0f, 1.0f)));
+    TEST_ASSERT_FALSE(engine.setRule(0, makeRule(ALERT_ABOVE, ALERT_TEMPERATURE, NAN, 1.0f)));
+    TEST_ASSERT_FALSE(engine.setRule(0, makeRule(ALERT_RATE, ALERT_TEMPERATURE, 10.0f, 1.0f, 0)));
+    TEST_ASSERT_TRUE(engine.setRule(0, makeRule(ALERT_ABOVE, ALERT_TEMPERATURE, 30.0f, 1.0f)));
+
+    // Staged only: getRule() reports the rule in use
+    AlertRule rule;
+    TEST_ASSERT_TRUE(engine.getRule(0, rule));
+    TEST_ASSERT_EQUAL_UINT8(ALERT_DISABLED, rule.type);
+
+    AlertEvent events[MAX_ALERT_RULES];
+    TEST_ASSERT_EQUAL_UINT8(1, engine.evaluate(SensorReading(31.0f, 60.0f, START), events, MAX_ALERT_RULES));
+    TEST_ASSERT_TRUE(engine.getRule(0, rule));
+    TEST_ASSERT_EQUAL_UINT8(ALERT_ABOVE, rule.type);
+    TEST_ASSERT_EQUAL_FLOAT(30.0f, rule.threshold);
+
+    // Persisted by the sampling task
+    AlertEngine rebooted(fram);
+    rebooted.begin();
+    TEST_ASSERT_TRUE(rebooted.getRule(0, rule));
+    TEST_ASSERT_EQUAL_UINT8(ALERT_ABOVE, rule.type);
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, rule.hysteresis);
+}
+
+// Rules whose fields all derive from one number: a mix of two writes shows up as a mismatch
+static AlertRule taggedRule(uint16_t tag) {
+    return makeRule(ALERT_RATE, tag & 1, tag, tag / 4.0f, tag);
+}
+
+static bool isTagged(const AlertRule &rule) {
+    return rule.type == ALERT_DISABLED
+           || (rule.quantity == (rule.windowSeconds & 1) && rule.threshold == rule.windowSeconds
+               && rule.hysteresis == rule.windowSeconds / 4.0f);
+}
+
+void test_rules_cross_tasks_untorn() {
+    AlertEngine engine(fram);
+    engine.begin();
+    std::atomic<bool> done(false);
+    std::atomic<uint32_t> torn(0);
+    std::atomic<uint32_t> staged(0);
+
+    // BLE task: stages rules and reads them back
+    std::thread ble([&]() {
+        uint16_t tag = 1;
+        while (!done.load()) {
+            engine.setRule(0, taggedRule(tag));
+            staged++;
+            tag = tag % 1000 + 1;
+            AlertRule rule;
+            if (engine.getRule(0, rule) && !isTagged(rule)) {
+                torn++;
+            }
+        }
+    });
+
+    // Sampling task
+    for (uint32_t round = 0; round < STAGING_ROUNDS || staged.load() < STAGING_MIN_WRITES; ++round) {
+        AlertEvent events[MAX_ALERT_RULES];
+        engine.evaluate(SensorReading(20.0f, 60.0f, START + round), events, MAX_ALERT_RULES);
+        AlertRule rule;
+        if (!engine.getRule(0, rule) || !isTagged(rule)) { // Never fails on the writer's own task
+            torn++;
+        }
+    }
+    done = true;
+    ble.join();
+    TEST_ASSERT_EQUAL_UINT32(0, torn.load());
+}
+
+// Sample i raises the alert when even and clears it when odd, its value and timestamp both tell i
+static float loggedValue(uint32_t i) {
+    return (i % 2 == 0 ? 31.0f : 29.0f) + (i % 64) / 128.0f;
+}
+
+void test_events_cross_tasks_untorn() {
+    AlertEngine engine(fram);
+    engine.begin();
+    TEST_ASSERT_TRUE(engine.setRule(0, makeRule(ALERT_ABOVE, ALERT_TEMPERATURE, 30.0f, 0.0f)));
+    std::atomic<bool> done(false);
+    std::atomic<uint32_t> torn(0);
+    std::atomic<uint32_t> reads(0);
+
+    // BLE task: reads the whole log back while the sampling task keeps logging
+    std::thread ble([&]() {
+        uint8_t lastCount = 0;
+        while (!done.load()) {
+            uint8_t logged[ALERT_EVENT_SLOTS * AlertEventSchema::size];
+            const uint8_t count = engine.getEventCount();
+            const uint8_t read = engine.readEvents(0, logged, ALERT_EVENT_SLOTS);
+            if (count < lastCount || read > ALERT_EVENT_SLOTS) {
+                torn++;
+            }
+            lastCount = count;
+            if (read > 0) {
+                reads++;
+            }
+            const uint32_t newest = AlertEventSchema::get<EVENT_TIMESTAMP>(logged) - START;
+            for (uint8_t j = 0; j < read; ++j) {
+                const uint8_t *record = logged + j * AlertEventSchema::size;
+                const uint32_t i = AlertEventSchema::get<EVENT_TIMESTAMP>(record) - START;
+                if (AlertEventSchema::get<EVENT_RULE>(record) != 0
+                    || AlertEventSchema::get<EVENT_RAISED>(record) != (i % 2 == 0 ? 1 : 0)
+                    || AlertEventSchema::get<EVENT_VALUE>(record) != loggedValue(i) || i != newest - j) {
+                    torn++;
+                }
+            }
+        }
+    });
+
+    // Sampling task: one event per sample
+    for (uint32_t i = 0; i < LOGGING_ROUNDS || reads.load() < LOGGING_MIN_READS; ++i) {
+        AlertEvent events[MAX_ALERT_RULES];
+        if (engine.evaluate(SensorReading(loggedValue(i), 60.0f, START + i), events, MAX_ALERT_RULES) != 1) {
+            torn++;
+        }
+    }
+    done = true;
+    ble.join();
+    TEST_ASSERT_EQUAL_UINT32(0, torn.load());
+    TEST_ASSERT_EQUAL_UINT8(ALERT_EVENT_SLOTS, engine.getEventCount());
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_trace_replay_matches_timeline);
+    RUN_TEST(test_staged_rule_is_applied_at_next_sample);
+    RUN_TEST(test_rules_cross_tasks_untorn);
+    RUN_TEST(test_events_cross_tasks_untorn);
+    return UNITY_END();
+}
@@ -0,0 +1,153 @@
+#include <unity.h>
+#include <HostClock.h>
+#include <SimSht3x.h>
+#include <Sht3xSensor.h>
+#include <BurstCapture.h>
+
+// Burst captures against the simulated SHT3x, whose oscillator runs off the host clock like the datasheet allows: the
+// capture polls faster than the sensor converts, so every conversion is one sample whatever the drift.
+
+#define CAPTURE_TIMEOUT_MS 60000
+#define SAMPLE_TOLERANCE   0.012f // °C: centi °C storage plus the SHT3x resolution
+
+static const uint32_t START = 1750000000;
+
+// A ramp of 1 °C per second: each sample tells when its conversion happened
+static void ramp(uint64_t micros, float &temperature, float &humidity) {
+    temperature = micros / 1e6f;
+    humidity = 50.0f;
+}
+
+static FramStorage *fram;
+static Sht3xSensor *sht;
+
+void setUp() {
+    host::resetClock();
+    Serial.mute(true);
+    fram = new FramStorage();
+    fram->begin(DEFAULT_FRAM_I2C_ADDRESS, 32 * 1024);
+    sht = new Sht3xSensor();
+}
+
+void tearDown() {
+    Wire.attach(SHT3X_DEFAULT_ADDRESS, nullptr);
+    Serial.mute(false);
+    delete sht;
+    delete fram;
+}
+
+// The sampling task's part during a capture, as loop() runs it
+static void capture(BurstCapture &burst, uint16_t samples) {
+    sht->begin(Sht3xSensor::RATE_10_MPS, Sht3xSensor::REPEATABILITY_LOW);
+    burst.start(START, samples, millis());
+    const uint32_t startedAt = millis();
+    while (burst.isCapturing() && millis() - startedAt < CAPTURE_TIMEOUT_MS) {
+        delay(BURST_POLL_INTERVAL_MS);
+        if (sht->fetch()) {
+            burst.add(sht->getTemperature(), sht->getHumidity(), millis());
+        }
+        burst.skipMissed(millis());
+    }
+}
+
+static float temperatureOf(const uint8_t *sample) {
+    return BurstSampleSchema::get<BURST_TEMPERATURE>(sample) / 100.0f;
+}
+
+void test_every_conversion_is_one_sample() {
+    for (const float oscillatorError: {-0.05f, 0.0f, 0.03f, 0.05f}) {
+        host::resetClock();
+        SimSht3x chip(ramp, oscillatorError);
+        Wire.attach(SHT3X_DEFAULT_ADDRESS, &chip);
+        BurstCapture burst(fram);
+        burst.begin();
+        capture(burst, BURST_MAX_SAMPLES);
+
+        TEST_ASSERT_FALSE(burst.isCapturing());
+        TEST_ASSERT_EQUAL_UINT16(BURST_MAX_SAMPLES, burst.getSampleCount());
+        const float period = BURST_SAMPLE_INTERVAL_MS * (1 + oscillatorError);
+        TEST_ASSERT_UINT32_WITHIN(1, lroundf(period), burst.getSampleInterval());
+
+        // Consecutive conversions, none skipped or read twice
+        uint8_t samples[BURST_MAX_SAMPLES * BurstSampleSchema::size];
+        TEST_ASSERT_EQUAL_UINT16(BURST_MAX_SAMPLES, burst.readSamples(0, samples, BURST_MAX_SAMPLES));
+        for (uint16_t i = 1; i < BURST_MAX_SAMPLES; ++i) {
+            const float step = temperatureOf(samples + i * BurstSampleSchema::size)
+                               - temperatureOf(samples + (i - 1) * BurstSampleSchema::size);
+            TEST_ASSERT_FLOAT_WITHIN(SAMPLE_TOLERANCE, period / 1000, step);
+        }
+        TEST_ASSERT_EQUAL_UINT32(chip.getFetchedCount(), BURST_MAX_SAMPLES);
+    }
+}
+
+void test_silent_sensor_leaves_holes_on_time() {
+    SimSht3x chip(ramp);
+    Wire.attach(SHT3X_DEFAULT_ADDRESS, &chip);
+    BurstCapture burst(fram);
+    burst.begin();
+    sht->begin(Sht3xSensor::RATE_10_MPS, Sht3xSensor::REPEATABILITY_LOW);
+    burst.start(START, 40, millis());
+
+    // 20 samples, then the sensor stops answering
+    while (chip.getFetchedCount() < 20) {
+        delay(BURST_POLL_INTERVAL_MS);
+        if (sht->fetch()) {
+            burst.add(sht->getTemperature(), sht->getHumidity(), millis());
+        }
+        burst.skipMissed(millis());
+    }
+    Wire.attach(SHT3X_DEFAULT_ADDRESS, nullptr);
+    const uint32_t silentAt = millis();
+    while (burst.isCapturing() && millis() - silentAt < CAPTURE_TIMEOUT_MS) {
+        delay(BURST_POLL_INTERVAL_MS);
+        TEST_ASSERT_FALSE(sht->fetch());
+        burst.skipMissed(millis());
+    }
+
+    // The 20 missing samples come one nominal interval apart, after a grace period of BURST_MISSED_SAMPLE_MS
+    TEST_ASSERT_FALSE(burst.isCapturing());
+    TEST_ASSERT_UINT32_WITHIN(BURST_POLL_INTERVAL_MS, 19 * BURST_SAMPLE_INTERVAL_MS + BURST_MISSED_SAMPLE_MS,
+                              millis() - silentAt);
+    TEST_ASSERT_UINT32_WITHIN(1, BURST_SAMPLE_INTERVAL_MS, burst.getSampleInterval());
+    uint8_t samples[40 * BurstSampleSchema::size];
+    TEST_ASSERT_EQUAL_UINT16(40, burst.readSamples(0, samples, 40));
+    for (uint16_t i = 0; i < 40; ++i) {
+        const int16_t temperature = BurstSampleSchema::get<BURST_TEMPERATURE>(samples + i * BurstSampleSchema::size);
+        if (i < 20) {
+            TEST_ASSERT_TRUE(temperature != INT16_MIN);
+        } else {
+            TEST_ASSERT_EQUAL_INT16(INT16_MIN, temperature);
+        }
+    }
+}
+
+void test_capture_header_survives_a_reboot() {
+    BurstCapture blank(fram);
+    blank.begin();
+    TEST_ASSERT_EQUAL_UINT16(0, blank.getSampleCount());
+
+    SimSht3x chip(ramp, 0.04f);
+    Wire.attach(SHT3X_DEFAULT_ADDRESS, &chip);
+    BurstCapture burst(fram);
+    burst.begin();
+    capture(burst, 50);
+    // Requests are clamped to the capture region
+    burst.request(1000);
+    uint16_t requested;
+    TEST_ASSERT_TRUE(burst.takeRequest(requested));
+    TEST_ASSERT_EQUAL_UINT16(BURST_MAX_SAMPLES, requested);
+
+    BurstCapture rebooted(fram);
+    rebooted.begin();
+    TEST_ASSERT_EQUAL_UINT16(50, rebooted.getSampleCount());
+    TEST_ASSERT_EQUAL_UINT32(START, rebooted.getStartTimestamp());
+    TEST_ASSERT_EQUAL_UINT16(104, rebooted.getSampleInterval());
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_every_conversion_is_one_sample);
+    RUN_TEST(test_silent_sensor_leaves_holes_on_time);
+    RUN_TEST(test_capture_header_survives_a_reboot);
+    return UNITY_END();
+}
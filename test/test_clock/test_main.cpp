@@ -0,0 +1,67 @@
+#include <unity.h>
+#include <DS3132Clock.h>
+#include <SimDs3231.h>
+
+// DS3231Clock against the simulated chip: epoch conversions, the fast boot check and time keeping
+
+static const uint32_t START = 1750000000; // 2025-06-15 15:06:40 UTC
+
+void setUp() {
+    host::resetClock();
+    Serial.mute(true);
+}
+
+void tearDown() {
+    Wire.attach(DS3231_ADDRESS, nullptr);
+    Serial.mute(false);
+}
+
+void test_date_time_epochs() {
+    const RtcDateTime dt(2025, 6, 15, 15, 6, 40);
+    TEST_ASSERT_EQUAL_UINT32(START, dt.Unix32Time());
+    TEST_ASSERT_EQUAL_UINT8(0, dt.DayOfWeek()); // Sunday
+
+    RtcDateTime back;
+    back.InitWithUnix32Time(START + 86400 * 366);
+    TEST_ASSERT_EQUAL_UINT16(2026, back.Year());
+    TEST_ASSERT_EQUAL_UINT8(6, back.Month());
+    TEST_ASSERT_EQUAL_UINT8(16, back.Day());
+    TEST_ASSERT_EQUAL_UINT8(15, back.Hour());
+    TEST_ASSERT_TRUE(RtcDateTime(2024, 2, 29, 0, 0, 0) < RtcDateTime(2024, 3, 1, 0, 0, 0));
+}
+
+void test_configured_rtc_takes_fast_path_and_keeps_time() {
+    SimDs3231 chip(START);
+    Wire.attach(DS3231_ADDRESS, &chip);
+    DS3231Clock clock;
+    TEST_ASSERT_TRUE(clock.beginFast());
+    TEST_ASSERT_EQUAL_UINT32(START, clock.getCurrentDateTime().Unix32Time());
+    delay(90 * 1000);
+    TEST_ASSERT_EQUAL_UINT32(START + 90, clock.getCurrentDateTime().Unix32Time());
+}
+
+void test_fresh_rtc_is_configured_and_set() {
+    SimDs3231 chip;
+    Wire.attach(DS3231_ADDRESS, &chip);
+    DS3231Clock clock;
+    TEST_ASSERT_FALSE(clock.beginFast());
+    // Full begin(): set to the build time, valid and left in the state the fast path expects
+    TEST_ASSERT_TRUE(clock.isDateTimeValid());
+    TEST_ASSERT_GREATER_OR_EQUAL_UINT32(START, clock.getCurrentDateTime().Unix32Time());
+    TEST_ASSERT_TRUE(clock.beginFast());
+}
+
+void test_missing_rtc_reads_as_invalid() {
+    DS3231Clock clock;
+    TEST_ASSERT_FALSE(clock.isDateTimeValid());
+    TEST_ASSERT_EQUAL_UINT32(0, clock.getCurrentDateTime().TotalSeconds());
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_date_time_epochs);
+    RUN_TEST(test_configured_rtc_takes_fast_path_and_keeps_time);
+    RUN_TEST(test_fresh_rtc_is_configured_and_set);
+    RUN_TEST(test_missing_rtc_reads_as_invalid);
+    return UNITY_END();
+}
@@ -0,0 +1,200 @@
+#include <unity.h>
+#include <FramStorage.h>
+#include <FramRecordStore.h>
+#include <SensorDisplay.h>
+
+#define SCREEN_WIDTH  240
+#define SCREEN_HEIGHT 240
+
+// Framebuffer that counts every pixel pushed, standing in for the SPI panel
+class FramebufferFake : public Adafruit_GFX {
+public:
+    FramebufferFake() : Adafruit_GFX(SCREEN_WIDTH, SCREEN_HEIGHT), pixels(0), pixelsOutside(0), framebuffer() {}
+
+    void drawPixel(int16_t x, int16_t y, uint16_t color) override {
+        pixels++;
+        if (x < 0 || y < 0 || x >= SCREEN_WIDTH || y >= SCREEN_HEIGHT) {
+            pixelsOutside++;
+            return;
+        }
+        framebuffer[y * SCREEN_WIDTH + x] = color;
+    }
+
+    uint32_t pixels;
+    uint32_t pixelsOutside;
+    uint16_t framebuffer[SCREEN_WIDTH * SCREEN_HEIGHT];
+};
+
+static const uint32_t START = 1750000000;
+static const uint32_t GLYPH_PIXELS = GLYPH_WIDTH * GLYPH_HEIGHT * VALUE_TEXT_SIZE * VALUE_TEXT_SIZE;
+
+static FramStorage *fram;
+static FramRecordStore *records;
+
+static void seed(uint16_t count, uint32_t interval) {
+    for (uint16_t i = 0; i < count; ++i) {
+        const float t = i * 0.1f;
+        records->append(SensorReading(20.0f + 5.0f * sinf(t), 60.0f + 10.0f * cosf(t), START + i * interval));
+    }
+}
+
+void setUp() {
+    fram = new FramStorage();
+    fram->begin(DEFAULT_FRAM_I2C_ADDRESS, 32 * 1024);
+    records = new FramRecordStore(fram);
+    records->begin();
+}
+
+void tearDown() {
+    delete records;
+    delete fram;
+}
+
+void test_unchanged_reading_pushes_nothing() {
+    seed(40, SPARKLINE_BUCKET_SECONDS);
+    auto *screen = new FramebufferFake();
+    SensorDisplay display(screen, records);
+    display.begin();
+    display.showReading(SensorReading(21.5f, 55.0f, START));
+
+    const uint32_t before = screen->pixels;
+    display.showReading(SensorReading(21.5f, 55.0f, START + 1));
+    TEST_ASSERT_EQUAL_UINT32(before, screen->pixels);
+    delete screen;
+}
+
+void test_changed_digit_redraws_one_glyph() {
+    seed(40, SPARKLINE_BUCKET_SECONDS);
+    auto *screen = new FramebufferFake();
+    SensorDisplay display(screen, records);
+    display.begin();
+    display.showReading(SensorReading(21.5f, 55.0f, START));
+
+    // " 21.5" -> " 21.6", humidity unchanged
+    const uint32_t before = screen->pixels;
+    display.showReading(SensorReading(21.6f, 55.0f, START + 1));
+    TEST_ASSERT_EQUAL_UINT32(GLYPH_PIXELS, screen->pixels - before);
+    delete screen;
+}
+
+void test_sparkline_update_is_partial_and_exact() {
+    seed(SPARKLINE_POINTS + 10, SPARKLINE_BUCKET_SECONDS);
+    auto *incremental = new FramebufferFake();
+    SensorDisplay display(incremental, records);
+    display.begin();
+
+    const SensorReading next(31.0f, 40.0f, START + (SPARKLINE_POINTS + 10) * SPARKLINE_BUCKET_SECONDS);
+    records->append(next);
+    const uint32_t before = incremental->pixels;
+    display.appendRecord(next);
+    const uint32_t pushed = incremental->pixels - before;
+
+    // Erasing and redrawing both polylines must stay well below clearing the sparkline areas
+    const uint32_t sparkArea = (SCREEN_WIDTH - 8) * (SCREEN_HEIGHT / 2 - 40) * 2;
+    TEST_ASSERT_GREATER_THAN(0, pushed);
+    TEST_ASSERT_LESS_THAN(sparkArea / 4, pushed);
+    TEST_ASSERT_EQUAL_UINT32(0, incremental->pixelsOutside);
+
+    // And leave exactly what a full redraw of the same history shows
+    auto *fresh = new FramebufferFake();
+    SensorDisplay reference(fresh, records);
+    reference.begin();
+    TEST_ASSERT_EQUAL_MEMORY(fresh->framebuffer, incremental->framebuffer, sizeof(fresh->framebuffer));
+    delete fresh;
+    delete incremental;
+}
+
+void test_history_keeps_last_24_hours_only() {
+    // Two days of records: only the second day may be plotted, a wider range would flatten the curve
+    seed(2 * SPARKLINE_POINTS, SPARKLINE_BUCKET_SECONDS);
+    auto *full = new FramebufferFake();
+    SensorDisplay display(full, records);
+    display.begin();
+
+    tearDown();
+    setUp();
+    for (uint16_t i = SPARKLINE_POINTS; i < 2 * SPARKLINE_POINTS; ++i) {
+        const float t = i * 0.1f;
+        records->append(SensorReading(20.0f + 5.0f * sinf(t), 60.0f + 10.0f * cosf(t), START + i * SPARKLINE_BUCKET_SECONDS));
+    }
+    auto *lastDay = new FramebufferFake();
+    SensorDisplay reference(lastDay, records);
+    reference.begin();
+    TEST_ASSERT_EQUAL_MEMORY(lastDay->framebuffer, full->framebuffer, sizeof(full->framebuffer));
+    delete lastDay;
+    delete full;
+}
+
+// Leftmost column drawn in the temperature sparkline, -1 if none
+static int16_t leftmostPlotted(const FramebufferFake *screen) {
+    for (int16_t x = 0; x < SCREEN_WIDTH; ++x) {
+        for (int16_t y = 40; y < SCREEN_HEIGHT / 2; ++y) {
+            if (screen->framebuffer[y * SCREEN_WIDTH + x] == DISPLAY_TEMPERATURE) {
+                return x;
+            }
+        }
+    }
+    return -1;
+}
+
+void test_sparkline_x_axis_is_time() {
+    // Half a day between two records: the polyline covers half of the width whatever the record count
+    const uint32_t newest = START - START % SPARKLINE_BUCKET_SECONDS + 100 * SPARKLINE_BUCKET_SECONDS;
+    records->append(SensorReading(18.0f, 60.0f, newest - 12 * 3600));
+    records->append(SensorReading(22.0f, 65.0f, newest));
+    auto *sparse = new FramebufferFake();
+    SensorDisplay display(sparse, records);
+    display.begin();
+    const int16_t step = (SCREEN_WIDTH - 8) / (SPARKLINE_POINTS - 1);
+    TEST_ASSERT_EQUAL_INT(4 + (SPARKLINE_POINTS - 12 * 3600 / SPARKLINE_BUCKET_SECONDS - 1) * step,
+                          leftmostPlotted(sparse));
+
+    // A burst of early records inside the newest bucket is averaged into one point, nothing scrolls
+    const uint32_t before = sparse->pixels;
+    for (uint8_t i = 1; i <= 5; ++i) {
+        const SensorReading early(22.0f + i * 0.01f, 65.0f, newest + i);
+        records->append(early);
+        display.appendRecord(early);
+    }
+    TEST_ASSERT_EQUAL_INT(4 + (SPARKLINE_POINTS - 12 * 3600 / SPARKLINE_BUCKET_SECONDS - 1) * step,
+                          leftmostPlotted(sparse));
+    TEST_ASSERT_GREATER_THAN(0, sparse->pixels - before);
+
+    // Same history loaded from the store: same screen
+    auto *fresh = new FramebufferFake();
+    SensorDisplay reference(fresh, records);
+    reference.begin();
+    TEST_ASSERT_EQUAL_MEMORY(fresh->framebuffer, sparse->framebuffer, sizeof(fresh->framebuffer));
+    delete fresh;
+    delete sparse;
+}
+
+void test_sparkline_scrolls_past_gaps() {
+    seed(SPARKLINE_POINTS, SPARKLINE_BUCKET_SECONDS);
+    auto *incremental = new FramebufferFake();
+    SensorDisplay display(incremental, records);
+    display.begin();
+
+    // 20 hours without records, the oldest plotted point must be the one 20 hours before the new record
+    const SensorReading next(25.0f, 50.0f, START + (SPARKLINE_POINTS - 1) * SPARKLINE_BUCKET_SECONDS + 20 * 3600);
+    records->append(next);
+    display.appendRecord(next);
+
+    auto *fresh = new FramebufferFake();
+    SensorDisplay reference(fresh, records);
+    reference.begin();
+    TEST_ASSERT_EQUAL_MEMORY(fresh->framebuffer, incremental->framebuffer, sizeof(fresh->framebuffer));
+    delete fresh;
+    delete incremental;
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_unchanged_reading_pushes_nothing);
+    RUN_TEST(test_changed_digit_redraws_one_glyph);
+    RUN_TEST(test_sparkline_update_is_partial_and_exact);
+    RUN_TEST(test_history_keeps_last_24_hours_only);
+    RUN_TEST(test_sparkline_x_axis_is_time);
+    RUN_TEST(test_sparkline_scrolls_past_gaps);
+    return UNITY_END();
+}
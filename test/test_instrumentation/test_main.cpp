@@ -0,0 +1,58 @@
+#include <unity.h>
+#include <string>
+#include <Instrumentation.h>
+
+// Collects what the instrumentation prints
+class CapturePrint : public Print {
+public:
+    size_t write(uint8_t c) override {
+        text += (char) c;
+        return 1;
+    }
+
+    std::string text;
+};
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+void test_boot_phases_report_durations() {
+    Instrumentation boot;
+    delay(5);
+    boot.markBootPhase("first");
+    delay(20);
+    boot.markBootPhase("second");
+    CapturePrint out;
+    boot.reportBoot(out);
+    TEST_ASSERT_TRUE(out.text.find("Boot phase second") != std::string::npos);
+    TEST_ASSERT_TRUE(out.text.find("took 20000 us") != std::string::npos);
+}
+
+void test_allocations_are_flagged_after_steady_state_only() {
+    Instrumentation heap;
+    int caller;
+    heap.recordAllocation(64, &caller); // During setup: expected
+    TEST_ASSERT_EQUAL_UINT32(0, heap.getSteadyStateAllocations());
+
+    heap.markSteadyState();
+    CapturePrint quiet;
+    heap.reportHeap(quiet);
+    TEST_ASSERT_TRUE(quiet.text.find("allocations") == std::string::npos);
+
+    heap.recordAllocation(24, &caller);
+    heap.recordAllocation(8, &caller);
+    TEST_ASSERT_EQUAL_UINT32(2, heap.getSteadyStateAllocations());
+    CapturePrint out;
+    heap.reportHeap(out);
+    TEST_ASSERT_TRUE(out.text.find("WARNING: 2 heap allocations (32 B) since the end of setup") != std::string::npos);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_boot_phases_report_durations);
+    RUN_TEST(test_allocations_are_flagged_after_steady_state_only);
+    return UNITY_END();
+}
@@ -0,0 +1,234 @@
+#include <unity.h>
+#include <vector>
+#include <LttbDownsampler.h>
+#include <FramRecordStore.h>
+
+// The streaming downsampler against a plain in-memory LTTB (Steinarsson's reference algorithm in double precision),
+// on stores of every size, and while the sampling task keeps appending.
+
+static const uint32_t START = 1750000000;
+
+// Whole history in RAM, same offsets as the persistent stores
+class MemoryRecordStore final : public RecordStore {
+public:
+    bool begin() override { return true; }
+
+    bool append(const SensorReading &reading) override {
+        uint8_t record[RECORD_SIZE_BYTES];
+        StoredRecordSchema::encode(record, reading.temperature, reading.humidity, reading.timestamp);
+        _records.insert(_records.end(), record, record + RECORD_SIZE_BYTES);
+        return true;
+    }
+
+    [[nodiscard]] uint32_t count() const override { return _records.size() / RECORD_SIZE_BYTES; }
+
+    uint16_t readRecords(uint32_t offset, uint8_t *buffer, uint16_t maxRecords) override {
+        uint16_t read = 0;
+        while (read < maxRecords && offset + read < count()) {
+            const size_t index = count() - 1 - offset - read;
+            memcpy(buffer + read * RECORD_SIZE_BYTES, &_records[index * RECORD_SIZE_BYTES], RECORD_SIZE_BYTES);
+            read++;
+        }
+        return read;
+    }
+
+private:
+    std::vector<uint8_t> _records;
+};
+
+static uint32_t noiseState;
+
+static float noise(float amplitude) {
+    noiseState = noiseState * 1664525u + 1013904223u;
+    return amplitude * (2.0f * (noiseState >> 8) / (float) (1u << 24) - 1.0f);
+}
+
+// Record i: irregular intervals as the adaptive recorder leaves them, diurnal cycle plus noise
+static uint32_t timestampOf(uint32_t i) {
+    return START + i * 60 + (i * 37) % 50;
+}
+
+static SensorReading recordAt(uint32_t i) {
+    const float day = (timestampOf(i) % 86400) / 86400.0f;
+    return {18.0f + 6.0f * sinf(2 * (float) M_PI * day) + noise(0.5f),
+            70.0f - 15.0f * sinf(2 * (float) M_PI * day) + noise(2.0f), timestampOf(i)};
+}
+
+static std::vector<SensorReading> fill(RecordStore &store, uint32_t count) {
+    noiseState = 1;
+    std::vector<SensorReading> history;
+    for (uint32_t i = 0; i < count; ++i) {
+        history.push_back(recordAt(i));
+        store.append(history.back());
+    }
+    return history;
+}
+
+static double yOf(const SensorReading &reading, LttbSeries series) {
+    return series == LTTB_SERIES_HUMIDITY ? reading.humidity : reading.temperature;
+}
+
+// Indexes of the points selected in data, the textbook way: everything in memory
+static std::vector<uint32_t> referenceLttb(const std::vector<SensorReading> &data, uint32_t threshold,
+                                           LttbSeries series) {
+    const uint32_t n = data.size();
+    std::vector<uint32_t> sampled;
+    if (threshold >= n || threshold == 0) {
+        for (uint32_t i = 0; i < n; ++i) sampled.push_back(i);
+        return sampled;
+    }
+    const auto bucketStart = [&](uint64_t bucket) {
+        return (uint32_t) (1 + bucket * (n - 2) / (threshold - 2)); // floor(bucket * every) + 1, exactly
+    };
+    const auto x = [&](uint32_t i) { return (double) data[i].timestamp - data[0].timestamp; };
+
+    uint32_t a = 0;
+    sampled.push_back(a);
+    for (uint32_t bucket = 0; threshold > 2 && bucket < threshold - 2; ++bucket) {
+        uint32_t averageStart = bucketStart(bucket + 1);
+        uint32_t averageEnd = bucketStart(bucket + 2) < n ? bucketStart(bucket + 2) : n;
+        double averageX = 0;
+        double averageY = 0;
+        for (uint32_t i = averageStart; i < averageEnd; ++i) {
+            averageX += x(i);
+            averageY += yOf(data[i], series);
+        }
+        averageX /= averageEnd - averageStart;
+        averageY /= averageEnd - averageStart;
+
+        double maxArea = -1;
+        uint32_t selected = bucketStart(bucket);
+        for (uint32_t i = bucketStart(bucket); i < bucketStart(bucket + 1); ++i) {
+            const double area = fabs((x(a) - averageX) * (yOf(data[i], series) - yOf(data[a], series))
+                                     - (x(a) - x(i)) * (averageY - yOf(data[a], series)));
+            if (area > maxArea) {
+                maxArea = area;
+                selected = i;
+            }
+        }
+        sampled.push_back(selected);
+        a = selected;
+    }
+    if (threshold > 1) {
+        sampled.push_back(n - 1);
+    }
+    return sampled;
+}
+
+static std::vector<SensorReading> drain(LttbDownsampler &downsampler) {
+    std::vector<SensorReading> points;
+    SensorReading reading;
+    uint32_t offset;
+    while (downsampler.next(reading, offset)) {
+        points.push_back(reading);
+    }
+    return points;
+}
+
+static void assertSameSelection(const std::vector<SensorReading> &data, const std::vector<uint32_t> &expected,
+                                const std::vector<SensorReading> &points) {
+    TEST_ASSERT_EQUAL_UINT32(expected.size(), points.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        TEST_ASSERT_EQUAL_UINT32(data[expected[i]].timestamp, points[i].timestamp);
+    }
+}
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+void test_matches_reference() {
+    MemoryRecordStore store;
+    const std::vector<SensorReading> history = fill(store, 5000);
+    const uint16_t thresholds[] = {1, 2, 3, 7, 100, 240, 999, 2499, 4999, 5000, 6000};
+    for (const LttbSeries series: {LTTB_SERIES_TEMPERATURE, LTTB_SERIES_HUMIDITY}) {
+        for (const uint16_t threshold: thresholds) {
+            LttbDownsampler downsampler;
+            TEST_ASSERT_TRUE(downsampler.begin(&store, START, UINT32_MAX, threshold, series));
+            assertSameSelection(history, referenceLttb(history, threshold, series), drain(downsampler));
+        }
+    }
+}
+
+void test_bucket_bounds_on_large_stores() {
+    // A flash log holds ~170k records: float bucket bounds and coordinates would no longer land on the right record
+    MemoryRecordStore store;
+    const std::vector<SensorReading> history = fill(store, 200000);
+    for (const uint16_t threshold: {240, 1000, 4097}) {
+        LttbDownsampler downsampler;
+        TEST_ASSERT_TRUE(downsampler.begin(&store, START, UINT32_MAX, threshold, LTTB_SERIES_TEMPERATURE));
+        assertSameSelection(history, referenceLttb(history, threshold, LTTB_SERIES_TEMPERATURE), drain(downsampler));
+    }
+}
+
+void test_range_inside_the_history() {
+    MemoryRecordStore store;
+    const std::vector<SensorReading> history = fill(store, 3000);
+    const std::vector<SensorReading> range(history.begin() + 1000, history.begin() + 2001);
+
+    LttbDownsampler downsampler;
+    TEST_ASSERT_TRUE(downsampler.begin(&store, timestampOf(1000), timestampOf(2000), 50, LTTB_SERIES_HUMIDITY));
+    assertSameSelection(range, referenceLttb(range, 50, LTTB_SERIES_HUMIDITY), drain(downsampler));
+
+    // Bounds between two records
+    TEST_ASSERT_TRUE(downsampler.begin(&store, timestampOf(999) + 1, timestampOf(2001) - 1, 50,
+                                       LTTB_SERIES_HUMIDITY));
+    assertSameSelection(range, referenceLttb(range, 50, LTTB_SERIES_HUMIDITY), drain(downsampler));
+
+    TEST_ASSERT_FALSE(downsampler.begin(&store, timestampOf(10) + 1, timestampOf(11) - 1, 50, LTTB_SERIES_HUMIDITY));
+    TEST_ASSERT_FALSE(downsampler.begin(&store, START - 100, START - 1, 50, LTTB_SERIES_HUMIDITY));
+}
+
+void test_appends_do_not_shift_the_series() {
+    MemoryRecordStore store;
+    std::vector<SensorReading> history = fill(store, 2000);
+    const std::vector<uint32_t> expected = referenceLttb(history, 120, LTTB_SERIES_TEMPERATURE);
+
+    // A record appended after every point, as a 1 Hz sampling task would during a slow sync
+    LttbDownsampler downsampler;
+    TEST_ASSERT_TRUE(downsampler.begin(&store, START, timestampOf(1999), 120, LTTB_SERIES_TEMPERATURE));
+    std::vector<SensorReading> points;
+    SensorReading reading;
+    uint32_t offset;
+    uint32_t appended = 2000;
+    while (downsampler.next(reading, offset)) {
+        points.push_back(reading);
+        store.append(recordAt(appended++));
+        // The offset is where the point was when it was produced
+        TEST_ASSERT_EQUAL_UINT32(reading.timestamp, timestampOf(store.count() - 2 - offset));
+    }
+    assertSameSelection(history, expected, points);
+}
+
+void test_series_ends_when_its_oldest_record_is_dropped() {
+    auto *fram = new FramStorage();
+    fram->begin(DEFAULT_FRAM_I2C_ADDRESS, 32 * 1024);
+    FramRecordStore store(fram);
+    store.begin();
+    fill(store, RECORD_SLOT_COUNT - 1); // Full ring
+
+    LttbDownsampler downsampler;
+    TEST_ASSERT_TRUE(downsampler.begin(&store, START, UINT32_MAX, 100, LTTB_SERIES_TEMPERATURE));
+    SensorReading reading;
+    uint32_t offset;
+    TEST_ASSERT_TRUE(downsampler.next(reading, offset));
+    TEST_ASSERT_EQUAL_UINT32(START, reading.timestamp);
+
+    // Overwrites the first record of the range
+    store.append(recordAt(RECORD_SLOT_COUNT));
+    TEST_ASSERT_FALSE(downsampler.next(reading, offset));
+    TEST_ASSERT_FALSE(downsampler.isActive());
+    delete fram;
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_matches_reference);
+    RUN_TEST(test_bucket_bounds_on_large_stores);
+    RUN_TEST(test_range_inside_the_history);
+    RUN_TEST(test_appends_do_not_shift_the_series);
+    RUN_TEST(test_series_ends_when_its_oldest_record_is_dropped);
+    return UNITY_END();
+}
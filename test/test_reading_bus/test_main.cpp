@@ -0,0 +1,118 @@
+#include <unity.h>
+#include <atomic>
+#include <thread>
+#include <ReadingBus.h>
+
+// Every published reading is self-consistent (humidity and temperature derived from the timestamp): a reader that
+// gets a pair mixing two samples has seen a torn slot.
+
+#define STRESS_READINGS 2000000
+#define STRESS_READERS  3
+
+static SensorReading readingAt(uint32_t index) {
+    return {index * 0.25f, 100.0f - index * 0.5f, index};
+}
+
+static bool isConsistent(const SensorReading &reading) {
+    const SensorReading expected = readingAt(reading.timestamp);
+    return reading.temperature == expected.temperature && reading.humidity == expected.humidity;
+}
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+void test_poll_returns_every_reading_in_order() {
+    ReadingBus bus;
+    ReadingBus::Cursor cursor;
+    SensorReading reading;
+    TEST_ASSERT_FALSE(bus.latest(reading));
+    TEST_ASSERT_FALSE(bus.poll(cursor, reading));
+
+    for (uint32_t i = 1; i <= 5; ++i) {
+        bus.publish(readingAt(i));
+    }
+    for (uint32_t i = 1; i <= 5; ++i) {
+        TEST_ASSERT_TRUE(bus.poll(cursor, reading));
+        TEST_ASSERT_EQUAL_UINT32(i, reading.timestamp);
+    }
+    TEST_ASSERT_FALSE(bus.poll(cursor, reading));
+    TEST_ASSERT_EQUAL_UINT32(0, cursor.getMissed());
+    TEST_ASSERT_TRUE(bus.latest(reading));
+    TEST_ASSERT_EQUAL_UINT32(5, reading.timestamp);
+}
+
+void test_slow_subscriber_skips_to_oldest_available() {
+    ReadingBus bus;
+    ReadingBus::Cursor cursor;
+    const uint32_t published = READING_BUS_CAPACITY + 5;
+    for (uint32_t i = 1; i <= published; ++i) {
+        bus.publish(readingAt(i));
+    }
+    SensorReading reading;
+    TEST_ASSERT_TRUE(bus.poll(cursor, reading));
+    TEST_ASSERT_EQUAL_UINT32(published - READING_BUS_CAPACITY + 1, reading.timestamp);
+    TEST_ASSERT_EQUAL_UINT32(published - READING_BUS_CAPACITY, cursor.getMissed());
+}
+
+void test_concurrent_readers_never_see_torn_readings() {
+    ReadingBus bus;
+    std::atomic<bool> done(false);
+    std::atomic<uint32_t> torn(0);
+    std::atomic<uint32_t> disordered(0);
+    std::atomic<uint32_t> accounted(0);
+
+    std::thread readers[STRESS_READERS];
+    for (auto &reader: readers) {
+        reader = std::thread([&]() {
+            ReadingBus::Cursor cursor;
+            SensorReading reading;
+            uint32_t last = 0;
+            uint32_t received = 0;
+            auto check = [&](const SensorReading &r) {
+                if (!isConsistent(r)) torn++;
+                if (r.timestamp <= last) disordered++;
+                last = r.timestamp;
+                received++;
+            };
+            while (!done.load(std::memory_order_acquire)) {
+                if (bus.poll(cursor, reading)) {
+                    check(reading);
+                }
+                SensorReading latest;
+                if (bus.latest(latest) && !isConsistent(latest)) {
+                    torn++;
+                }
+            }
+            while (bus.poll(cursor, reading)) {
+                check(reading);
+            }
+            // Every reading was either received or counted as missed
+            if (received + cursor.getMissed() == STRESS_READINGS) {
+                accounted++;
+            }
+        });
+    }
+    for (uint32_t i = 1; i <= STRESS_READINGS; ++i) {
+        bus.publish(readingAt(i));
+    }
+    done.store(true, std::memory_order_release);
+    for (auto &reader: readers) {
+        reader.join();
+    }
+
+    TEST_ASSERT_EQUAL_UINT32(0, torn.load());
+    TEST_ASSERT_EQUAL_UINT32(0, disordered.load());
+    TEST_ASSERT_EQUAL_UINT32(STRESS_READERS, accounted.load());
+    TEST_ASSERT_EQUAL_UINT32(STRESS_READINGS, bus.getPublishedCount());
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_poll_returns_every_reading_in_order);
+    RUN_TEST(test_slow_subscriber_skips_to_oldest_available);
+    RUN_TEST(test_concurrent_readers_never_see_torn_readings);
+    return UNITY_END();
+}
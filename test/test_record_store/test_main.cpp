@@ -0,0 +1,222 @@
+#include <unity.h>
+#include <thread>
+#include <atomic>
+#include <esp_partition.h>
+#include <HostClock.h>
+#include <EspPartitionFlash.h>
+#include <FlashRecordStore.h>
+#include <FramRecordStore.h>
+
+// Both history backends on their host stand-ins: the FRAM ring over the simulated I2C FRAM and the flash log over a
+// file-backed partition. The benchmark compares them in simulated bus and flash time.
+
+#define SMALL_PARTITION_SIZE  (16 * HOST_FLASH_SECTOR_SIZE)
+#define RECORD_PARTITION_SIZE 0x1F0000 // The "records" entry of partitions.csv
+#define PARTITION_FILE        "test_record_store.bin"
+#define BENCH_RECORDS         2000
+#define STRESS_RECORDS        2000
+#define STRESS_MIN_BATCHES    50
+#define BATCH_RECORDS         32 // BATCH_MAX_RECORDS of the BLE server
+
+static const uint32_t START = 1750000000;
+static const uint16_t RECORDS_PER_BLOCK = (HOST_FLASH_SECTOR_SIZE - FLASH_BLOCK_HEADER_SIZE) / RECORD_SIZE_BYTES;
+
+static void addPartition(uint32_t size) {
+    remove(PARTITION_FILE);
+    TEST_ASSERT_TRUE(host::addFilePartition("records", size, PARTITION_FILE));
+}
+
+static void append(RecordStore &store, uint32_t first, uint32_t count) {
+    for (uint32_t i = first; i < first + count; ++i) {
+        TEST_ASSERT_TRUE(store.append(SensorReading(20.0f + (i % 100) * 0.1f, 60.0f, START + i)));
+    }
+}
+
+// Newest first from offset, timestamps going down by one
+static void assertRecords(RecordStore &store, uint32_t offset, uint32_t newestIndex, uint16_t count) {
+    uint8_t buffer[BATCH_RECORDS * RECORD_SIZE_BYTES];
+    TEST_ASSERT_EQUAL_UINT16(count, store.readRecords(offset, buffer, count));
+    for (uint16_t i = 0; i < count; ++i) {
+        TEST_ASSERT_EQUAL_UINT32(START + newestIndex - i,
+                                 StoredRecordSchema::get<STORED_TIMESTAMP>(buffer + i * RECORD_SIZE_BYTES));
+    }
+}
+
+void setUp() {
+    Serial.mute(true);
+}
+
+void tearDown() {
+    Serial.mute(false);
+    host::clearPartitions();
+    remove(PARTITION_FILE);
+}
+
+void test_flash_log_survives_a_reboot() {
+    addPartition(SMALL_PARTITION_SIZE);
+    const uint32_t appended = 3 * RECORDS_PER_BLOCK + 7;
+    {
+        EspPartitionFlash flash("records");
+        FlashRecordStore store(&flash);
+        TEST_ASSERT_TRUE(store.begin());
+        append(store, 0, appended);
+    }
+
+    EspPartitionFlash flash("records");
+    FlashRecordStore store(&flash);
+    TEST_ASSERT_TRUE(store.begin());
+    TEST_ASSERT_EQUAL_UINT32(appended, store.count());
+    assertRecords(store, 0, appended - 1, BATCH_RECORDS);
+    assertRecords(store, appended - BATCH_RECORDS, BATCH_RECORDS - 1, BATCH_RECORDS);
+    TEST_ASSERT_EQUAL_UINT32(appended - 1 - 100, store.findOffset(START + 100));
+    TEST_ASSERT_EQUAL_UINT32(RECORD_NOT_FOUND, store.findOffset(START - 1));
+}
+
+void test_flash_log_drops_oldest_block_when_full() {
+    addPartition(SMALL_PARTITION_SIZE);
+    EspPartitionFlash flash("records");
+    FlashRecordStore store(&flash, FLASH_PAGE_BUFFER_RECORDS);
+    TEST_ASSERT_TRUE(store.begin());
+    const uint32_t appended = 20 * RECORDS_PER_BLOCK + 5;
+    append(store, 0, appended);
+
+    // The head block holds 5 records, the 15 blocks before it are full
+    const uint32_t kept = 15 * RECORDS_PER_BLOCK + 5;
+    TEST_ASSERT_EQUAL_UINT32(kept, store.count());
+    assertRecords(store, 0, appended - 1, 5); // Still in the page buffer
+    assertRecords(store, kept - BATCH_RECORDS, appended - kept + BATCH_RECORDS - 1, BATCH_RECORDS);
+    TEST_ASSERT_EQUAL_UINT32(RECORD_NOT_FOUND, store.findOffset(START + appended - kept - 1));
+    TEST_ASSERT_EQUAL_UINT32(kept - 1, store.findOffset(START + appended - kept));
+}
+
+void test_flash_log_indexes_the_whole_partition() {
+    // 496 blocks: more than the 256 of the former fixed index
+    addPartition(RECORD_PARTITION_SIZE);
+    EspPartitionFlash flash("records");
+    FlashRecordStore store(&flash, FLASH_PAGE_BUFFER_RECORDS);
+    TEST_ASSERT_TRUE(store.begin());
+    const uint32_t blocks = RECORD_PARTITION_SIZE / HOST_FLASH_SECTOR_SIZE;
+    const uint32_t appended = (blocks - 1) * RECORDS_PER_BLOCK + 1;
+    append(store, 0, appended);
+    TEST_ASSERT_TRUE(store.flush());
+
+    TEST_ASSERT_EQUAL_UINT32(appended, store.count());
+    TEST_ASSERT_EQUAL_UINT32(appended - 1, store.findOffset(START));
+    const uint32_t inBlock400 = 400 * RECORDS_PER_BLOCK + 17;
+    TEST_ASSERT_EQUAL_UINT32(appended - 1 - inBlock400, store.findOffset(START + inBlock400));
+}
+
+// A reader on another thread, as the BLE task, must only ever see consecutive records
+static void readWhileAppending(RecordStore &store) {
+    std::atomic<bool> done(false);
+    std::atomic<uint32_t> torn(0);
+    std::atomic<uint32_t> batches(0);
+    std::thread reader([&]() {
+        uint8_t buffer[BATCH_RECORDS * RECORD_SIZE_BYTES];
+        while (!done.load()) {
+            const uint16_t read = store.readRecords(0, buffer, BATCH_RECORDS);
+            for (uint16_t i = 1; i < read; ++i) {
+                const uint32_t newer = StoredRecordSchema::get<STORED_TIMESTAMP>(buffer + (i - 1) * RECORD_SIZE_BYTES);
+                const uint32_t older = StoredRecordSchema::get<STORED_TIMESTAMP>(buffer + i * RECORD_SIZE_BYTES);
+                if (newer != older + 1) {
+                    torn++;
+                    break;
+                }
+            }
+            batches++;
+        }
+    });
+    // Yields like loop() between samples, so that the reader is not starved of the lock
+    for (uint32_t i = 0; i < STRESS_RECORDS || batches.load() < STRESS_MIN_BATCHES; ++i) {
+        store.append(SensorReading(20.0f, 60.0f, START + i));
+        std::this_thread::yield();
+    }
+    done = true;
+    reader.join();
+    TEST_ASSERT_EQUAL_UINT32(0, torn.load());
+}
+
+void test_fram_ring_reads_while_appending() {
+    FramStorage fram;
+    fram.begin(DEFAULT_FRAM_I2C_ADDRESS, 32 * 1024);
+    FramRecordStore store(&fram);
+    TEST_ASSERT_TRUE(store.begin());
+    readWhileAppending(store);
+}
+
+void test_flash_log_reads_while_appending() {
+    addPartition(SMALL_PARTITION_SIZE);
+    EspPartitionFlash flash("records");
+    FlashRecordStore store(&flash, 4);
+    TEST_ASSERT_TRUE(store.begin());
+    readWhileAppending(store);
+}
+
+struct StoreTiming {
+    double appendMicros;
+    double batchMicros;
+};
+
+// Simulated time per append, and per BATCH_RECORDS read spread over the history
+static StoreTiming measure(RecordStore &store) {
+    uint64_t start = host::nowMicros();
+    append(store, 0, BENCH_RECORDS);
+    const double appendMicros = (double) (host::nowMicros() - start) / BENCH_RECORDS;
+
+    uint8_t buffer[BATCH_RECORDS * RECORD_SIZE_BYTES];
+    const uint32_t batches = BENCH_RECORDS / BATCH_RECORDS;
+    start = host::nowMicros();
+    for (uint32_t batch = 0; batch < batches; ++batch) {
+        store.readRecords(batch * BATCH_RECORDS, buffer, BATCH_RECORDS);
+    }
+    return {appendMicros, (double) (host::nowMicros() - start) / batches};
+}
+
+static void report(const char *name, const StoreTiming &timing) {
+    char line[120];
+    snprintf(line, sizeof(line), "%s: %.1f us/append, %.1f us per %u record read", name, timing.appendMicros,
+             timing.batchMicros, BATCH_RECORDS);
+    TEST_MESSAGE(line);
+}
+
+void test_benchmark_backends() {
+    FramStorage fram;
+    fram.begin(DEFAULT_FRAM_I2C_ADDRESS, 32 * 1024);
+    FramRecordStore ring(&fram);
+    TEST_ASSERT_TRUE(ring.begin());
+    const StoreTiming framTiming = measure(ring);
+
+    addPartition(SMALL_PARTITION_SIZE);
+    EspPartitionFlash flash("records");
+    StoreTiming writeThrough{};
+    {
+        FlashRecordStore log(&flash);
+        TEST_ASSERT_TRUE(log.begin());
+        writeThrough = measure(log);
+    }
+    host::clearPartitions();
+    addPartition(SMALL_PARTITION_SIZE);
+    EspPartitionFlash buffered("records");
+    FlashRecordStore log(&buffered, FLASH_PAGE_BUFFER_RECORDS);
+    TEST_ASSERT_TRUE(log.begin());
+    const StoreTiming bufferedTiming = measure(log);
+
+    report("FRAM ring", framTiming);
+    report("flash log, write-through", writeThrough);
+    report("flash log, page buffered", bufferedTiming);
+
+    // SPI flash reads beat the I2C bus, page buffering amortizes programs
+    TEST_ASSERT_LESS_THAN_FLOAT(framTiming.batchMicros, writeThrough.batchMicros);
+    TEST_ASSERT_LESS_THAN_FLOAT(writeThrough.appendMicros, bufferedTiming.appendMicros);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_flash_log_survives_a_reboot);
+    RUN_TEST(test_flash_log_drops_oldest_block_when_full);
+    RUN_TEST(test_flash_log_indexes_the_whole_partition);
+    RUN_TEST(test_fram_ring_reads_while_appending);
+    RUN_TEST(test_flash_log_reads_while_appending);
+    RUN_TEST(test_benchmark_backends);
+    return UNITY_END();
+}
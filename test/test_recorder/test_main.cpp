@@ -0,0 +1,169 @@
+#include <unity.h>
+#include <vector>
+#include <AdaptiveRecorder.h>
+
+// Replays a synthetic greenhouse trace at the 1 Hz sampling rate through the recording policy, then rebuilds the
+// 1 Hz signal from the stored records (linear interpolation, as the sparklines and the app draw them) and compares.
+
+#define TRACE_START     1750000000
+#define TRACE_DAYS      3
+#define TRACE_SECONDS   (TRACE_DAYS * 24 * 3600)
+#define FIXED_INTERVAL  (20 * 60) // The original fixed rate recording
+
+static uint32_t noiseState;
+
+// Deterministic noise in [-amplitude, amplitude]
+static float noise(float amplitude) {
+    noiseState = noiseState * 1664525u + 1013904223u;
+    return amplitude * (2.0f * (noiseState >> 8) / (float) (1u << 24) - 1.0f);
+}
+
+// Diurnal cycle plus a door opening (fast temperature drop) and an irrigation (fast humidity rise) every afternoon
+static SensorReading traceAt(uint32_t second) {
+    const float day = (second % 86400) / 86400.0f;
+    float temperature = 18.0f + 6.0f * sinf(2 * (float) M_PI * (day - 0.3f));
+    float humidity = 70.0f - 15.0f * sinf(2 * (float) M_PI * (day - 0.3f));
+
+    const int32_t sinceDoor = (int32_t) (second % 86400) - 14 * 3600;
+    if (sinceDoor >= 0 && sinceDoor < 300) {
+        temperature -= 4.0f * sinceDoor / 300.0f;
+    } else if (sinceDoor >= 300 && sinceDoor < 2100) {
+        temperature -= 4.0f * (2100 - sinceDoor) / 1800.0f;
+    }
+    const int32_t sinceIrrigation = (int32_t) (second % 86400) - 16 * 3600;
+    if (sinceIrrigation >= 0 && sinceIrrigation < 300) {
+        humidity += 20.0f * sinceIrrigation / 300.0f;
+    } else if (sinceIrrigation >= 300) {
+        humidity += 20.0f * expf(-(sinceIrrigation - 300) / 1200.0f);
+    }
+    return {temperature + noise(0.05f), humidity + noise(0.3f), TRACE_START + second};
+}
+
+struct ReplayResult {
+    uint32_t records;
+    float maxTemperatureError;
+    float maxHumidityError;
+    float rmsTemperatureError;
+};
+
+static ReplayResult replay(AdaptiveRecorder &recorder) {
+    noiseState = 1;
+    std::vector<SensorReading> trace;
+    trace.reserve(TRACE_SECONDS);
+    std::vector<SensorReading> stored;
+    for (uint32_t second = 0; second < TRACE_SECONDS; ++second) {
+        const SensorReading reading = traceAt(second);
+        trace.push_back(reading);
+        if (recorder.shouldRecord(reading)) {
+            stored.push_back(reading);
+            recorder.markRecorded(reading);
+        }
+    }
+
+    ReplayResult result{(uint32_t) stored.size(), 0, 0, 0};
+    double squares = 0;
+    size_t next = 0;
+    for (const SensorReading &reading: trace) {
+        while (next < stored.size() && stored[next].timestamp <= reading.timestamp) {
+            next++;
+        }
+        if (next == 0 || next == stored.size()) {
+            continue; // Before the first or after the last record, nothing to interpolate
+        }
+        const SensorReading &a = stored[next - 1];
+        const SensorReading &b = stored[next];
+        const float f = (float) (reading.timestamp - a.timestamp) / (b.timestamp - a.timestamp);
+        const float temperatureError = fabsf(a.temperature + f * (b.temperature - a.temperature) - reading.temperature);
+        const float humidityError = fabsf(a.humidity + f * (b.humidity - a.humidity) - reading.humidity);
+        if (temperatureError > result.maxTemperatureError) result.maxTemperatureError = temperatureError;
+        if (humidityError > result.maxHumidityError) result.maxHumidityError = humidityError;
+        squares += temperatureError * temperatureError;
+    }
+    result.rmsTemperatureError = sqrtf(squares / trace.size());
+    return result;
+}
+
+static void report(const char *name, const ReplayResult &result) {
+    char line[160];
+    snprintf(line, sizeof(line), "%s: %u records/day, max error %.2f C / %.2f %%RH, rms %.3f C", name,
+             result.records / TRACE_DAYS, result.maxTemperatureError, result.maxHumidityError,
+             result.rmsTemperatureError);
+    TEST_MESSAGE(line);
+}
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+void test_replay_against_fixed_interval() {
+    AdaptiveRecorder fixed(nullptr, 0, 0, FIXED_INTERVAL - 1, FIXED_INTERVAL - 1);
+    const ReplayResult baseline = replay(fixed);
+    AdaptiveRecorder adaptive(nullptr);
+    const ReplayResult result = replay(adaptive);
+    report("fixed 20 min", baseline);
+    report("adaptive", result);
+
+    // Fewer records than the fixed rate on this trace, never fewer than one per MAX_RECORD_INTERVAL_SECONDS
+    TEST_ASSERT_LESS_THAN(baseline.records, result.records);
+    TEST_ASSERT_GREATER_OR_EQUAL(TRACE_SECONDS / MAX_RECORD_INTERVAL_SECONDS, result.records);
+    // And the door opening is not smoothed away
+    TEST_ASSERT_LESS_THAN_FLOAT(baseline.maxTemperatureError, result.maxTemperatureError);
+    TEST_ASSERT_LESS_THAN_FLOAT(baseline.maxHumidityError, result.maxHumidityError);
+    TEST_ASSERT_LESS_THAN_FLOAT(2 * DEFAULT_TEMPERATURE_DEADBAND, result.maxTemperatureError);
+}
+
+void test_flat_signal_records_at_max_interval() {
+    AdaptiveRecorder recorder(nullptr);
+    uint32_t records = 0;
+    for (uint32_t second = 0; second < 24 * 3600; ++second) {
+        const SensorReading reading(20.0f, 60.0f, TRACE_START + second);
+        if (recorder.shouldRecord(reading)) {
+            recorder.markRecorded(reading);
+            records++;
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT32(24 * 3600 / (MAX_RECORD_INTERVAL_SECONDS + 1) + 1, records);
+    TEST_ASSERT_EQUAL_UINT32(0, recorder.getEarlyRecordCount());
+}
+
+void test_staged_deadband_is_applied_and_persisted() {
+    auto *fram = new FramStorage();
+    fram->begin(DEFAULT_FRAM_I2C_ADDRESS, 32 * 1024);
+    AdaptiveRecorder recorder(fram);
+    recorder.begin(SensorReading(20.0f, 60.0f, TRACE_START));
+
+    TEST_ASSERT_FALSE(recorder.setDeadband(-1.0f, 3.0f));
+    TEST_ASSERT_FALSE(recorder.setDeadband(0.5f, NAN));
+    TEST_ASSERT_FALSE(recorder.setDeadband(0.5f, 1000.0f));
+    TEST_ASSERT_TRUE(recorder.setDeadband(2.0f, 0.0f));
+
+    // Staged only: still the defaults until the next sample
+    float temperature;
+    float humidity;
+    recorder.getDeadband(temperature, humidity);
+    TEST_ASSERT_EQUAL_FLOAT(DEFAULT_TEMPERATURE_DEADBAND, temperature);
+
+    // 1 °C away and 30 %RH away: below the new temperature deadband, humidity no longer triggers
+    TEST_ASSERT_FALSE(recorder.shouldRecord(SensorReading(21.0f, 90.0f, TRACE_START + 120)));
+    recorder.getDeadband(temperature, humidity);
+    TEST_ASSERT_EQUAL_FLOAT(2.0f, temperature);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, humidity);
+    TEST_ASSERT_TRUE(recorder.shouldRecord(SensorReading(22.5f, 60.0f, TRACE_START + 180)));
+
+    AdaptiveRecorder rebooted(fram);
+    rebooted.begin(SensorReading(20.0f, 60.0f, TRACE_START));
+    rebooted.getDeadband(temperature, humidity);
+    TEST_ASSERT_EQUAL_FLOAT(2.0f, temperature);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, humidity);
+    delete fram;
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_replay_against_fixed_interval);
+    RUN_TEST(test_flat_signal_records_at_max_interval);
+    RUN_TEST(test_staged_deadband_is_applied_and_persisted);
+    return UNITY_END();
+}
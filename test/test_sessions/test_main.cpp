@@ -0,0 +1,228 @@
+#include <unity.h>
+#include <FakeGattClient.h>
+#include <BleSensorServer.h>
+#include <FramRecordStore.h>
+
+// Several centrals syncing at once: every request/read pair must be answered from the session of its own connection,
+// and the server stays discoverable while sessions are left
+
+#define RECORD_COUNT 100
+#define LARGE_MTU 185
+
+static const uint32_t START = 1750000000;
+
+static FramStorage *fram;
+static FramRecordStore *records;
+static ReadingBus *readings;
+static AlertEngine *alerts;
+static BurstCapture *burst;
+static AdaptiveRecorder *recorder;
+static BleSensorServer *server;
+
+void setUp() {
+    fram = new FramStorage();
+    fram->begin(DEFAULT_FRAM_I2C_ADDRESS, 32 * 1024);
+    records = new FramRecordStore(fram);
+    records->begin();
+    for (uint32_t i = 0; i < RECORD_COUNT; ++i) {
+        records->append(SensorReading(20.0f + i * 0.1f, 60.0f - i * 0.1f, START + i * 60));
+    }
+    readings = new ReadingBus();
+    readings->publish(SensorReading(25.0f, 50.0f, START + RECORD_COUNT * 60));
+    alerts = new AlertEngine(fram);
+    alerts->begin();
+    burst = new BurstCapture(fram);
+    burst->begin();
+    recorder = new AdaptiveRecorder(fram);
+    server = new BleSensorServer("GreenHouseTest", records, readings, alerts, burst, recorder);
+    Serial.mute(true);
+    server->begin();
+}
+
+void tearDown() {
+    Serial.mute(false);
+    delete server;
+    delete recorder;
+    delete burst;
+    delete alerts;
+    delete readings;
+    delete records;
+    delete fram;
+}
+
+static void requestBatch(FakeGattClient &client, uint16_t offset, uint8_t count) {
+    uint8_t request[BatchRequestSchema::size];
+    BatchRequestSchema::encode(request, REQUEST_BATCH_OPCODE, offset, count);
+    TEST_ASSERT_TRUE(client.write(RECORD_REQUEST_CHARACTERISTIC_UUID, request, sizeof(request)));
+}
+
+static size_t readResponse(FakeGattClient &client, uint8_t *response) {
+    return client.read(RECORD_DATA_CHARACTERISTIC_UUID, response, BLUETOOTH_RESPONSE_MAX_SIZE);
+}
+
+// Checks a batch response against the records it should hold
+static void assertRecords(const uint8_t *response, size_t length, uint16_t offset, uint16_t count) {
+    TEST_ASSERT_EQUAL_UINT32(count * BLUETOOTH_RECORD_SIZE, length);
+    for (uint16_t i = 0; i < count; ++i) {
+        const uint8_t *record = response + i * BLUETOOTH_RECORD_SIZE;
+        TEST_ASSERT_EQUAL_UINT16(offset + i, BluetoothRecordSchema::get<BT_OFFSET>(record));
+        TEST_ASSERT_EQUAL_UINT32(START + (RECORD_COUNT - 1 - offset - i) * 60,
+                                 BluetoothRecordSchema::get<BT_TIMESTAMP>(record));
+    }
+}
+
+void test_interleaved_batches_stay_per_client() {
+    FakeGattClient phone(LARGE_MTU);
+    FakeGattClient watch(LARGE_MTU);
+    TEST_ASSERT_TRUE(phone.connect());
+    TEST_ASSERT_TRUE(watch.connect());
+
+    uint8_t response[BLUETOOTH_RESPONSE_MAX_SIZE];
+    // Both write before either reads: a single shared response would serve the watch records to the phone
+    for (uint16_t round = 0; round < 4; ++round) {
+        requestBatch(phone, round * 10, 10);
+        requestBatch(watch, 50 + round * 5, 5);
+        assertRecords(response, readResponse(phone, response), round * 10, 10);
+        assertRecords(response, readResponse(watch, response), 50 + round * 5, 5);
+    }
+    // A read repeated without a new request serves the same response again
+    assertRecords(response, readResponse(watch, response), 65, 5);
+}
+
+void test_downsample_stream_survives_other_requests() {
+    FakeGattClient phone(LARGE_MTU);
+    FakeGattClient watch(LARGE_MTU);
+    TEST_ASSERT_TRUE(phone.connect());
+    TEST_ASSERT_TRUE(watch.connect());
+
+    uint8_t request[DownsampleRequestSchema::size];
+    DownsampleRequestSchema::encode(request, REQUEST_DOWNSAMPLE_OPCODE, START, START + RECORD_COUNT * 60, 30,
+                                    LTTB_SERIES_TEMPERATURE);
+    TEST_ASSERT_TRUE(phone.write(RECORD_REQUEST_CHARACTERISTIC_UUID, request, sizeof(request)));
+
+    uint8_t response[BLUETOOTH_RESPONSE_MAX_SIZE];
+    uint8_t current[RecordRequestSchema::size];
+    RecordRequestSchema::encode(current, CURRENT_RECORD_OFFSET);
+    uint32_t points = 0;
+    uint32_t lastTimestamp = 0;
+    size_t length;
+    while ((length = readResponse(phone, response)) > 0) {
+        for (size_t i = 0; i < length / BLUETOOTH_RECORD_SIZE; ++i) {
+            const uint32_t timestamp = BluetoothRecordSchema::get<BT_TIMESTAMP>(response + i * BLUETOOTH_RECORD_SIZE);
+            TEST_ASSERT_GREATER_THAN_UINT32(lastTimestamp, timestamp);
+            lastTimestamp = timestamp;
+            points++;
+        }
+        // The watch polls the current reading between every chunk of the phone series
+        TEST_ASSERT_TRUE(watch.write(RECORD_REQUEST_CHARACTERISTIC_UUID, current, sizeof(current)));
+        TEST_ASSERT_EQUAL_UINT32(BLUETOOTH_RECORD_SIZE, readResponse(watch, response));
+        TEST_ASSERT_EQUAL_UINT16(CURRENT_RECORD_OFFSET, BluetoothRecordSchema::get<BT_OFFSET>(response));
+        TEST_ASSERT_EQUAL_FLOAT(25.0f, BluetoothRecordSchema::get<BT_TEMPERATURE>(response));
+    }
+    TEST_ASSERT_EQUAL_UINT32(30, points);
+}
+
+void test_responses_are_bounded_by_each_client_mtu() {
+    FakeGattClient small;
+    FakeGattClient large(LARGE_MTU);
+    TEST_ASSERT_TRUE(small.connect());
+    TEST_ASSERT_TRUE(large.connect());
+
+    uint8_t response[BLUETOOTH_RESPONSE_MAX_SIZE];
+    requestBatch(small, 0, BATCH_MAX_RECORDS);
+    requestBatch(large, 0, BATCH_MAX_RECORDS);
+    assertRecords(response, readResponse(small, response), 0, (ATT_DEFAULT_MTU - 1) / BLUETOOTH_RECORD_SIZE);
+    assertRecords(response, readResponse(large, response), 0, (LARGE_MTU - 1) / BLUETOOTH_RECORD_SIZE);
+}
+
+void test_sessions_are_released_on_disconnect() {
+    FakeGattClient clients[MAX_CLIENT_SESSIONS];
+    for (FakeGattClient &client: clients) {
+        TEST_ASSERT_TRUE(client.connect());
+    }
+    // Every session in use: no longer advertising, a further central cannot connect
+    FakeGattClient late;
+    TEST_ASSERT_FALSE(BLEDevice::getAdvertising()->isAdvertising());
+    TEST_ASSERT_FALSE(late.connect());
+
+    // Once another one leaves, the session is reused and nothing of the previous client leaks into it
+    uint8_t response[BLUETOOTH_RESPONSE_MAX_SIZE];
+    requestBatch(clients[0], 7, 1);
+    assertRecords(response, readResponse(clients[0], response), 7, 1);
+    clients[0].disconnect();
+    TEST_ASSERT_TRUE(late.connect());
+    TEST_ASSERT_EQUAL_UINT32(0, readResponse(late, response));
+    requestBatch(late, 3, 1);
+    assertRecords(response, readResponse(late, response), 3, 1);
+}
+
+void test_advertising_restarts_after_each_connection() {
+    // The controller stops advertising on every connection, the server starts it again while sessions are left
+    FakeGattClient clients[MAX_CLIENT_SESSIONS];
+    for (uint8_t i = 0; i < MAX_CLIENT_SESSIONS; ++i) {
+        TEST_ASSERT_TRUE(BLEDevice::getAdvertising()->isAdvertising());
+        TEST_ASSERT_TRUE(clients[i].connect());
+    }
+    TEST_ASSERT_FALSE(BLEDevice::getAdvertising()->isAdvertising());
+    clients[2].disconnect();
+    TEST_ASSERT_TRUE(BLEDevice::getAdvertising()->isAdvertising());
+}
+
+// Offset of the AD structure of the given type in a payload, -1 if missing
+static int findStructure(const std::vector<uint8_t> &payload, uint8_t type) {
+    for (size_t i = 0; i + 1 < payload.size(); i += payload[i] + 1) {
+        if (payload[i + 1] == type) {
+            return (int) i;
+        }
+    }
+    return -1;
+}
+
+void test_advertisement_carries_service_and_reading() {
+    server->updateAdvertisedReading(SensorReading(21.57f, 64.2f, START));
+    const std::vector<uint8_t> &payload = BLEDevice::getAdvertising()->getPayload();
+    TEST_ASSERT_LESS_OR_EQUAL(ESP_BLE_ADV_DATA_LEN_MAX, payload.size());
+
+    const int flags = findStructure(payload, ESP_BLE_AD_TYPE_FLAG);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, flags);
+    TEST_ASSERT_EQUAL_HEX8(ESP_BLE_ADV_FLAG_GEN_DISC | ESP_BLE_ADV_FLAG_BREDR_NOT_SPT, payload[flags + 2]);
+
+    // 4fafc201-1fb5-459e-8fcc-c5c9c331914b, little-endian over the air
+    const uint8_t serviceUuid[] = {0x4b, 0x91, 0x31, 0xc3, 0xc9, 0xc5, 0xcc, 0x8f,
+                                   0x9e, 0x45, 0xb5, 0x1f, 0x01, 0xc2, 0xaf, 0x4f};
+    const int services = findStructure(payload, ESP_BLE_AD_TYPE_128SRV_CMPL);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, services);
+    TEST_ASSERT_EQUAL_UINT8(1 + sizeof(serviceUuid), payload[services]);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(serviceUuid, &payload[services + 2], sizeof(serviceUuid));
+
+    const int manufacturer = findStructure(payload, ESP_BLE_AD_MANUFACTURER_SPECIFIC_TYPE);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, manufacturer);
+    TEST_ASSERT_EQUAL_UINT8(1 + AdvertisedReadingSchema::size, payload[manufacturer]);
+    const uint8_t *reading = &payload[manufacturer + 2];
+    TEST_ASSERT_EQUAL_HEX16(ADVERTISING_COMPANY_ID, AdvertisedReadingSchema::get<ADV_COMPANY>(reading));
+    TEST_ASSERT_EQUAL_INT16(2157, AdvertisedReadingSchema::get<ADV_TEMPERATURE>(reading));
+    TEST_ASSERT_EQUAL_UINT16(6420, AdvertisedReadingSchema::get<ADV_HUMIDITY>(reading));
+    TEST_ASSERT_EQUAL_UINT8(1, AdvertisedReadingSchema::get<ADV_SEQUENCE>(reading));
+
+    // The name in the scan response, and the payloads survive a connection
+    const std::vector<uint8_t> &scanResponse = BLEDevice::getAdvertising()->getScanResponse();
+    const int name = findStructure(scanResponse, ESP_BLE_AD_TYPE_NAME_CMPL);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, name);
+    const char *advertisedName = (const char *) &scanResponse[name + 2];
+    TEST_ASSERT_EQUAL_STRING("GreenHouseTest", std::string(advertisedName, scanResponse[name] - 1).c_str());
+    FakeGattClient phone;
+    TEST_ASSERT_TRUE(phone.connect());
+    TEST_ASSERT_EQUAL_INT(manufacturer, findStructure(BLEDevice::getAdvertising()->getPayload(),
+                                                      ESP_BLE_AD_MANUFACTURER_SPECIFIC_TYPE));
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_interleaved_batches_stay_per_client);
+    RUN_TEST(test_downsample_stream_survives_other_requests);
+    RUN_TEST(test_responses_are_bounded_by_each_client_mtu);
+    RUN_TEST(test_sessions_are_released_on_disconnect);
+    RUN_TEST(test_advertising_restarts_after_each_connection);
+    RUN_TEST(test_advertisement_carries_service_and_reading);
+    return UNITY_END();
+}
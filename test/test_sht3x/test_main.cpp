@@ -0,0 +1,162 @@
+#include <unity.h>
+#include <vector>
+#include <HostClock.h>
+#include <Sht3xSensor.h>
+
+// The driver against a scripted SHT3x: every read returns the next scripted frame or NACKs, so each failure the bus
+// can produce is played in turn. A failed fetch must leave no older measurement behind.
+
+#define TEMPERATURE_TOLERANCE 0.01f
+#define HUMIDITY_TOLERANCE    0.01f
+
+// SHT3x as a script of read answers, remembering the commands it was sent
+class ScriptedSht3x : public I2cDevice {
+public:
+    struct Frame {
+        bool acknowledged;
+        uint8_t data[SHT3X_DATA_LENGTH];
+    };
+
+    bool receive(const uint8_t *data, size_t length) override {
+        if (length == 2) {
+            commands.push_back((uint16_t) (data[0] << 8 | data[1]));
+        }
+        return true;
+    }
+
+    size_t request(uint8_t *data, size_t length) override {
+        if (frames.empty() || !frames.front().acknowledged) {
+            if (!frames.empty()) {
+                frames.erase(frames.begin());
+            }
+            return 0; // Read header NACKed: no conversion since the last fetch
+        }
+        memcpy(data, frames.front().data, length < SHT3X_DATA_LENGTH ? length : SHT3X_DATA_LENGTH);
+        frames.erase(frames.begin());
+        return length < SHT3X_DATA_LENGTH ? length : SHT3X_DATA_LENGTH;
+    }
+
+    std::vector<uint16_t> commands;
+    std::vector<Frame> frames;
+};
+
+// Datasheet section 4.12: polynomial 0x31, initialization 0xFF
+static uint8_t crc8(uint8_t msb, uint8_t lsb) {
+    uint8_t crc = 0xFF;
+    for (const uint8_t byte: {msb, lsb}) {
+        crc ^= byte;
+        for (uint8_t bit = 0; bit < 8; ++bit) {
+            crc = (crc & 0x80) ? (uint8_t) ((crc << 1) ^ 0x31) : (uint8_t) (crc << 1);
+        }
+    }
+    return crc;
+}
+
+static ScriptedSht3x::Frame frame(uint16_t rawTemperature, uint16_t rawHumidity) {
+    return {true, {(uint8_t) (rawTemperature >> 8), (uint8_t) rawTemperature,
+                   crc8(rawTemperature >> 8, rawTemperature & 0xFF), (uint8_t) (rawHumidity >> 8),
+                   (uint8_t) rawHumidity, crc8(rawHumidity >> 8, rawHumidity & 0xFF)}};
+}
+
+static const ScriptedSht3x::Frame NACK = {false, {}};
+
+static ScriptedSht3x *chip;
+static Sht3xSensor *sht;
+
+void setUp() {
+    host::resetClock();
+    chip = new ScriptedSht3x();
+    Wire.attach(SHT3X_DEFAULT_ADDRESS, chip);
+    sht = new Sht3xSensor();
+}
+
+void tearDown() {
+    Wire.attach(SHT3X_DEFAULT_ADDRESS, nullptr);
+    delete sht;
+    delete chip;
+}
+
+static void assertInvalid() {
+    TEST_ASSERT_TRUE(isnan(sht->getTemperature()));
+    TEST_ASSERT_TRUE(isnan(sht->getHumidity()));
+}
+
+void test_good_frame() {
+    TEST_ASSERT_EQUAL_HEX8(0x92, crc8(0xBE, 0xEF)); // Datasheet example
+
+    TEST_ASSERT_TRUE(sht->begin(Sht3xSensor::RATE_2_MPS, Sht3xSensor::REPEATABILITY_MEDIUM));
+    assertInvalid();
+    chip->frames.push_back(frame(0x6666, 0x8000));
+    TEST_ASSERT_TRUE(sht->fetch());
+    TEST_ASSERT_FLOAT_WITHIN(TEMPERATURE_TOLERANCE, -45.0f + 175.0f * 0x6666 / 65535.0f, sht->getTemperature());
+    TEST_ASSERT_FLOAT_WITHIN(HUMIDITY_TOLERANCE, 50.0f, sht->getHumidity());
+
+    // Break, periodic mode 2 mps medium repeatability, fetch data
+    const uint16_t expected[] = {0x3093, 0x2220, 0xE000};
+    TEST_ASSERT_EQUAL_UINT32(3, chip->commands.size());
+    for (uint8_t i = 0; i < 3; ++i) {
+        TEST_ASSERT_EQUAL_HEX16(expected[i], chip->commands[i]);
+    }
+}
+
+void test_bad_crc_invalidates_reading() {
+    sht->begin();
+    chip->frames.push_back(frame(0x6666, 0x8000));
+    TEST_ASSERT_TRUE(sht->fetch());
+
+    for (const uint8_t corrupted: {2, 5}) { // Temperature CRC, then humidity CRC
+        ScriptedSht3x::Frame bad = frame(0x7000, 0x9000);
+        bad.data[corrupted] ^= 0x01;
+        chip->frames.push_back(bad);
+        TEST_ASSERT_FALSE(sht->fetch());
+        assertInvalid();
+        chip->frames.push_back(frame(0x6666, 0x8000));
+        TEST_ASSERT_TRUE(sht->fetch());
+    }
+
+    // A flipped data bit is caught by the CRC it no longer matches
+    ScriptedSht3x::Frame flipped = frame(0x7000, 0x9000);
+    flipped.data[4] ^= 0x80;
+    chip->frames.push_back(flipped);
+    TEST_ASSERT_FALSE(sht->fetch());
+    assertInvalid();
+}
+
+void test_early_fetch_nack_invalidates_reading() {
+    sht->begin();
+    // Before the first conversion of the periodic mode
+    chip->frames.push_back(NACK);
+    TEST_ASSERT_FALSE(sht->fetch());
+    assertInvalid();
+
+    chip->frames.push_back(frame(0x6666, 0x8000));
+    TEST_ASSERT_TRUE(sht->fetch());
+    // Fetched again before the next conversion
+    chip->frames.push_back(NACK);
+    TEST_ASSERT_FALSE(sht->fetch());
+    assertInvalid();
+
+    chip->frames.push_back(frame(0x5000, 0x4000));
+    TEST_ASSERT_TRUE(sht->fetch());
+    TEST_ASSERT_FLOAT_WITHIN(HUMIDITY_TOLERANCE, 100.0f * 0x4000 / 65535.0f, sht->getHumidity());
+}
+
+void test_absent_sensor_invalidates_reading() {
+    sht->begin();
+    chip->frames.push_back(frame(0x6666, 0x8000));
+    TEST_ASSERT_TRUE(sht->fetch());
+
+    // Fetch command NACKed on its address: unplugged or bus stuck
+    Wire.attach(SHT3X_DEFAULT_ADDRESS, nullptr);
+    TEST_ASSERT_FALSE(sht->fetch());
+    assertInvalid();
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_good_frame);
+    RUN_TEST(test_bad_crc_invalidates_reading);
+    RUN_TEST(test_early_fetch_nack_invalidates_reading);
+    RUN_TEST(test_absent_sensor_invalidates_reading);
+    return UNITY_END();
+}
@@ -0,0 +1,91 @@
+#include <unity.h>
+#include <HostClock.h>
+#include <SimDs3231.h>
+#include <SimSht3x.h>
+
+// The firmware itself, setup() and loop() against the simulated peripherals like the native program runs them
+#include "../../src/main.cpp"
+
+// Nothing may reach the heap once the first sample closed the boot: hours of samples, records, stats reports and a
+// burst capture run with malloc interposed, and the instrumentation must not have counted a single allocation.
+
+#define STEADY_STATE_HOURS 2
+#define BURST_TEMPERATURE  100.0f // Always below: the rule is raised at its first sample
+
+// Replaces the C library allocator for the whole process, libstdc++ (operator new) included, which -Wl,--wrap
+// cannot reach on the host: the shared library calls malloc through the dynamic linker, not the wrapped symbol
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *pointer, size_t size);
+
+void *malloc(size_t size) {
+    instrumentation.recordAllocation(size, __builtin_return_address(0));
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size) {
+    instrumentation.recordAllocation(count * size, __builtin_return_address(0));
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *pointer, size_t size) {
+    instrumentation.recordAllocation(size, __builtin_return_address(0));
+    return __libc_realloc(pointer, size);
+}
+}
+
+static void greenhouse(uint64_t micros, float &temperature, float &humidity) {
+    const double day = fmod(micros / 1e6, 86400.0) / 86400.0;
+    temperature = (float) (18.0 + 6.0 * sin(2 * M_PI * day));
+    humidity = (float) (70.0 - 15.0 * sin(2 * M_PI * day));
+}
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+void test_loop_never_allocates() {
+    static SimSht3x chip(greenhouse, 0.02f);
+    static SimDs3231 clock(1750000000, 2.0f);
+    Wire.attach(SHT3X_DEFAULT_ADDRESS, &chip);
+    Wire.attach(DS3231_ADDRESS, &clock);
+    host::setResetReason(ESP_RST_POWERON);
+    Serial.mute(true);
+
+    setup();
+    // The first valid sample runs the deferred init, which ends the boot and marks the steady state
+    while (deferredInitPending && millis() < 10000) {
+        loop();
+    }
+    TEST_ASSERT_FALSE(deferredInitPending);
+    TEST_ASSERT_EQUAL_UINT32(0, instrumentation.getSteadyStateAllocations());
+
+    // An alert that starts a burst capture, as if set over BLE
+    AlertRule rule;
+    rule.type = ALERT_BELOW;
+    rule.threshold = BURST_TEMPERATURE;
+    rule.triggersBurst = true;
+    TEST_ASSERT_TRUE(alerts.setRule(0, rule));
+
+    const uint64_t end = host::nowMicros() + STEADY_STATE_HOURS * 3600ULL * 1000000ULL;
+    uint32_t iterations = 0;
+    while (host::nowMicros() < end) {
+        loop();
+        iterations++;
+    }
+    Serial.mute(false);
+
+    TEST_ASSERT_TRUE(iterations > STEADY_STATE_HOURS * 3600);
+    TEST_ASSERT_EQUAL_UINT16(ALERT_BURST_SAMPLES, burst.getSampleCount());
+    TEST_ASSERT_TRUE(recorder.getRecordCount() > 0);
+    TEST_ASSERT_EQUAL_UINT32(0, instrumentation.getSteadyStateAllocations());
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_loop_never_allocates);
+    return UNITY_END();
+}
@@ -0,0 +1,202 @@
+#include <unity.h>
+#include <HostClock.h>
+#include <FakeGattClient.h>
+#include <BleSensorServer.h>
+#include <FramRecordStore.h>
+
+// Sync protocol benchmark: scripted centrals sync a full FRAM history over a timed link and report records per
+// second, round trips and bytes on air in simulated time. Re-run it on every change to the sync protocol.
+
+#define PHONE_MTU                 185
+#define PHONE_CONNECTION_INTERVAL 30000 // Android's balanced connection priority
+#define PHONE_LATENCY             2000  // Per GATT operation, OS queue and app
+#define RECORD_INTERVAL           60
+#define NEW_RECORDS               60    // Recorded between two incremental syncs
+#define DOWNSAMPLE_POINTS         240
+
+static const uint32_t START = 1750000000;
+static const uint32_t HISTORY = RECORD_SLOT_COUNT - 1; // Full ring
+
+static FramStorage *fram;
+static FramRecordStore *records;
+static ReadingBus *readings;
+static AlertEngine *alerts;
+static BurstCapture *burst;
+static AdaptiveRecorder *recorder;
+static BleSensorServer *server;
+
+struct SyncResult {
+    uint32_t records;
+    uint32_t roundTrips;
+    uint32_t bytesOnAir;
+    double seconds;
+};
+
+void setUp() {
+    fram = new FramStorage();
+    fram->begin(DEFAULT_FRAM_I2C_ADDRESS, 32 * 1024);
+    records = new FramRecordStore(fram);
+    records->begin();
+    for (uint32_t i = 0; i < HISTORY; ++i) {
+        records->append(SensorReading(20.0f + (i % 50) * 0.1f, 60.0f, START + i * RECORD_INTERVAL));
+    }
+    readings = new ReadingBus();
+    readings->publish(SensorReading(25.0f, 50.0f, START + HISTORY * RECORD_INTERVAL));
+    alerts = new AlertEngine(fram);
+    alerts->begin();
+    burst = new BurstCapture(fram);
+    burst->begin();
+    recorder = new AdaptiveRecorder(fram);
+    server = new BleSensorServer("GreenHouseBench", records, readings, alerts, burst, recorder);
+    Serial.mute(true);
+    server->begin();
+}
+
+void tearDown() {
+    Serial.mute(false);
+    delete server;
+    delete recorder;
+    delete burst;
+    delete alerts;
+    delete readings;
+    delete records;
+    delete fram;
+}
+
+static SyncResult finish(FakeGattClient &client, uint32_t synced, uint64_t start) {
+    return {synced, client.getRoundTrips(), client.getBytesOnAir(), (host::nowMicros() - start) / 1e6};
+}
+
+// The original app loop: one two byte request and one read per record, newest first
+static SyncResult legacySync(FakeGattClient &client, uint32_t count) {
+    const uint64_t start = host::nowMicros();
+    uint32_t synced = 0;
+    for (uint32_t offset = 0; offset < count; ++offset) {
+        uint8_t request[RecordRequestSchema::size];
+        RecordRequestSchema::encode(request, offset);
+        client.write(RECORD_REQUEST_CHARACTERISTIC_UUID, request, sizeof(request));
+        uint8_t response[BLUETOOTH_RESPONSE_MAX_SIZE];
+        if (client.read(RECORD_DATA_CHARACTERISTIC_UUID, response, sizeof(response)) != BLUETOOTH_RECORD_SIZE) {
+            break;
+        }
+        synced++;
+    }
+    return finish(client, synced, start);
+}
+
+// Batches newest first until the history ends or a record at or before `since` shows up
+static SyncResult batchSync(FakeGattClient &client, uint32_t since) {
+    const uint64_t start = host::nowMicros();
+    uint32_t synced = 0;
+    bool done = false;
+    while (!done) {
+        uint8_t request[BatchRequestSchema::size];
+        BatchRequestSchema::encode(request, REQUEST_BATCH_OPCODE, synced, BATCH_MAX_RECORDS);
+        client.write(RECORD_REQUEST_CHARACTERISTIC_UUID, request, sizeof(request));
+        uint8_t response[BLUETOOTH_RESPONSE_MAX_SIZE];
+        const size_t length = client.read(RECORD_DATA_CHARACTERISTIC_UUID, response, sizeof(response));
+        done = length < BLUETOOTH_RECORD_SIZE;
+        for (size_t i = 0; i + BLUETOOTH_RECORD_SIZE <= length; i += BLUETOOTH_RECORD_SIZE) {
+            if (BluetoothRecordSchema::get<BT_TIMESTAMP>(response + i) <= since) {
+                done = true;
+                break;
+            }
+            synced++;
+        }
+    }
+    return finish(client, synced, start);
+}
+
+// One request, then reads until the LTTB series ends
+static SyncResult downsampleSync(FakeGattClient &client, uint16_t points) {
+    const uint64_t start = host::nowMicros();
+    uint8_t request[DownsampleRequestSchema::size];
+    DownsampleRequestSchema::encode(request, REQUEST_DOWNSAMPLE_OPCODE, START, START + HISTORY * RECORD_INTERVAL,
+                                    points, LTTB_SERIES_TEMPERATURE);
+    client.write(RECORD_REQUEST_CHARACTERISTIC_UUID, request, sizeof(request));
+    uint32_t synced = 0;
+    uint8_t response[BLUETOOTH_RESPONSE_MAX_SIZE];
+    size_t length;
+    while ((length = client.read(RECORD_DATA_CHARACTERISTIC_UUID, response, sizeof(response))) > 0) {
+        synced += length / BLUETOOTH_RECORD_SIZE;
+    }
+    return finish(client, synced, start);
+}
+
+static double recordsPerSecond(const SyncResult &result) {
+    return result.records / result.seconds;
+}
+
+static void report(const char *name, const SyncResult &result) {
+    char line[160];
+    snprintf(line, sizeof(line), "%s: %u records in %.1f s, %.0f records/s, %u round trips, %u B on air", name,
+             result.records, result.seconds, recordsPerSecond(result), result.roundTrips, result.bytesOnAir);
+    TEST_MESSAGE(line);
+}
+
+void test_full_history_sync() {
+    FakeGattClient phone(PHONE_MTU, PHONE_CONNECTION_INTERVAL, PHONE_LATENCY);
+    TEST_ASSERT_TRUE(phone.connect());
+    const SyncResult legacy = legacySync(phone, HISTORY);
+    phone.disconnect();
+
+    TEST_ASSERT_TRUE(phone.connect());
+    const SyncResult batch = batchSync(phone, 0);
+    phone.disconnect();
+
+    FakeGattClient oldPhone(ATT_DEFAULT_MTU, PHONE_CONNECTION_INTERVAL, PHONE_LATENCY);
+    TEST_ASSERT_TRUE(oldPhone.connect());
+    const SyncResult smallMtu = batchSync(oldPhone, 0);
+    oldPhone.disconnect();
+
+    report("legacy, one record per request", legacy);
+    report("batch, MTU 185", batch);
+    report("batch, MTU 23", smallMtu);
+
+    TEST_ASSERT_EQUAL_UINT32(HISTORY, legacy.records);
+    TEST_ASSERT_EQUAL_UINT32(HISTORY, batch.records);
+    TEST_ASSERT_EQUAL_UINT32(HISTORY, smallMtu.records);
+    // Two round trips per record against two per MTU-full batch
+    TEST_ASSERT_EQUAL_UINT32(2 * HISTORY, legacy.roundTrips);
+    TEST_ASSERT_GREATER_THAN(10 * recordsPerSecond(legacy), recordsPerSecond(batch));
+    TEST_ASSERT_LESS_THAN(legacy.bytesOnAir, batch.bytesOnAir);
+    // A 23 byte MTU fits one record per read: no better than the legacy protocol
+    TEST_ASSERT_LESS_THAN(2 * recordsPerSecond(legacy), recordsPerSecond(smallMtu));
+}
+
+void test_incremental_sync() {
+    FakeGattClient phone(PHONE_MTU, PHONE_CONNECTION_INTERVAL, PHONE_LATENCY);
+    const uint32_t lastSynced = START + (HISTORY - 1) * RECORD_INTERVAL;
+    for (uint32_t i = 0; i < NEW_RECORDS; ++i) {
+        records->append(SensorReading(21.0f, 61.0f, lastSynced + (i + 1) * RECORD_INTERVAL));
+    }
+    TEST_ASSERT_TRUE(phone.connect());
+    const SyncResult incremental = batchSync(phone, lastSynced);
+    report("incremental batch", incremental);
+
+    TEST_ASSERT_EQUAL_UINT32(NEW_RECORDS, incremental.records);
+    // Batches are bounded by the MTU, the last one reaches an already synced record
+    const uint32_t perBatch = (PHONE_MTU - 1) / BLUETOOTH_RECORD_SIZE;
+    TEST_ASSERT_EQUAL_UINT32(2 * (NEW_RECORDS / perBatch + 1), incremental.roundTrips);
+}
+
+void test_downsampled_sync() {
+    FakeGattClient phone(PHONE_MTU, PHONE_CONNECTION_INTERVAL, PHONE_LATENCY);
+    TEST_ASSERT_TRUE(phone.connect());
+    const SyncResult downsampled = downsampleSync(phone, DOWNSAMPLE_POINTS);
+    report("downsampled to 240 points", downsampled);
+
+    TEST_ASSERT_EQUAL_UINT32(DOWNSAMPLE_POINTS, downsampled.records);
+    // The chart of the whole history costs a few round trips instead of a full sync
+    const uint32_t readsPerChart = (DOWNSAMPLE_POINTS + (PHONE_MTU - 1) / BLUETOOTH_RECORD_SIZE - 1)
+                                   / ((PHONE_MTU - 1) / BLUETOOTH_RECORD_SIZE);
+    TEST_ASSERT_EQUAL_UINT32(1 + readsPerChart + 1, downsampled.roundTrips); // Request, chunks, empty read
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_full_history_sync);
+    RUN_TEST(test_incremental_sync);
+    RUN_TEST(test_downsampled_sync);
+    return UNITY_END();
+}
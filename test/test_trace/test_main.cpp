@@ -0,0 +1,186 @@
+#include <unity.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+#include <HostClock.h>
+#include <Trace.h>
+
+// Trace points as the firmware records them, built with -D TRACE_ENABLED (pio test -e native-trace). The host cycle
+// counter runs at 240 MHz on the simulated clock, so every duration is exact.
+
+#ifndef TRACE_ENABLED
+#error "test_trace needs -D TRACE_ENABLED, run it with pio test -e native-trace"
+#endif
+
+#define HOST_CPU_MHZ 240
+
+// Collects what the trace prints
+class CapturePrint : public Print {
+public:
+    size_t write(uint8_t c) override {
+        text += (char) c;
+        return 1;
+    }
+
+    std::string text;
+};
+
+struct DumpedEvent {
+    uint32_t startMicros;
+    uint32_t durationCycles;
+    std::string task;
+    std::string name;
+};
+
+// The grammar documented in Trace.h, which tools/trace2chrome.py reads
+static std::vector<DumpedEvent> parseDump(const std::string &text) {
+    std::vector<DumpedEvent> events;
+    size_t position = 0;
+    unsigned mhz = 0;
+    unsigned count = 0;
+    bool inside = false;
+    bool ended = false;
+    while (position < text.size()) {
+        const size_t end = text.find('\n', position);
+        TEST_ASSERT_TRUE(end != std::string::npos);
+        std::string line = text.substr(position, end - position);
+        position = end + 1;
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (!inside) {
+            TEST_ASSERT_EQUAL_INT(2, sscanf(line.c_str(), "TRACE BEGIN %u %u", &mhz, &count));
+            TEST_ASSERT_EQUAL_UINT(HOST_CPU_MHZ, mhz);
+            inside = true;
+            continue;
+        }
+        if (line == "TRACE END") {
+            ended = true;
+            break;
+        }
+        DumpedEvent event;
+        int consumed = 0;
+        char task[32];
+        TEST_ASSERT_EQUAL_INT(3, sscanf(line.c_str(), "%u %u %31s %n", &event.startMicros, &event.durationCycles,
+                                        task, &consumed));
+        event.task = task;
+        event.name = line.substr(consumed);
+        events.push_back(event);
+    }
+    TEST_ASSERT_TRUE(ended);
+    TEST_ASSERT_EQUAL_UINT32(count, events.size());
+    return events;
+}
+
+void setUp() {
+    host::resetClock();
+    CapturePrint discarded;
+    TRACE_DUMP(discarded); // Empties the global buffer
+}
+
+void tearDown() {
+}
+
+void test_nested_scopes() {
+    delay(3);
+    {
+        TRACE_SCOPE("outer loop");
+        delay(10);
+        {
+            TRACE_SCOPE("inner");
+            delay(5);
+        }
+        delay(1);
+    }
+
+    CapturePrint out;
+    TRACE_DUMP(out);
+    const std::vector<DumpedEvent> events = parseDump(out.text);
+    // Recorded when they end: the inner scope first
+    TEST_ASSERT_EQUAL_UINT32(2, events.size());
+    TEST_ASSERT_EQUAL_STRING("inner", events[0].name.c_str());
+    TEST_ASSERT_EQUAL_STRING("outer loop", events[1].name.c_str());
+    TEST_ASSERT_EQUAL_STRING("host", events[0].task.c_str());
+    TEST_ASSERT_EQUAL_UINT32(13000, events[0].startMicros);
+    TEST_ASSERT_EQUAL_UINT32(5000 * HOST_CPU_MHZ, events[0].durationCycles);
+    TEST_ASSERT_EQUAL_UINT32(3000, events[1].startMicros);
+    TEST_ASSERT_EQUAL_UINT32(16000 * HOST_CPU_MHZ, events[1].durationCycles);
+
+    // A dump empties the buffer
+    CapturePrint empty;
+    TRACE_DUMP(empty);
+    TEST_ASSERT_EQUAL_UINT32(0, parseDump(empty.text).size());
+}
+
+void test_wrap_keeps_newest_events() {
+    const uint32_t recorded = TRACE_BUFFER_EVENTS * 2 + 10;
+    for (uint32_t i = 0; i < recorded; ++i) {
+        trace.record(i % 2 == 0 ? "even" : "odd", i, i * HOST_CPU_MHZ);
+    }
+
+    CapturePrint out;
+    TRACE_DUMP(out);
+    const std::vector<DumpedEvent> events = parseDump(out.text);
+    TEST_ASSERT_EQUAL_UINT32(TRACE_BUFFER_EVENTS, events.size());
+    for (uint32_t i = 0; i < TRACE_BUFFER_EVENTS; ++i) {
+        const uint32_t expected = recorded - TRACE_BUFFER_EVENTS + i; // Oldest kept first
+        TEST_ASSERT_EQUAL_UINT32(expected, events[i].startMicros);
+        TEST_ASSERT_EQUAL_UINT32(expected * HOST_CPU_MHZ, events[i].durationCycles);
+        TEST_ASSERT_EQUAL_STRING(expected % 2 == 0 ? "even" : "odd", events[i].name.c_str());
+    }
+}
+
+void test_dump_converts_with_trace2chrome() {
+    // tools/trace2chrome.py from the project root, found from this file
+    const std::string file = __FILE__;
+    const std::string root = file.substr(0, file.rfind("test/test_trace/"));
+    if (system("python3 -c '' 2>/dev/null") != 0) {
+        TEST_IGNORE_MESSAGE("python3 not found");
+    }
+
+    delay(2);
+    {
+        TRACE_SCOPE("store.append");
+        delay(4);
+    }
+    delay(1);
+    {
+        TRACE_SCOPE("deferred init");
+        delay(7);
+    }
+    CapturePrint out;
+    out.text = "Serial Initialized.\n"; // Log lines around the dump are skipped
+    TRACE_DUMP(out);
+    out.text += "Records stored: 12\n";
+
+    char dumpPath[] = "/tmp/traceXXXXXX";
+    const int fd = mkstemp(dumpPath);
+    TEST_ASSERT_TRUE(fd >= 0);
+    TEST_ASSERT_EQUAL_UINT32(out.text.size(), write(fd, out.text.data(), out.text.size()));
+    close(fd);
+
+    // One line per complete event: name, ts and dur as Chrome reads them (microseconds)
+    const std::string command = "python3 -B -c \"import json, sys; sys.path.insert(0, '" + root + "tools'); "
+                                "import trace2chrome; "
+                                "[print(e['name'], e['ts'], e['dur']) for e in trace2chrome.convert(open('"
+                                + dumpPath + "'))['traceEvents'] if e['ph'] == 'X']\"";
+    FILE *converted = popen(command.c_str(), "r");
+    TEST_ASSERT_NOT_NULL(converted);
+    std::string text;
+    char line[128];
+    while (fgets(line, sizeof(line), converted) != nullptr) {
+        text += line;
+    }
+    const int status = pclose(converted);
+    unlink(dumpPath);
+    TEST_ASSERT_EQUAL_INT(0, status);
+    TEST_ASSERT_EQUAL_STRING("store.append 0 4000.0\ndeferred init 5000 7000.0\n", text.c_str());
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_nested_scopes);
+    RUN_TEST(test_wrap_keeps_newest_events);
+    RUN_TEST(test_dump_converts_with_trace2chrome);
+    return UNITY_END();
+}
@@ -0,0 +1,173 @@
+#include <unity.h>
+#include <chrono>
+#include <cfloat>
+#include <SensorReading.h>
+#include <BleSensorServer.h>
+
+// Transcoding stored records into Bluetooth records, the hot path of every sync: schema accessors against the
+// serializer of the baseline firmware they replaced, copied below as it was. Both must produce the same bytes, the
+// timings are reported, not asserted, they depend on the host and the optimization level.
+
+#define BENCH_BATCHES 20000
+
+static uint8_t stored[BATCH_MAX_RECORDS * RECORD_SIZE_BYTES];
+
+static void fillStored() {
+    for (uint16_t i = 0; i < BATCH_MAX_RECORDS; ++i) {
+        StoredRecordSchema::encode(stored + i * RECORD_SIZE_BYTES, 20.0f + i * 0.25f, 60.0f - i * 0.5f,
+                                   1750000000 + i * 60);
+    }
+}
+
+static void transcodeSchema(uint8_t *out) {
+    for (uint16_t i = 0; i < BATCH_MAX_RECORDS; ++i) {
+        const uint8_t *record = stored + i * RECORD_SIZE_BYTES;
+        BluetoothRecordSchema::put<BT_OFFSET>(out, i);
+        wire::copyField<StoredRecordSchema, STORED_TEMPERATURE, BluetoothRecordSchema, BT_TEMPERATURE>(record, out);
+        wire::copyField<StoredRecordSchema, STORED_HUMIDITY, BluetoothRecordSchema, BT_HUMIDITY>(record, out);
+        wire::copyField<StoredRecordSchema, STORED_TIMESTAMP, BluetoothRecordSchema, BT_TIMESTAMP>(record, out);
+        out += BLUETOOTH_RECORD_SIZE;
+    }
+}
+
+// Baseline firmware (BleSensorServer.h and BleSensorServer.cpp before the wire schemas), verbatim but for the member
+// function turned into a free one
+struct BluetoothRecord {
+    uint16_t offset;
+    float temperature;
+    float humidity;
+    uint32_t timestamp; // 'long' is typically 32-bit on Arduino
+
+    // Default constructor (optional, but good practice)
+    BluetoothRecord() : offset(0), temperature(0.0f), humidity(0.0f),  timestamp(0L) {}
+    BluetoothRecord(const uint16_t offset, const float temp, const float hum, const uint32_t ts) : offset(offset), temperature(temp), humidity(hum),  timestamp(ts) {}
+};
+
+static void serializeBluetoothRecord(BluetoothRecord *record, uint8_t *buffer) {
+    size_t i = 0;
+
+    // Serialize offset (uint16_t)
+    buffer[i++] = record->offset & 0xFF;
+    buffer[i++] = (record->offset >> 8) & 0xFF;
+
+    // Serialize temperature (float)
+    memcpy(&buffer[i], &record->temperature, sizeof(float));
+    i += sizeof(float);
+
+    // Serialize humidity (float)
+    memcpy(&buffer[i], &record->humidity, sizeof(float));
+    i += sizeof(float);
+
+    // Serialize timestamp (uint32_t)
+    buffer[i++] = record->timestamp & 0xFF;
+    buffer[i++] = (record->timestamp >> 8) & 0xFF;
+    buffer[i++] = (record->timestamp >> 16) & 0xFF;
+    buffer[i++] = (record->timestamp >> 24) & 0xFF;
+}
+
+// The baseline sync path: FramStorage::readSensorReading() copied the stored bytes into a SensorReading
+// (readGeneric<SensorReading>), then the record was built and serialized
+static void transcodeBaseline(uint8_t *out) {
+    for (uint16_t i = 0; i < BATCH_MAX_RECORDS; ++i) {
+        SensorReading reading;
+        memcpy(&reading, stored + i * RECORD_SIZE_BYTES, sizeof(reading));
+        BluetoothRecord record = {
+            i,
+            reading.temperature,
+            reading.humidity,
+            reading.timestamp
+        };
+        serializeBluetoothRecord(&record, out);
+        out += BLUETOOTH_RECORD_SIZE;
+    }
+}
+
+template<typename Transcode>
+static double nanosPerRecord(Transcode transcode, uint8_t *out) {
+    volatile uint8_t sink = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (uint32_t batch = 0; batch < BENCH_BATCHES; ++batch) {
+        transcode(out);
+        sink = sink + out[batch % BLUETOOTH_RESPONSE_MAX_SIZE];
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / (BENCH_BATCHES * (double) BATCH_MAX_RECORDS);
+}
+
+void setUp() {
+    fillStored();
+}
+
+void tearDown() {
+}
+
+void test_schema_matches_baseline_layout() {
+    uint8_t schema[BLUETOOTH_RESPONSE_MAX_SIZE];
+    uint8_t baseline[BLUETOOTH_RESPONSE_MAX_SIZE];
+    transcodeSchema(schema);
+    transcodeBaseline(baseline);
+    TEST_ASSERT_EQUAL_MEMORY(baseline, schema, sizeof(schema));
+    TEST_ASSERT_EQUAL_FLOAT(20.25f, BluetoothRecordSchema::get<BT_TEMPERATURE>(schema + BLUETOOTH_RECORD_SIZE));
+}
+
+void test_edge_values_match_baseline() {
+    const BluetoothRecord edges[] = {
+        {0, NAN, NAN, 0},                     // Failed fetch
+        {1, -12.5f, 0.0f, 1750000000},        // Frost
+        {2, -0.0f, 100.0f, UINT32_MAX},       // Last timestamp of the 32-bit clock
+        {0xFFFF, -45.0f, -0.01f, 0x80000000}, // Current reading offset, sensor limits
+        {0x8000, INFINITY, -INFINITY, 1},
+        {0x00FF, FLT_MIN / 2, -FLT_MAX, 0x00FF00FF}, // Subnormal
+    };
+    for (const BluetoothRecord &edge: edges) {
+        BluetoothRecord record = edge;
+        uint8_t baseline[BLUETOOTH_RECORD_SIZE];
+        serializeBluetoothRecord(&record, baseline);
+
+        // Through the stored layout, as the sync transcodes it, and straight from the values
+        uint8_t from[RECORD_SIZE_BYTES];
+        StoredRecordSchema::encode(from, edge.temperature, edge.humidity, edge.timestamp);
+        uint8_t transcoded[BLUETOOTH_RECORD_SIZE];
+        BluetoothRecordSchema::put<BT_OFFSET>(transcoded, edge.offset);
+        wire::copyField<StoredRecordSchema, STORED_TEMPERATURE, BluetoothRecordSchema, BT_TEMPERATURE>(from,
+                                                                                                      transcoded);
+        wire::copyField<StoredRecordSchema, STORED_HUMIDITY, BluetoothRecordSchema, BT_HUMIDITY>(from, transcoded);
+        wire::copyField<StoredRecordSchema, STORED_TIMESTAMP, BluetoothRecordSchema, BT_TIMESTAMP>(from, transcoded);
+        uint8_t encoded[BLUETOOTH_RECORD_SIZE];
+        BluetoothRecordSchema::encode(encoded, edge.offset, edge.temperature, edge.humidity, edge.timestamp);
+
+        TEST_ASSERT_EQUAL_MEMORY(baseline, transcoded, BLUETOOTH_RECORD_SIZE);
+        TEST_ASSERT_EQUAL_MEMORY(baseline, encoded, BLUETOOTH_RECORD_SIZE);
+    }
+}
+
+void test_transcode_benchmark() {
+    uint8_t out[BLUETOOTH_RESPONSE_MAX_SIZE];
+    const double schema = nanosPerRecord(transcodeSchema, out);
+    const double baseline = nanosPerRecord(transcodeBaseline, out);
+    char line[120];
+    snprintf(line, sizeof(line), "transcode: schema %.2f ns/record, baseline %.2f ns/record", schema, baseline);
+    TEST_MESSAGE(line);
+
+    // Decoding a whole record through get<>() for the display and downsampler paths
+    double sum = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (uint32_t batch = 0; batch < BENCH_BATCHES; ++batch) {
+        for (uint16_t i = 0; i < BATCH_MAX_RECORDS; ++i) {
+            sum += StoredRecordSchema::get<STORED_TEMPERATURE>(stored + i * RECORD_SIZE_BYTES);
+        }
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    snprintf(line, sizeof(line), "get<temperature>: %.2f ns/record",
+             std::chrono::duration<double, std::nano>(elapsed).count() / (BENCH_BATCHES * (double) BATCH_MAX_RECORDS));
+    TEST_MESSAGE(line);
+    TEST_ASSERT_GREATER_THAN_FLOAT(0.0f, (float) sum);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_schema_matches_baseline_layout);
+    RUN_TEST(test_edge_values_match_baseline);
+    RUN_TEST(test_transcode_benchmark);
+    return UNITY_END();
+}
@@ -0,0 +1,51 @@
+"""PlatformIO post-build step: prints the static RAM footprint of every subsystem from the linked firmware.
+
+Every subsystem lives in a global object of src/main.cpp, so its symbol size in .bss/.data is its whole RAM
+footprint. Enabled with `extra_scripts = post:tools/footprint.py`; budgets are enforced by the static_asserts of
+src/main.cpp, this only reports.
+"""
+import subprocess
+
+Import("env")  # noqa: F821 (provided by PlatformIO)
+
+# Subsystem -> global objects of src/main.cpp
+SUBSYSTEMS = {
+    "fram": ["fram"],
+    "records": ["records", "recordFlash"],
+    "rtc": ["rtc"],
+    "sht": ["sht"],
+    "readings": ["readings", "alertCursor", "recordCursor", "displayCursor"],
+    "alerts": ["alerts"],
+    "burst": ["burst"],
+    "ble": ["bleServer"],
+    "display": ["display", "tft"],
+    "recorder": ["recorder"],
+    "instrumentation": ["instrumentation"],
+}
+
+
+def symbol_sizes(nm, elf):
+    output = subprocess.run([nm, "--print-size", "--demangle", elf], capture_output=True, text=True,
+                            check=True).stdout
+    sizes = {}
+    for line in output.splitlines():
+        fields = line.split(None, 3)
+        # address size type name, data and bss symbols only
+        if len(fields) == 4 and fields[2] in "bBdD":
+            sizes[fields[3]] = int(fields[1], 16)
+    return sizes
+
+
+def report(source, target, env):
+    nm = env.subst("$CC")[:-len("gcc")] + "nm"
+    sizes = symbol_sizes(nm, str(target[0]))
+    total = 0
+    print("Static RAM footprint:")
+    for subsystem, symbols in SUBSYSTEMS.items():
+        size = sum(sizes.get(symbol, 0) for symbol in symbols)
+        total += size
+        print(f"  {subsystem:<16} {size:>6} B")
+    print(f"  {'total':<16} {total:>6} B")
+
+
+env.AddPostAction("$BUILD_DIR/${PROGNAME}.elf", report)  # noqa: F821
@@ -0,0 +1,69 @@
+#!/usr/bin/env python3
+"""Converts a trace dumped by the firmware (TRACE_DUMP, see lib/Trace/Trace.h) to Chrome trace JSON.
+
+Usage: trace2chrome.py serial.log > trace.json, then open trace.json in chrome://tracing or ui.perfetto.dev.
+Every TRACE BEGIN / TRACE END block found in the log is converted, other lines are ignored.
+"""
+import json
+import sys
+
+
+def convert(lines):
+    events = []
+    tasks = {}
+    cpu_mhz = None
+    origin = None  # Unwrapped micros() of the first event
+    previous = None
+    timeline = 0
+    for line in lines:
+        line = line.strip()
+        if line.startswith("TRACE BEGIN"):
+            cpu_mhz = int(line.split()[2])
+            continue
+        if line == "TRACE END":
+            cpu_mhz = None
+            continue
+        if cpu_mhz is None:
+            continue
+
+        fields = line.split(" ", 3)
+        if len(fields) != 4:
+            continue
+        start, cycles, task, name = int(fields[0]), int(fields[1]), fields[2], fields[3]
+
+        # micros() wraps every ~71 minutes: follow the signed 32-bit difference between consecutive events
+        if previous is None:
+            timeline = start
+        else:
+            delta = (start - previous) & 0xFFFFFFFF
+            if delta >= 0x80000000:
+                delta -= 0x100000000
+            timeline += delta
+        previous = start
+        if origin is None:
+            origin = timeline
+
+        tid = tasks.setdefault(task, len(tasks) + 1)
+        events.append({
+            "name": name,
+            "ph": "X",
+            "ts": timeline - origin,
+            "dur": cycles / cpu_mhz,
+            "pid": 1,
+            "tid": tid,
+        })
+
+    for task, tid in tasks.items():
+        events.append({"name": "thread_name", "ph": "M", "pid": 1, "tid": tid, "args": {"name": task}})
+    return {"traceEvents": events, "displayTimeUnit": "ms"}
+
+
+def main():
+    source = open(sys.argv[1]) if len(sys.argv) > 1 else sys.stdin
+    with source:
+        json.dump(convert(source), sys.stdout, indent=1)
+    sys.stdout.write("\n")
+
+
+if __name__ == "__main__":
+    main()